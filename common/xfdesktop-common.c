@@ -104,36 +104,46 @@ xfdesktop_get_file_mimetype(const gchar *file)
 }
 
 gboolean
-xfdesktop_image_file_is_valid(const gchar *filename)
+xfdesktop_image_mime_type_is_valid(const gchar *mime_type)
 {
     static GSList *pixbuf_formats = NULL;
     GSList *l;
     gboolean image_valid = FALSE;
-    gchar *file_mimetype;
 
-    g_return_val_if_fail(filename, FALSE);
+    if(mime_type == NULL)
+        return FALSE;
 
     if(pixbuf_formats == NULL) {
         pixbuf_formats = gdk_pixbuf_get_formats();
     }
 
-    file_mimetype = xfdesktop_get_file_mimetype(filename);
-
-    if(file_mimetype == NULL)
-        return FALSE;
-
     /* Every pixbuf format has a list of mime types we can compare against */
     for(l = pixbuf_formats; l != NULL && image_valid == FALSE; l = g_slist_next(l)) {
         gint i;
         gchar ** mimetypes = gdk_pixbuf_format_get_mime_types(l->data);
 
         for(i = 0; mimetypes[i] != NULL && image_valid == FALSE; i++) {
-            if(g_strcmp0(file_mimetype, mimetypes[i]) == 0)
+            if(g_strcmp0(mime_type, mimetypes[i]) == 0)
                 image_valid = TRUE;
         }
          g_strfreev(mimetypes);
     }
 
+    return image_valid;
+}
+
+gboolean
+xfdesktop_image_file_is_valid(const gchar *filename)
+{
+    gboolean image_valid;
+    gchar *file_mimetype;
+
+    g_return_val_if_fail(filename, FALSE);
+
+    file_mimetype = xfdesktop_get_file_mimetype(filename);
+
+    image_valid = xfdesktop_image_mime_type_is_valid(file_mimetype);
+
     g_free(file_mimetype);
 
     return image_valid;
@@ -54,6 +54,9 @@
 
 #define SINGLE_WORKSPACE_MODE     "/backdrop/single-workspace-mode"
 #define SINGLE_WORKSPACE_NUMBER   "/backdrop/single-workspace-number"
+#define BACKDROP_RENDER_THREADS   "/backdrop/render-threads"
+#define BACKDROP_MEMORY_BUDGET    "/backdrop/memory-budget"
+#define BACKDROP_CROSSFADE        "/backdrop/crossfade"
 
 #define DESKTOP_ICONS_SHOW_THUMBNAILS        "/desktop-icons/show-thumbnails"
 #define DESKTOP_ICONS_SHOW_HIDDEN_FILES      "/desktop-icons/show-hidden-files"
@@ -94,6 +97,8 @@ gint xfdesktop_compare_paths(GFile *a, GFile *b);
 
 gboolean xfdesktop_image_file_is_valid(const gchar *filename);
 
+gboolean xfdesktop_image_mime_type_is_valid(const gchar *mime_type);
+
 gchar *xfdesktop_get_file_mimetype(const gchar *file);
 
 gint xfce_translate_image_styles(gint input);
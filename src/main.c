@@ -64,6 +64,12 @@ main(int argc, char **argv)
     XfdesktopApplication *app;
     int ret = 0;
 
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+    /* backdrops and icons are decoded in worker threads */
+    if(!g_thread_supported())
+        g_thread_init(NULL);
+#endif
+
 #if !GLIB_CHECK_VERSION (2, 36, 0)
     g_type_init();
 #endif
@@ -0,0 +1,351 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* On-disk cache of composed backdrops.
+ *
+ * Entries live in $XDG_CACHE_HOME/xfdesktop/backdrops and are named after a
+ * checksum of everything that went into composing them (see
+ * xfce-backdrop.c), so a changed image or setting simply misses.  Each entry
+ * is a small header followed by the packed pixbuf rows, which are mapped
+ * back in on a hit rather than read and decoded.  The least recently used
+ * entries are removed once the directory grows over its size limit, along
+ * with temporary files a crash left behind. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_TIME_H
+#include <time.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <libxfce4util/libxfce4util.h> /* for DBG/TRACE */
+
+#include "xfce-backdrop-cache.h"
+#include "xfdesktop-common.h"
+
+#define XFCE_BACKDROP_CACHE_MAGIC    0x43424458  /* "XDBC" */
+#define XFCE_BACKDROP_CACHE_VERSION  1
+#define XFCE_BACKDROP_CACHE_SUFFIX   ".raw"
+
+/* composed 4K backdrops are ~25MB each, keep a handful of them */
+#define XFCE_BACKDROP_CACHE_MAX_SIZE (256 * 1024 * 1024)
+
+/* entries are written to <key>.raw.XXXXXX first; one that is still around
+ * after this many seconds was left behind by a crash */
+#define XFCE_BACKDROP_CACHE_TEMP_MAX_AGE (60 * 60)
+
+typedef struct
+{
+    guint32 magic;
+    guint32 version;
+    guint32 width;
+    guint32 height;
+    guint32 rowstride;
+    guint32 n_channels;
+    guint32 has_alpha;
+    guint32 reserved;
+} XfceBackdropCacheHeader;
+
+typedef struct
+{
+    gchar *filename;
+    goffset size;
+    time_t atime;
+} XfceBackdropCacheEntry;
+
+G_LOCK_DEFINE_STATIC(xfce_backdrop_cache);
+
+static gchar *
+xfce_backdrop_cache_get_dir(void)
+{
+    return g_build_filename(g_get_user_cache_dir(), "xfdesktop", "backdrops", NULL);
+}
+
+static gchar *
+xfce_backdrop_cache_get_filename(const gchar *key)
+{
+    gchar *dir, *basename, *filename;
+
+    dir = xfce_backdrop_cache_get_dir();
+    basename = g_strconcat(key, XFCE_BACKDROP_CACHE_SUFFIX, NULL);
+    filename = g_build_filename(dir, basename, NULL);
+
+    g_free(basename);
+    g_free(dir);
+
+    return filename;
+}
+
+static void
+xfce_backdrop_cache_unmap(guchar *pixels,
+                          gpointer data)
+{
+    g_mapped_file_unref((GMappedFile *)data);
+}
+
+/**
+ * xfce_backdrop_cache_lookup:
+ * @key: the checksum of the backdrop's inputs.
+ *
+ * Safe to call from any thread.
+ *
+ * Returns: the cached backdrop, mapped from disk, or %NULL on a miss.
+ **/
+GdkPixbuf *
+xfce_backdrop_cache_lookup(const gchar *key)
+{
+    XfceBackdropCacheHeader header;
+    GMappedFile *mapped_file;
+    GdkPixbuf *pix = NULL;
+    gchar *filename;
+    const gchar *contents;
+    gsize length;
+
+    g_return_val_if_fail(key != NULL, NULL);
+
+    filename = xfce_backdrop_cache_get_filename(key);
+
+    /* mapped privately, so the pixbuf stays writable without touching the
+     * file */
+    mapped_file = g_mapped_file_new(filename, TRUE, NULL);
+    if(!mapped_file) {
+        g_free(filename);
+        return NULL;
+    }
+
+    contents = g_mapped_file_get_contents(mapped_file);
+    length = g_mapped_file_get_length(mapped_file);
+
+    if(length >= sizeof(header))
+        memcpy(&header, contents, sizeof(header));
+
+    if(length < sizeof(header)
+       || header.magic != XFCE_BACKDROP_CACHE_MAGIC
+       || header.version != XFCE_BACKDROP_CACHE_VERSION
+       || header.width == 0 || header.height == 0
+       || header.n_channels != (header.has_alpha ? 4 : 3)
+       || header.rowstride != header.width * header.n_channels
+       || length != sizeof(header) + (gsize)header.rowstride * header.height)
+    {
+        /* truncated or from another version, get rid of it */
+        XF_DEBUG("discarding invalid backdrop cache entry %s", filename);
+        g_mapped_file_unref(mapped_file);
+        g_unlink(filename);
+        g_free(filename);
+        return NULL;
+    }
+
+    pix = gdk_pixbuf_new_from_data((guchar *)contents + sizeof(header),
+                                   GDK_COLORSPACE_RGB,
+                                   header.has_alpha, 8,
+                                   header.width, header.height,
+                                   header.rowstride,
+                                   xfce_backdrop_cache_unmap,
+                                   mapped_file);
+
+    /* mark it as recently used */
+    g_utime(filename, NULL);
+
+    XF_DEBUG("backdrop cache hit: %s", filename);
+
+    g_free(filename);
+
+    return pix;
+}
+
+static gint
+xfce_backdrop_cache_entry_compare(gconstpointer a,
+                                  gconstpointer b)
+{
+    const XfceBackdropCacheEntry *entry_a = a, *entry_b = b;
+
+    if(entry_a->atime == entry_b->atime)
+        return 0;
+
+    return entry_a->atime < entry_b->atime ? -1 : 1;
+}
+
+static void
+xfce_backdrop_cache_entry_free(XfceBackdropCacheEntry *entry)
+{
+    g_free(entry->filename);
+    g_slice_free(XfceBackdropCacheEntry, entry);
+}
+
+/* removes stale temporary files, then the least recently used entries
+ * until the cache fits */
+static void
+xfce_backdrop_cache_trim(const gchar *dir)
+{
+    GDir *gdir;
+    const gchar *name;
+    GList *entries = NULL, *l;
+    goffset total_size = 0;
+    struct stat st;
+    time_t now = time(NULL);
+
+    gdir = g_dir_open(dir, 0, NULL);
+    if(!gdir)
+        return;
+
+    while((name = g_dir_read_name(gdir))) {
+        XfceBackdropCacheEntry *entry;
+        gchar *filename;
+
+        if(strstr(name, XFCE_BACKDROP_CACHE_SUFFIX ".")) {
+            /* another store may still be writing a recent one */
+            filename = g_build_filename(dir, name, NULL);
+            if(g_stat(filename, &st) == 0
+               && now - st.st_mtime > XFCE_BACKDROP_CACHE_TEMP_MAX_AGE)
+            {
+                XF_DEBUG("removing stale backdrop cache file %s", filename);
+                g_unlink(filename);
+            }
+            g_free(filename);
+            continue;
+        }
+
+        if(!g_str_has_suffix(name, XFCE_BACKDROP_CACHE_SUFFIX))
+            continue;
+
+        filename = g_build_filename(dir, name, NULL);
+        if(g_stat(filename, &st) != 0) {
+            g_free(filename);
+            continue;
+        }
+
+        entry = g_slice_new(XfceBackdropCacheEntry);
+        entry->filename = filename;
+        entry->size = st.st_size;
+        /* g_utime() on a hit bumps both times, mtime survives noatime */
+        entry->atime = MAX(st.st_atime, st.st_mtime);
+        entries = g_list_prepend(entries, entry);
+
+        total_size += st.st_size;
+    }
+
+    g_dir_close(gdir);
+
+    entries = g_list_sort(entries, xfce_backdrop_cache_entry_compare);
+
+    for(l = entries; l && total_size > XFCE_BACKDROP_CACHE_MAX_SIZE; l = l->next) {
+        XfceBackdropCacheEntry *entry = l->data;
+
+        XF_DEBUG("evicting backdrop cache entry %s", entry->filename);
+
+        if(g_unlink(entry->filename) == 0)
+            total_size -= entry->size;
+    }
+
+    g_list_free_full(entries, (GDestroyNotify)xfce_backdrop_cache_entry_free);
+}
+
+/**
+ * xfce_backdrop_cache_store:
+ * @key: the checksum of the backdrop's inputs.
+ * @pix: the composed backdrop.
+ *
+ * Writes @pix to the cache, replacing any entry for @key atomically, and
+ * trims the cache to its size limit.  Safe to call from any thread.
+ **/
+void
+xfce_backdrop_cache_store(const gchar *key,
+                          GdkPixbuf *pix)
+{
+    XfceBackdropCacheHeader header;
+    gchar *dir, *filename, *tmp_filename;
+    const guchar *pixels;
+    gint fd, y, rowstride;
+    FILE *fp;
+    gboolean ok;
+
+    g_return_if_fail(key != NULL);
+    g_return_if_fail(GDK_IS_PIXBUF(pix));
+    g_return_if_fail(gdk_pixbuf_get_bits_per_sample(pix) == 8);
+
+    dir = xfce_backdrop_cache_get_dir();
+    if(g_mkdir_with_parents(dir, 0700) != 0) {
+        g_free(dir);
+        return;
+    }
+
+    filename = xfce_backdrop_cache_get_filename(key);
+    tmp_filename = g_strconcat(filename, ".XXXXXX", NULL);
+
+    fd = g_mkstemp(tmp_filename);
+    if(fd < 0 || !(fp = fdopen(fd, "wb"))) {
+        if(fd >= 0)
+            close(fd);
+        g_free(tmp_filename);
+        g_free(filename);
+        g_free(dir);
+        return;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = XFCE_BACKDROP_CACHE_MAGIC;
+    header.version = XFCE_BACKDROP_CACHE_VERSION;
+    header.width = gdk_pixbuf_get_width(pix);
+    header.height = gdk_pixbuf_get_height(pix);
+    header.n_channels = gdk_pixbuf_get_n_channels(pix);
+    header.has_alpha = gdk_pixbuf_get_has_alpha(pix);
+    header.rowstride = header.width * header.n_channels;
+
+    /* rows are packed, the pixbuf's own rowstride may include padding */
+    pixels = gdk_pixbuf_get_pixels(pix);
+    rowstride = gdk_pixbuf_get_rowstride(pix);
+
+    ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    for(y = 0; ok && y < (gint)header.height; y++)
+        ok = fwrite(pixels + y * rowstride, header.rowstride, 1, fp) == 1;
+
+    if(fclose(fp) != 0)
+        ok = FALSE;
+
+    if(ok && g_rename(tmp_filename, filename) == 0) {
+        XF_DEBUG("stored backdrop cache entry %s", filename);
+
+        G_LOCK(xfce_backdrop_cache);
+        xfce_backdrop_cache_trim(dir);
+        G_UNLOCK(xfce_backdrop_cache);
+    } else
+        g_unlink(tmp_filename);
+
+    g_free(tmp_filename);
+    g_free(filename);
+    g_free(dir);
+}
@@ -0,0 +1,577 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* Index of the image files in a backdrop directory, used for cycling.
+ *
+ * There is a single index per directory, shared by every backdrop showing
+ * an image from it.  The directory is enumerated asynchronously once and
+ * then kept up to date from one file monitor.  Files are kept in an array
+ * sorted by their collate key, the same order xfdesktop-settings shows
+ * them in, so picking the next, a random or the n-th image is a lookup
+ * rather than a list walk.  While the directory is being listed, files are
+ * only appended and the array is sorted once at the end. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include <libxfce4util/libxfce4util.h> /* for DBG/TRACE */
+
+#include "xfce-backdrop-dir-index.h"
+#include "xfdesktop-common.h"
+
+#define XFCE_BACKDROP_DIR_INDEX_ATTRIBUTES \
+    G_FILE_ATTRIBUTE_STANDARD_NAME "," G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE
+
+/* files requested from the enumerator at a time */
+#define XFCE_BACKDROP_DIR_INDEX_BATCH 64
+
+typedef struct
+{
+    gchar *path;
+    gchar *collate_key;
+    /* position in the sorted entries array */
+    guint position;
+} XfceBackdropDirEntry;
+
+typedef struct
+{
+    XfceBackdropDirIndexFunc func;
+    gpointer user_data;
+} XfceBackdropDirWatch;
+
+struct _XfceBackdropDirIndex
+{
+    gint ref_count;
+
+    gchar *dir_name;
+    GFile *dir;
+    GFileMonitor *monitor;
+    gboolean loaded;
+
+    /* XfceBackdropDirEntry, sorted by collate key */
+    GPtrArray *entries;
+    /* path -> XfceBackdropDirEntry */
+    GHashTable *lookup;
+
+    GSList *watches;
+};
+
+/* directory name -> XfceBackdropDirIndex, the table holds no reference */
+static GHashTable *xfce_backdrop_dir_indexes = NULL;
+
+
+static XfceBackdropDirIndex *
+xfce_backdrop_dir_index_ref(XfceBackdropDirIndex *index)
+{
+    index->ref_count++;
+    return index;
+}
+
+static void
+xfce_backdrop_dir_entry_free(XfceBackdropDirEntry *entry)
+{
+    g_free(entry->path);
+    g_free(entry->collate_key);
+    g_free(entry);
+}
+
+static void
+xfce_backdrop_dir_index_renumber(XfceBackdropDirIndex *index,
+                                 guint from)
+{
+    guint i;
+
+    for(i = from; i < index->entries->len; i++) {
+        XfceBackdropDirEntry *entry = g_ptr_array_index(index->entries, i);
+        entry->position = i;
+    }
+}
+
+static gint
+xfce_backdrop_dir_entry_compare(gconstpointer a,
+                                gconstpointer b)
+{
+    const XfceBackdropDirEntry *entry_a = *(XfceBackdropDirEntry * const *)a;
+    const XfceBackdropDirEntry *entry_b = *(XfceBackdropDirEntry * const *)b;
+
+    return strcmp(entry_a->collate_key, entry_b->collate_key);
+}
+
+static void
+xfce_backdrop_dir_index_insert(XfceBackdropDirIndex *index,
+                               const gchar *path)
+{
+    XfceBackdropDirEntry *entry;
+    guint lo = 0, hi;
+
+    if(g_hash_table_lookup(index->lookup, path))
+        return;
+
+    entry = g_new0(XfceBackdropDirEntry, 1);
+    entry->path = g_strdup(path);
+    entry->collate_key = g_utf8_collate_key_for_filename(path, -1);
+
+    g_hash_table_insert(index->lookup, entry->path, entry);
+
+    /* still listing, xfce_backdrop_dir_index_loaded() sorts them all */
+    if(!index->loaded) {
+        entry->position = index->entries->len;
+        g_ptr_array_add(index->entries, entry);
+        return;
+    }
+
+    /* binary search for the first entry sorting after the new one */
+    hi = index->entries->len;
+    while(lo < hi) {
+        guint mid = lo + (hi - lo) / 2;
+        XfceBackdropDirEntry *other = g_ptr_array_index(index->entries, mid);
+
+        if(strcmp(other->collate_key, entry->collate_key) <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    g_ptr_array_add(index->entries, NULL);
+    memmove(&index->entries->pdata[lo + 1], &index->entries->pdata[lo],
+            (index->entries->len - lo - 1) * sizeof(gpointer));
+    index->entries->pdata[lo] = entry;
+
+    xfce_backdrop_dir_index_renumber(index, lo);
+}
+
+static void
+xfce_backdrop_dir_index_remove(XfceBackdropDirIndex *index,
+                               const gchar *path)
+{
+    XfceBackdropDirEntry *entry;
+    guint position;
+
+    entry = g_hash_table_lookup(index->lookup, path);
+    if(!entry)
+        return;
+
+    position = entry->position;
+
+    g_hash_table_remove(index->lookup, entry->path);
+    g_ptr_array_remove_index(index->entries, position);
+    xfce_backdrop_dir_entry_free(entry);
+
+    xfce_backdrop_dir_index_renumber(index, position);
+}
+
+static void
+xfce_backdrop_dir_index_notify(XfceBackdropDirIndex *index,
+                               XfceBackdropDirIndexEvent event,
+                               const gchar *filename)
+{
+    GSList *watches, *l;
+
+    /* watchers may remove themselves, or others, while being notified */
+    xfce_backdrop_dir_index_ref(index);
+    watches = g_slist_copy(index->watches);
+
+    for(l = watches; l; l = l->next) {
+        XfceBackdropDirWatch *watch = l->data;
+
+        if(g_slist_find(index->watches, watch))
+            watch->func(index, event, filename, watch->user_data);
+    }
+
+    g_slist_free(watches);
+    xfce_backdrop_dir_index_unref(index);
+}
+
+static void
+xfce_backdrop_dir_index_query_cb(GObject *source_object,
+                                 GAsyncResult *res,
+                                 gpointer user_data)
+{
+    XfceBackdropDirIndex *index = user_data;
+    GFile *file = G_FILE(source_object);
+    GFileInfo *info;
+
+    info = g_file_query_info_finish(file, res, NULL);
+    if(info) {
+        if(xfdesktop_image_mime_type_is_valid(g_file_info_get_content_type(info))) {
+            gchar *path = g_file_get_path(file);
+
+            XF_DEBUG("file added: %s", path);
+            xfce_backdrop_dir_index_insert(index, path);
+
+            g_free(path);
+        }
+
+        g_object_unref(info);
+    }
+
+    xfce_backdrop_dir_index_unref(index);
+}
+
+static void
+xfce_backdrop_dir_index_query(XfceBackdropDirIndex *index,
+                              GFile *file)
+{
+    g_file_query_info_async(file,
+                            G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
+                            G_FILE_QUERY_INFO_NONE,
+                            G_PRIORITY_LOW,
+                            NULL,
+                            xfce_backdrop_dir_index_query_cb,
+                            xfce_backdrop_dir_index_ref(index));
+}
+
+static void
+xfce_backdrop_dir_index_changed_cb(GFileMonitor *monitor,
+                                   GFile *file,
+                                   GFile *other_file,
+                                   GFileMonitorEvent event,
+                                   gpointer user_data)
+{
+    XfceBackdropDirIndex *index = user_data;
+    gchar *changed_file;
+
+    changed_file = g_file_get_path(file);
+    if(!changed_file)
+        return;
+
+    switch(event) {
+        case G_FILE_MONITOR_EVENT_CREATED:
+            /* the type is sniffed from the contents, which may not be there
+             * yet, so this is tried again once the file is complete */
+            if(!g_hash_table_lookup(index->lookup, changed_file))
+                xfce_backdrop_dir_index_query(index, file);
+            break;
+
+        case G_FILE_MONITOR_EVENT_DELETED:
+            XF_DEBUG("file deleted: %s", changed_file);
+            xfce_backdrop_dir_index_remove(index, changed_file);
+            break;
+
+        case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+            XF_DEBUG("file changed: %s", changed_file);
+
+            if(!g_hash_table_lookup(index->lookup, changed_file))
+                xfce_backdrop_dir_index_query(index, file);
+
+            xfce_backdrop_dir_index_notify(index,
+                                           XFCE_BACKDROP_DIR_INDEX_FILE_CHANGED,
+                                           changed_file);
+            break;
+
+        default:
+            break;
+    }
+
+    g_free(changed_file);
+}
+
+static void
+xfce_backdrop_dir_index_loaded(XfceBackdropDirIndex *index)
+{
+    XF_DEBUG("indexed %u images in %s", index->entries->len, index->dir_name);
+
+    g_ptr_array_sort(index->entries, xfce_backdrop_dir_entry_compare);
+    xfce_backdrop_dir_index_renumber(index, 0);
+
+    index->loaded = TRUE;
+    xfce_backdrop_dir_index_notify(index, XFCE_BACKDROP_DIR_INDEX_LOADED, NULL);
+}
+
+static void
+xfce_backdrop_dir_index_next_files_cb(GObject *source_object,
+                                      GAsyncResult *res,
+                                      gpointer user_data)
+{
+    XfceBackdropDirIndex *index = user_data;
+    GFileEnumerator *enumerator = G_FILE_ENUMERATOR(source_object);
+    GList *files, *l;
+
+    files = g_file_enumerator_next_files_finish(enumerator, res, NULL);
+
+    /* done, or failed half way */
+    if(!files) {
+        g_file_enumerator_close_async(enumerator, G_PRIORITY_LOW,
+                                      NULL, NULL, NULL);
+        g_object_unref(enumerator);
+
+        xfce_backdrop_dir_index_loaded(index);
+        xfce_backdrop_dir_index_unref(index);
+        return;
+    }
+
+    for(l = files; l; l = l->next) {
+        GFileInfo *info = l->data;
+
+        if(xfdesktop_image_mime_type_is_valid(g_file_info_get_content_type(info))) {
+            gchar *path = g_build_filename(index->dir_name,
+                                           g_file_info_get_name(info),
+                                           NULL);
+            xfce_backdrop_dir_index_insert(index, path);
+            g_free(path);
+        }
+
+        g_object_unref(info);
+    }
+    g_list_free(files);
+
+    g_file_enumerator_next_files_async(enumerator,
+                                       XFCE_BACKDROP_DIR_INDEX_BATCH,
+                                       G_PRIORITY_LOW,
+                                       NULL,
+                                       xfce_backdrop_dir_index_next_files_cb,
+                                       index);
+}
+
+static void
+xfce_backdrop_dir_index_enumerate_cb(GObject *source_object,
+                                     GAsyncResult *res,
+                                     gpointer user_data)
+{
+    XfceBackdropDirIndex *index = user_data;
+    GFileEnumerator *enumerator;
+    GError *error = NULL;
+
+    enumerator = g_file_enumerate_children_finish(G_FILE(source_object), res, &error);
+    if(!enumerator) {
+        XF_DEBUG("unable to list %s: %s", index->dir_name, error->message);
+        g_error_free(error);
+
+        xfce_backdrop_dir_index_loaded(index);
+        xfce_backdrop_dir_index_unref(index);
+        return;
+    }
+
+    g_file_enumerator_next_files_async(enumerator,
+                                       XFCE_BACKDROP_DIR_INDEX_BATCH,
+                                       G_PRIORITY_LOW,
+                                       NULL,
+                                       xfce_backdrop_dir_index_next_files_cb,
+                                       index);
+}
+
+/**
+ * xfce_backdrop_dir_index_get:
+ * @dir_name: A directory path.
+ *
+ * Returns the shared index of the images in @dir_name, creating it and
+ * starting to list the directory if there is none yet.  Free with
+ * xfce_backdrop_dir_index_unref().
+ **/
+XfceBackdropDirIndex *
+xfce_backdrop_dir_index_get(const gchar *dir_name)
+{
+    XfceBackdropDirIndex *index;
+
+    g_return_val_if_fail(dir_name != NULL, NULL);
+
+    if(G_UNLIKELY(!xfce_backdrop_dir_indexes))
+        xfce_backdrop_dir_indexes = g_hash_table_new(g_str_hash, g_str_equal);
+
+    index = g_hash_table_lookup(xfce_backdrop_dir_indexes, dir_name);
+    if(index)
+        return xfce_backdrop_dir_index_ref(index);
+
+    TRACE("indexing %s", dir_name);
+
+    index = g_new0(XfceBackdropDirIndex, 1);
+    index->ref_count = 1;
+    index->dir_name = g_strdup(dir_name);
+    index->dir = g_file_new_for_path(dir_name);
+    index->entries = g_ptr_array_new();
+    index->lookup = g_hash_table_new(g_str_hash, g_str_equal);
+
+    index->monitor = g_file_monitor_directory(index->dir, G_FILE_MONITOR_NONE,
+                                              NULL, NULL);
+    if(index->monitor) {
+        g_signal_connect(index->monitor, "changed",
+                         G_CALLBACK(xfce_backdrop_dir_index_changed_cb),
+                         index);
+    }
+
+    g_hash_table_insert(xfce_backdrop_dir_indexes, index->dir_name, index);
+
+    /* the listing keeps the index alive until it's done */
+    g_file_enumerate_children_async(index->dir,
+                                    XFCE_BACKDROP_DIR_INDEX_ATTRIBUTES,
+                                    G_FILE_QUERY_INFO_NONE,
+                                    G_PRIORITY_LOW,
+                                    NULL,
+                                    xfce_backdrop_dir_index_enumerate_cb,
+                                    xfce_backdrop_dir_index_ref(index));
+
+    return index;
+}
+
+void
+xfce_backdrop_dir_index_unref(XfceBackdropDirIndex *index)
+{
+    guint i;
+
+    g_return_if_fail(index != NULL);
+
+    if(--index->ref_count > 0)
+        return;
+
+    TRACE("dropping index of %s", index->dir_name);
+
+    g_hash_table_remove(xfce_backdrop_dir_indexes, index->dir_name);
+
+    if(index->monitor) {
+        g_signal_handlers_disconnect_by_func(G_OBJECT(index->monitor),
+                                             G_CALLBACK(xfce_backdrop_dir_index_changed_cb),
+                                             index);
+        g_object_unref(index->monitor);
+    }
+
+    for(i = 0; i < index->entries->len; i++)
+        xfce_backdrop_dir_entry_free(g_ptr_array_index(index->entries, i));
+    g_ptr_array_free(index->entries, TRUE);
+    g_hash_table_destroy(index->lookup);
+
+    g_slist_foreach(index->watches, (GFunc)g_free, NULL);
+    g_slist_free(index->watches);
+
+    g_object_unref(index->dir);
+    g_free(index->dir_name);
+    g_free(index);
+}
+
+/**
+ * xfce_backdrop_dir_index_add_watch:
+ * @index: An #XfceBackdropDirIndex.
+ * @func: Function to call.
+ * @user_data: Data passed to @func.
+ *
+ * Calls @func once the directory has been listed and whenever one of its
+ * files has been modified.
+ **/
+void
+xfce_backdrop_dir_index_add_watch(XfceBackdropDirIndex *index,
+                                  XfceBackdropDirIndexFunc func,
+                                  gpointer user_data)
+{
+    XfceBackdropDirWatch *watch;
+
+    g_return_if_fail(index != NULL && func != NULL);
+
+    watch = g_new0(XfceBackdropDirWatch, 1);
+    watch->func = func;
+    watch->user_data = user_data;
+
+    index->watches = g_slist_append(index->watches, watch);
+}
+
+void
+xfce_backdrop_dir_index_remove_watch(XfceBackdropDirIndex *index,
+                                     XfceBackdropDirIndexFunc func,
+                                     gpointer user_data)
+{
+    GSList *l;
+
+    g_return_if_fail(index != NULL);
+
+    for(l = index->watches; l; l = l->next) {
+        XfceBackdropDirWatch *watch = l->data;
+
+        if(watch->func == func && watch->user_data == user_data) {
+            index->watches = g_slist_delete_link(index->watches, l);
+            g_free(watch);
+            return;
+        }
+    }
+}
+
+/**
+ * xfce_backdrop_dir_index_is_loaded:
+ * @index: An #XfceBackdropDirIndex.
+ *
+ * Returns TRUE once the initial listing of the directory has finished.
+ * Until then the index only holds the files seen so far, in no particular
+ * order.
+ **/
+gboolean
+xfce_backdrop_dir_index_is_loaded(XfceBackdropDirIndex *index)
+{
+    g_return_val_if_fail(index != NULL, FALSE);
+
+    return index->loaded;
+}
+
+guint
+xfce_backdrop_dir_index_get_n_files(XfceBackdropDirIndex *index)
+{
+    g_return_val_if_fail(index != NULL, 0);
+
+    return index->entries->len;
+}
+
+/**
+ * xfce_backdrop_dir_index_get_file:
+ * @index: An #XfceBackdropDirIndex.
+ * @n: Position of the file, in collation order.
+ *
+ * Returns the path of the @n-th image in the directory, owned by the index.
+ **/
+const gchar *
+xfce_backdrop_dir_index_get_file(XfceBackdropDirIndex *index,
+                                 guint n)
+{
+    XfceBackdropDirEntry *entry;
+
+    g_return_val_if_fail(index != NULL, NULL);
+
+    if(n >= index->entries->len)
+        return NULL;
+
+    entry = g_ptr_array_index(index->entries, n);
+
+    return entry->path;
+}
+
+/**
+ * xfce_backdrop_dir_index_find:
+ * @index: An #XfceBackdropDirIndex.
+ * @filename: Path of an image.
+ *
+ * Returns the position of @filename in the index or -1 if it isn't an image
+ * in the indexed directory.
+ **/
+gint
+xfce_backdrop_dir_index_find(XfceBackdropDirIndex *index,
+                             const gchar *filename)
+{
+    XfceBackdropDirEntry *entry;
+
+    g_return_val_if_fail(index != NULL, -1);
+
+    if(!filename)
+        return -1;
+
+    entry = g_hash_table_lookup(index->lookup, filename);
+
+    return entry ? (gint)entry->position : -1;
+}
@@ -0,0 +1,60 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef _XFCE_BACKDROP_DIR_INDEX_H_
+#define _XFCE_BACKDROP_DIR_INDEX_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _XfceBackdropDirIndex XfceBackdropDirIndex;
+
+typedef enum
+{
+    XFCE_BACKDROP_DIR_INDEX_LOADED = 0,
+    XFCE_BACKDROP_DIR_INDEX_FILE_CHANGED,
+} XfceBackdropDirIndexEvent;
+
+typedef void (*XfceBackdropDirIndexFunc)(XfceBackdropDirIndex *index,
+                                         XfceBackdropDirIndexEvent event,
+                                         const gchar *filename,
+                                         gpointer user_data);
+
+XfceBackdropDirIndex *xfce_backdrop_dir_index_get(const gchar *dir_name);
+
+void xfce_backdrop_dir_index_unref            (XfceBackdropDirIndex *index);
+
+void xfce_backdrop_dir_index_add_watch        (XfceBackdropDirIndex *index,
+                                               XfceBackdropDirIndexFunc func,
+                                               gpointer user_data);
+void xfce_backdrop_dir_index_remove_watch     (XfceBackdropDirIndex *index,
+                                               XfceBackdropDirIndexFunc func,
+                                               gpointer user_data);
+
+gboolean xfce_backdrop_dir_index_is_loaded    (XfceBackdropDirIndex *index);
+
+guint xfce_backdrop_dir_index_get_n_files     (XfceBackdropDirIndex *index);
+const gchar *xfce_backdrop_dir_index_get_file (XfceBackdropDirIndex *index,
+                                               guint n);
+gint xfce_backdrop_dir_index_find             (XfceBackdropDirIndex *index,
+                                               const gchar *filename);
+
+G_END_DECLS
+
+#endif
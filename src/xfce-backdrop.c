@@ -30,7 +30,18 @@
 #include <string.h>
 #endif
 
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <gdk/gdk.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gdk-pixbuf/gdk-pixdata.h>
@@ -38,6 +49,8 @@
 #include <libxfce4util/libxfce4util.h> /* for DBG/TRACE */
 
 #include "xfce-backdrop.h"
+#include "xfce-backdrop-cache.h"
+#include "xfce-backdrop-dir-index.h"
 #include "xfce-desktop-enum-types.h"
 #include "xfdesktop-common.h"  /* for DEFAULT_BACKDROP */
 
@@ -47,6 +60,16 @@
 
 #define XFCE_BACKDROP_BUFFER_SIZE 32768
 
+/* compositing is split into horizontal bands of at least this many rows,
+ * one per render thread; smaller areas aren't worth handing off */
+#define XFCE_BACKDROP_MIN_BAND_HEIGHT 128
+#define XFCE_BACKDROP_MAX_RENDER_THREADS 16
+
+/* settings changing faster than this (in ms) only get a preview, rendered
+ * at a fraction of the size, until they stay unchanged that long */
+#define XFCE_BACKDROP_SETTLE_DELAY 250
+#define XFCE_BACKDROP_PREVIEW_SCALE 4
+
 #ifndef O_BINARY
 #define O_BINARY  0
 #endif
@@ -64,25 +87,29 @@ static void xfce_backdrop_get_property(GObject *object,
                                        GParamSpec *pspec);
 static gboolean xfce_backdrop_timer(XfceBackdrop *backdrop);
 
-static GdkPixbuf *xfce_backdrop_generate_canvas(XfceBackdrop *backdrop);
+static GdkPixbuf *xfce_backdrop_generate_canvas(XfceBackdropImageData *image_data);
 
 static void xfce_backdrop_loader_size_prepared_cb(GdkPixbufLoader *loader,
                                                   gint width,
                                                   gint height,
                                                   gpointer user_data);
 
-static void xfce_backdrop_loader_closed_cb(GdkPixbufLoader *loader,
-                                           XfceBackdropImageData *image_data);
+static GdkPixbuf *xfce_backdrop_compose(XfceBackdropImageData *image_data,
+                                        GdkPixbuf *image);
 
-static void xfce_backdrop_file_ready_cb(GObject *source_object,
-                                        GAsyncResult *res,
-                                        gpointer user_data);
+static void xfce_backdrop_generate_thread(GSimpleAsyncResult *result,
+                                          GObject *object,
+                                          GCancellable *cancellable);
 
-static void xfce_backdrop_file_input_stream_ready_cb(GObject *source_object,
-                                                     GAsyncResult *res,
-                                                     gpointer user_data);
+static void xfce_backdrop_generate_ready_cb(GObject *source_object,
+                                            GAsyncResult *res,
+                                            gpointer user_data);
 
 static void xfce_backdrop_image_data_release(XfceBackdropImageData *image_data);
+static void xfce_backdrop_detach_image_data(XfceBackdrop *backdrop);
+static void xfce_backdrop_cycle_backdrop(XfceBackdrop *backdrop);
+static void xfce_backdrop_cancel_prefetch(XfceBackdrop *backdrop);
+static void xfce_backdrop_prefetch_next(XfceBackdrop *backdrop);
 
 gchar *xfce_backdrop_choose_next         (XfceBackdrop *backdrop);
 gchar *xfce_backdrop_choose_random       (XfceBackdrop *backdrop);
@@ -94,18 +121,39 @@ struct _XfceBackdropPriv
     gint bpp;
 
     GdkPixbuf *pix;
+    /* render key of pix, which is shared with identical backdrops */
+    gchar *pix_key;
+    /* pix is only a quick preview, the full render follows */
+    gboolean pix_is_preview;
     XfceBackdropImageData *image_data;
 
+    /* rapid settings changes, see xfce_backdrop_note_change() */
+    gint64 last_change;
+    gboolean changing;
+    guint settle_timer;
+    /* image_path decoded for a preview of the given style and size,
+     * reused while only colors change */
+    GdkPixbuf *preview_source;
+    gchar *preview_source_path;
+    XfceBackdropImageStyle preview_source_style;
+    gint preview_source_width;
+    gint preview_source_height;
+
     XfceBackdropColorStyle color_style;
     GdkColor color1;
     GdkColor color2;
 
     XfceBackdropImageStyle image_style;
     gchar *image_path;
-    /* Cached list of images in the same folder as image_path */
-    GList *image_files;
-    /* monitor for the image_files directory */
-    GFileMonitor *monitor;
+    /* Shared index of the images in the same folder as image_path */
+    XfceBackdropDirIndex *dir_index;
+    /* cycling was requested before the folder was listed */
+    gboolean cycle_pending;
+    /* the next image of the cycle, composed ahead of time */
+    gchar *next_image_path;
+    XfceBackdropImageData *prefetch_data;
+    GdkPixbuf *prefetch_pix;
+    gchar *prefetch_key;
 
     gboolean cycle_backdrop;
     guint cycle_timer;
@@ -114,15 +162,36 @@ struct _XfceBackdropPriv
     gboolean random_backdrop_order;
 };
 
+/* A single backdrop generation.  The settings are copied when it starts so
+ * the worker thread never has to look at the XfceBackdrop itself. */
 struct _XfceBackdropImageData
 {
-    XfceBackdrop *backdrop;
+    GCancellable *cancellable;
 
-    GdkPixbufLoader *loader;
+    /* checksum of all the settings below, plus the image's mtime and size */
+    gchar *key;
+    /* backdrops waiting for the result, each holds a reference */
+    GList *waiters;
+    /* backdrop composing this as its next cycle image, holds a reference */
+    XfceBackdrop *prefetcher;
 
-    GCancellable *cancellable;
+    gint width, height;
+    gint bpp;
+    XfceBackdropColorStyle color_style;
+    GdkColor color1;
+    GdkColor color2;
+    XfceBackdropImageStyle image_style;
+    gchar *image_path;
 
-    guchar *image_buffer;
+    /* a preview is composed at width x height and scaled up to the real
+     * size; it is neither shared nor cached */
+    gboolean preview;
+    gint full_width, full_height;
+    /* the decoded image for a preview, passed in or set by the worker */
+    GdkPixbuf *source;
+
+    /* the composited result, set by the worker */
+    GdkPixbuf *pix;
 };
 
 enum
@@ -150,6 +219,44 @@ enum
 
 static guint backdrop_signals[LAST_SIGNAL] = { 0, };
 
+/* 0 means one per processor */
+static volatile gint xfce_backdrop_render_threads = 0;
+
+/* Backdrops with identical settings share one generation and one pixbuf.
+ * Pending generations and finished pixbufs are both keyed by render key. */
+typedef struct
+{
+    gchar *key;
+    GdkPixbuf *pix;
+    guint n_users;
+} XfceBackdropSharedPix;
+
+static GHashTable *xfce_backdrop_shared_pixbufs = NULL;
+static GHashTable *xfce_backdrop_pending = NULL;
+/* bytes not allocated thanks to sharing, for debugging */
+static gsize xfce_backdrop_shared_bytes = 0;
+/* images read by the worker threads, for debugging */
+static volatile gint xfce_backdrop_n_decodes = 0;
+
+typedef struct
+{
+    const GdkPixbuf *src;
+    GdkPixbuf *dest;
+    gint dest_x, dest_y;
+    gint dest_width, dest_height;
+    gdouble offset_x, offset_y;
+    gdouble scale_x, scale_y;
+    GdkInterpType interp_type;
+    gint overall_alpha;
+    /* bands rendered by the pool are pushed here when done */
+    GAsyncQueue *done;
+} XfceBackdropCompositeBand;
+
+/* renders bands for xfce_backdrop_composite(), created on first use and
+ * kept for the lifetime of the process */
+static GThreadPool *xfce_backdrop_band_pool = NULL;
+G_LOCK_DEFINE_STATIC(xfce_backdrop_band_pool);
+
 /* helper functions */
 
 static GdkPixbuf *
@@ -172,6 +279,16 @@ create_solid(GdkColor *color,
     return pix;
 }
 
+/* color of pixel @i out of @size in a gradient from @color1 to @color2 */
+static void
+gradient_color(GdkColor *color1, GdkColor *color2, gint i, gint size,
+        guint8 rgb[3])
+{
+    rgb[0] = (color1->red + (i * (color2->red - color1->red) / size)) >> 8;
+    rgb[1] = (color1->green + (i * (color2->green - color1->green) / size)) >> 8;
+    rgb[2] = (color1->blue + (i * (color2->blue - color1->blue) / size)) >> 8;
+}
+
 static GdkPixbuf *
 create_gradient(GdkColor *color1, GdkColor *color2, gint width, gint height,
         XfceBackdropColorStyle style)
@@ -198,9 +315,7 @@ create_gradient(GdkColor *color1, GdkColor *color2, gint width, gint height,
 
     if(style == XFCE_BACKDROP_COLOR_HORIZ_GRADIENT) {
         for(i = 0; i < width; i++) {
-            rgb[0] = (color1->red + (i * (color2->red - color1->red) / width)) >> 8;
-            rgb[1] = (color1->green + (i * (color2->green - color1->green) / width)) >> 8;
-            rgb[2] = (color1->blue + (i * (color2->blue - color1->blue) / width)) >> 8;
+            gradient_color(color1, color2, i, width, rgb);
             memcpy(pixdata.pixel_data+(i*3), rgb, 3);
         }
         
@@ -212,9 +327,7 @@ create_gradient(GdkColor *color1, GdkColor *color2, gint width, gint height,
         memset(pixdata.pixel_data, 0x0, width * height * 3);
     else {
         for(i = 0; i < height; i++) {
-            rgb[0] = (color1->red + (i * (color2->red - color1->red) / height)) >> 8;
-            rgb[1] = (color1->green + (i * (color2->green - color1->green) / height)) >> 8;
-            rgb[2] = (color1->blue + (i * (color2->blue - color1->blue) / height)) >> 8;
+            gradient_color(color1, color2, i, height, rgb);
             for(j = 0; j < width; j++)
                 memcpy(pixdata.pixel_data+(i*pixdata.rowstride)+(j*3), rgb, 3);
         }
@@ -232,6 +345,299 @@ create_gradient(GdkColor *color1, GdkColor *color2, gint width, gint height,
     return pix;
 }
 
+/* The gradient create_gradient() composes, as a single row (or column) of
+ * pixels padded over the rest of the backdrop.  A cairo linear gradient
+ * rounds differently, so the pixels are computed the same way here. */
+static cairo_pattern_t *
+create_gradient_pattern(GdkColor *color1, GdkColor *color2, gint width,
+        gint height, XfceBackdropColorStyle style)
+{
+    cairo_surface_t *surface;
+    cairo_pattern_t *pattern;
+    guchar *data;
+    gint i, size, stride;
+    guint8 rgb[3];
+    gboolean horizontal = (style == XFCE_BACKDROP_COLOR_HORIZ_GRADIENT);
+
+    size = horizontal ? width : height;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24,
+                                         horizontal ? size : 1,
+                                         horizontal ? 1 : size);
+    cairo_surface_flush(surface);
+    data = cairo_image_surface_get_data(surface);
+    stride = cairo_image_surface_get_stride(surface);
+
+    for(i = 0; i < size; i++) {
+        guint32 *pixel;
+
+        gradient_color(color1, color2, i, size, rgb);
+
+        if(horizontal)
+            pixel = (guint32 *)data + i;
+        else
+            pixel = (guint32 *)(data + i * stride);
+        *pixel = 0xff000000 | rgb[0] << 16 | rgb[1] << 8 | rgb[2];
+    }
+
+    cairo_surface_mark_dirty(surface);
+
+    pattern = cairo_pattern_create_for_surface(surface);
+    cairo_surface_destroy(surface);
+
+    cairo_pattern_set_extend(pattern, CAIRO_EXTEND_PAD);
+    cairo_pattern_set_filter(pattern, CAIRO_FILTER_NEAREST);
+
+    return pattern;
+}
+
+static gint
+xfce_backdrop_get_n_render_threads(void)
+{
+    gint n_threads = g_atomic_int_get(&xfce_backdrop_render_threads);
+
+    if(n_threads <= 0) {
+#if GLIB_CHECK_VERSION(2, 36, 0)
+        n_threads = g_get_num_processors();
+#elif defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+        n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+        n_threads = 1;
+#endif
+    }
+
+    return CLAMP(n_threads, 1, XFCE_BACKDROP_MAX_RENDER_THREADS);
+}
+
+static void
+xfce_backdrop_composite_band(XfceBackdropCompositeBand *band)
+{
+    gdk_pixbuf_composite(band->src, band->dest,
+                         band->dest_x, band->dest_y,
+                         band->dest_width, band->dest_height,
+                         band->offset_x, band->offset_y,
+                         band->scale_x, band->scale_y,
+                         band->interp_type, band->overall_alpha);
+}
+
+static void
+xfce_backdrop_band_pool_func(gpointer data,
+                             gpointer user_data)
+{
+    XfceBackdropCompositeBand *band = data;
+
+    xfce_backdrop_composite_band(band);
+    g_async_queue_push(band->done, band);
+}
+
+static GThreadPool *
+xfce_backdrop_get_band_pool(void)
+{
+    GThreadPool *pool;
+
+    G_LOCK(xfce_backdrop_band_pool);
+
+    /* the calling thread always renders one band itself */
+    if(G_UNLIKELY(!xfce_backdrop_band_pool)) {
+        xfce_backdrop_band_pool = g_thread_pool_new(xfce_backdrop_band_pool_func,
+                                                     NULL,
+                                                     XFCE_BACKDROP_MAX_RENDER_THREADS - 1,
+                                                     FALSE, NULL);
+    }
+    pool = xfce_backdrop_band_pool;
+
+    G_UNLOCK(xfce_backdrop_band_pool);
+
+    return pool;
+}
+
+/* Same as gdk_pixbuf_composite(), but the destination rectangle is split into
+ * horizontal bands that are rendered in parallel by a shared thread pool.
+ * Every band uses the same offsets and scale, so each destination pixel is
+ * computed exactly as it would be in a single call and the output is
+ * identical. */
+static void
+xfce_backdrop_composite(const GdkPixbuf *src,
+                        GdkPixbuf *dest,
+                        gint dest_x,
+                        gint dest_y,
+                        gint dest_width,
+                        gint dest_height,
+                        gdouble offset_x,
+                        gdouble offset_y,
+                        gdouble scale_x,
+                        gdouble scale_y,
+                        GdkInterpType interp_type,
+                        gint overall_alpha)
+{
+    XfceBackdropCompositeBand *bands;
+    GThreadPool *pool;
+    GAsyncQueue *done;
+    gint n_bands, n_pooled = 0, band_height, i;
+
+    n_bands = MIN(xfce_backdrop_get_n_render_threads(),
+                  dest_height / XFCE_BACKDROP_MIN_BAND_HEIGHT);
+
+    if(n_bands <= 1) {
+        gdk_pixbuf_composite(src, dest, dest_x, dest_y,
+                             dest_width, dest_height,
+                             offset_x, offset_y, scale_x, scale_y,
+                             interp_type, overall_alpha);
+        return;
+    }
+
+    pool = xfce_backdrop_get_band_pool();
+    done = g_async_queue_new();
+    bands = g_new(XfceBackdropCompositeBand, n_bands);
+    band_height = dest_height / n_bands;
+
+    for(i = 0; i < n_bands; i++) {
+        bands[i].src = src;
+        bands[i].dest = dest;
+        bands[i].dest_x = dest_x;
+        bands[i].dest_y = dest_y + i * band_height;
+        bands[i].dest_width = dest_width;
+        /* the last band picks up the remainder */
+        bands[i].dest_height = (i == n_bands - 1
+                                ? dest_y + dest_height - bands[i].dest_y
+                                : band_height);
+        bands[i].offset_x = offset_x;
+        bands[i].offset_y = offset_y;
+        bands[i].scale_x = scale_x;
+        bands[i].scale_y = scale_y;
+        bands[i].interp_type = interp_type;
+        bands[i].overall_alpha = overall_alpha;
+        bands[i].done = done;
+    }
+
+    /* the calling thread renders the first band itself */
+    for(i = 1; i < n_bands; i++) {
+        GError *error = NULL;
+
+        g_thread_pool_push(pool, &bands[i], &error);
+        if(error) {
+            /* couldn't get a thread, do it here instead */
+            g_error_free(error);
+            xfce_backdrop_composite_band(&bands[i]);
+        } else
+            n_pooled++;
+    }
+
+    xfce_backdrop_composite_band(&bands[0]);
+
+    for(i = 0; i < n_pooled; i++)
+        g_async_queue_pop(done);
+
+    g_async_queue_unref(done);
+    g_free(bands);
+}
+
+/**
+ * xfce_backdrop_set_render_threads:
+ * @n_threads: The number of threads to composite a backdrop with, or 0 to
+ *             use one per processor.
+ *
+ * Sets how many threads compositing a single backdrop may use.  This applies
+ * to all backdrops and takes effect with the next generated image.
+ **/
+void
+xfce_backdrop_set_render_threads(guint n_threads)
+{
+    g_atomic_int_set(&xfce_backdrop_render_threads,
+                     MIN(n_threads, XFCE_BACKDROP_MAX_RENDER_THREADS));
+}
+
+guint
+xfce_backdrop_get_render_threads(void)
+{
+    return g_atomic_int_get(&xfce_backdrop_render_threads);
+}
+
+static gsize
+xfce_backdrop_pixbuf_size(GdkPixbuf *pix)
+{
+    return (gsize)gdk_pixbuf_get_rowstride(pix) * gdk_pixbuf_get_height(pix);
+}
+
+static void
+xfce_backdrop_release_shared_pix(const gchar *key)
+{
+    XfceBackdropSharedPix *shared;
+
+    if(!xfce_backdrop_shared_pixbufs)
+        return;
+
+    shared = g_hash_table_lookup(xfce_backdrop_shared_pixbufs, key);
+    if(!shared)
+        return;
+
+    if(--shared->n_users > 0) {
+        xfce_backdrop_shared_bytes -= xfce_backdrop_pixbuf_size(shared->pix);
+        return;
+    }
+
+    g_hash_table_remove(xfce_backdrop_shared_pixbufs, key);
+    g_object_unref(shared->pix);
+    g_free(shared->key);
+    g_slice_free(XfceBackdropSharedPix, shared);
+}
+
+/* makes backdrop display the shared pixbuf for key, pix becomes the shared
+ * one if there is none yet */
+static void
+xfce_backdrop_take_shared_pix(XfceBackdrop *backdrop,
+                              const gchar *key,
+                              GdkPixbuf *pix)
+{
+    XfceBackdropSharedPix *shared;
+
+    if(G_UNLIKELY(!xfce_backdrop_shared_pixbufs))
+        xfce_backdrop_shared_pixbufs = g_hash_table_new(g_str_hash, g_str_equal);
+
+    shared = g_hash_table_lookup(xfce_backdrop_shared_pixbufs, key);
+    if(!shared) {
+        shared = g_slice_new0(XfceBackdropSharedPix);
+        shared->key = g_strdup(key);
+        shared->pix = g_object_ref(pix);
+        g_hash_table_insert(xfce_backdrop_shared_pixbufs, shared->key, shared);
+    } else {
+        xfce_backdrop_shared_bytes += xfce_backdrop_pixbuf_size(shared->pix);
+        XF_DEBUG("sharing backdrop %s, %" G_GSIZE_FORMAT " bytes saved in total",
+                 key, xfce_backdrop_shared_bytes);
+    }
+
+    /* take the new one before letting go of the old, they may be the same */
+    shared->n_users++;
+    xfce_backdrop_clear_cached_image(backdrop);
+
+    backdrop->priv->pix = g_object_ref(shared->pix);
+    backdrop->priv->pix_key = g_strdup(key);
+}
+
+/**
+ * xfce_backdrop_get_shared_bytes:
+ *
+ * Returns the number of bytes that identical backdrops currently don't
+ * allocate because they share their pixbuf.  Meant for debugging.
+ **/
+gsize
+xfce_backdrop_get_shared_bytes(void)
+{
+    return xfce_backdrop_shared_bytes;
+}
+
+/**
+ * xfce_backdrop_get_n_decodes:
+ *
+ * Returns the number of times an image file has been decoded so far,
+ * previews included.  Meant for debugging.
+ **/
+guint
+xfce_backdrop_get_n_decodes(void)
+{
+    return g_atomic_int_get(&xfce_backdrop_n_decodes);
+}
+
 void
 xfce_backdrop_clear_cached_image(XfceBackdrop *backdrop)
 {
@@ -240,87 +646,86 @@ xfce_backdrop_clear_cached_image(XfceBackdrop *backdrop)
     if(backdrop->priv->pix == NULL)
         return;
 
+    if(backdrop->priv->pix_key)
+        xfce_backdrop_release_shared_pix(backdrop->priv->pix_key);
+    g_free(backdrop->priv->pix_key);
+    backdrop->priv->pix_key = NULL;
+    backdrop->priv->pix_is_preview = FALSE;
+
     g_object_unref(backdrop->priv->pix);
     backdrop->priv->pix = NULL;
 }
 
-/* we compare by the collate key so the image listing is the same as how
- * xfdesktop-settings displays the images */
-static gint
-compare_by_collate_key(const gchar *a, const gchar *b)
+/**
+ * xfce_backdrop_note_change:
+ * @backdrop: An #XfceBackdrop.
+ *
+ * Tells @backdrop that one of its settings was just changed from outside,
+ * before the new value is set.  A change right after the previous one means
+ * the settings are being edited interactively, and
+ * xfce_backdrop_generate_async() only previews until they settle.  Setting
+ * up a backdrop or cycling its image doesn't count.
+ **/
+void
+xfce_backdrop_note_change(XfceBackdrop *backdrop)
 {
-    gint ret;
-    gchar *a_key = g_utf8_collate_key_for_filename(a, -1);
-    gchar *b_key = g_utf8_collate_key_for_filename(b, -1);
+    gint64 now;
 
-    ret = g_strcmp0(a_key, b_key);
+    g_return_if_fail(XFCE_IS_BACKDROP(backdrop));
 
-    g_free(a_key);
-    g_free(b_key);
+    now = g_get_monotonic_time();
 
-    return ret;
+    backdrop->priv->changing = (now - backdrop->priv->last_change
+                                < XFCE_BACKDROP_SETTLE_DELAY * 1000);
+    backdrop->priv->last_change = now;
 }
 
-static void
-cb_xfce_backdrop__image_files_changed(GFileMonitor     *monitor,
-                                      GFile            *file,
-                                      GFile            *other_file,
-                                      GFileMonitorEvent event,
-                                      gpointer          user_data)
+static gboolean
+xfce_backdrop_settle_timeout(gpointer user_data)
 {
     XfceBackdrop *backdrop = XFCE_BACKDROP(user_data);
-    gchar *changed_file = NULL;
-    GList *item;
 
-    switch(event) {
-        case G_FILE_MONITOR_EVENT_CREATED:
-            changed_file = g_file_get_path(file);
-
-            XF_DEBUG("file added: %s", changed_file);
-
-            /* Make sure we don't already have the new file in the list */
-            if(g_list_find(backdrop->priv->image_files, changed_file)) {
-                g_free(changed_file);
-                return;
-            }
-
-            /* If the new file is not an image then we don't have to do
-             * anything */
-            if(!xfdesktop_image_file_is_valid(changed_file)) {
-                g_free(changed_file);
-                return;
-            }
+    TRACE("entering");
 
-            /* It is an image file and we don't have it in our list, add it
-             * sorted to our list, don't free changed file, that will happen
-             * when it is removed */
-            backdrop->priv->image_files = g_list_insert_sorted(backdrop->priv->image_files,
-                                                               changed_file,
-                                                               (GCompareFunc)compare_by_collate_key);
-            break;
-        case G_FILE_MONITOR_EVENT_DELETED:
-            changed_file = g_file_get_path(file);
+    backdrop->priv->settle_timer = 0;
+    backdrop->priv->changing = FALSE;
 
-            XF_DEBUG("file deleted: %s", changed_file);
+    /* replace the preview, shown or still in the works, by the real thing */
+    if(backdrop->priv->pix_is_preview
+       || (backdrop->priv->image_data && backdrop->priv->image_data->preview))
+    {
+        XF_DEBUG("settings settled, rendering at full quality");
+        xfce_backdrop_detach_image_data(backdrop);
+        xfce_backdrop_clear_cached_image(backdrop);
+        g_signal_emit(G_OBJECT(backdrop), backdrop_signals[BACKDROP_CHANGED], 0);
+    }
 
-            /* find the file in the list */
-            item = g_list_find_custom(backdrop->priv->image_files,
-                                      changed_file,
-                                      (GCompareFunc)g_strcmp0);
+    return FALSE;
+}
 
-            /* remove it */
-            if(item)
-                backdrop->priv->image_files = g_list_delete_link(backdrop->priv->image_files, item);
+static void
+cb_xfce_backdrop__dir_index_changed(XfceBackdropDirIndex *index,
+                                    XfceBackdropDirIndexEvent event,
+                                    const gchar *filename,
+                                    gpointer user_data)
+{
+    XfceBackdrop *backdrop = XFCE_BACKDROP(user_data);
 
-            g_free(changed_file);
+    switch(event) {
+        case XFCE_BACKDROP_DIR_INDEX_LOADED:
+            if(backdrop->priv->cycle_pending) {
+                backdrop->priv->cycle_pending = FALSE;
+                xfce_backdrop_cycle_backdrop(backdrop);
+            } else if(backdrop->priv->pix && !backdrop->priv->pix_is_preview) {
+                /* the image was ready before the folder was listed */
+                xfce_backdrop_prefetch_next(backdrop);
+            }
             break;
-        case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
-            changed_file = g_file_get_path(file);
 
-            XF_DEBUG("file changed: %s", changed_file);
+        case XFCE_BACKDROP_DIR_INDEX_FILE_CHANGED:
             XF_DEBUG("image_path: %s", backdrop->priv->image_path);
 
-            if(g_strcmp0(changed_file, backdrop->priv->image_path) == 0) {
+            if(g_strcmp0(filename, backdrop->priv->image_path) == 0) {
                 DBG("match");
                 /* clear the outdated backdrop */
                 xfce_backdrop_clear_cached_image(backdrop);
@@ -328,48 +733,22 @@ cb_xfce_backdrop__image_files_changed(GFileMonitor     *monitor,
                 /* backdrop changed! */
                 g_signal_emit(G_OBJECT(backdrop), backdrop_signals[BACKDROP_CHANGED], 0);
             }
-
-            g_free(changed_file);
-            break;
-        default:
             break;
     }
 }
 
-/* Returns a GList of all the image files in the parent directory of filename */
-static GList *
-list_image_files_in_dir(const gchar *filename)
+static void
+xfce_backdrop_release_image_files(XfceBackdrop *backdrop)
 {
-    GDir *dir;
-    gboolean needs_slash = TRUE;
-    const gchar *file;
-    GList *files = NULL;
-    gchar *dir_name;
-
-    dir_name = g_path_get_dirname(filename);
-
-    dir = g_dir_open(dir_name, 0, 0);
-    if(!dir) {
-        g_free(dir_name);
-        return NULL;
-    }
-
-    if(dir_name[strlen(dir_name)-1] == '/')
-        needs_slash = FALSE;
-
-    while((file = g_dir_read_name(dir))) {
-        gchar *current_file = g_strdup_printf(needs_slash ? "%s/%s" : "%s%s",
-                                              dir_name, file);
-        if(xfdesktop_image_file_is_valid(current_file))
-            files = g_list_insert_sorted(files, current_file, (GCompareFunc)compare_by_collate_key);
-        else
-            g_free(current_file);
-    }
-
-    g_dir_close(dir);
-    g_free(dir_name);
+    if(!backdrop->priv->dir_index)
+        return;
 
-    return files;
+    xfce_backdrop_dir_index_remove_watch(backdrop->priv->dir_index,
+                                         cb_xfce_backdrop__dir_index_changed,
+                                         backdrop);
+    xfce_backdrop_dir_index_unref(backdrop->priv->dir_index);
+    backdrop->priv->dir_index = NULL;
+    backdrop->priv->cycle_pending = FALSE;
 }
 
 static void
@@ -377,30 +756,17 @@ xfce_backdrop_load_image_files(XfceBackdrop *backdrop)
 {
     TRACE("entering");
 
-    /* generate the image_files list if it doesn't exist and monitor that
-     * directory so we can update the list */
-    if(backdrop->priv->image_files == NULL && backdrop->priv->image_path) {
+    /* get the index of the images in this directory, which also watches it
+     * so we can update the list */
+    if(backdrop->priv->dir_index == NULL && backdrop->priv->image_path) {
         gchar *dir_name = g_path_get_dirname(backdrop->priv->image_path);
-        GFile *gfile = g_file_new_for_path(dir_name);
-
-        backdrop->priv->image_files = list_image_files_in_dir(backdrop->priv->image_path);
-
-        if(backdrop->priv->monitor) {
-            g_signal_handlers_disconnect_by_func(G_OBJECT(backdrop->priv->monitor),
-                                                 G_CALLBACK(cb_xfce_backdrop__image_files_changed),
-                                                 backdrop);
-
-            g_object_unref(backdrop->priv->monitor);
-        }
 
-        /* monitor the new directory for changes */
-        backdrop->priv->monitor = g_file_monitor(gfile, G_FILE_MONITOR_NONE, NULL, NULL);
-        g_signal_connect(backdrop->priv->monitor, "changed",
-                         G_CALLBACK(cb_xfce_backdrop__image_files_changed),
-                         backdrop);
+        backdrop->priv->dir_index = xfce_backdrop_dir_index_get(dir_name);
+        xfce_backdrop_dir_index_add_watch(backdrop->priv->dir_index,
+                                          cb_xfce_backdrop__dir_index_changed,
+                                          backdrop);
 
         g_free(dir_name);
-        g_object_unref(gfile);
     }
 }
 
@@ -409,35 +775,31 @@ xfce_backdrop_load_image_files(XfceBackdrop *backdrop)
 gchar *
 xfce_backdrop_choose_next(XfceBackdrop *backdrop)
 {
-    GList *current_file;
-    const gchar *filename;
+    XfceBackdropDirIndex *index;
+    gint n_items, cur_file;
 
     TRACE("entering");
 
     g_return_val_if_fail(XFCE_IS_BACKDROP(backdrop), NULL);
 
-    filename = backdrop->priv->image_path;
-
-    if(!backdrop->priv->image_files)
+    index = backdrop->priv->dir_index;
+    if(!index)
         return NULL;
 
-    /* Get the our current background in the list */
-    current_file = g_list_find_custom(backdrop->priv->image_files, filename, (GCompareFunc)g_strcmp0);
+    n_items = xfce_backdrop_dir_index_get_n_files(index);
+    if(n_items == 0)
+        return NULL;
 
-    /* if somehow we don't have a valid file, grab the first one available */
-    if(current_file == NULL) {
-        current_file = g_list_first(backdrop->priv->image_files);
-    } else {
-        /* We want the next valid image file in the dir */
-        current_file = g_list_next(current_file);
+    /* Get the our current background in the list, if somehow we don't have
+     * a valid file this grabs the first one available */
+    cur_file = xfce_backdrop_dir_index_find(index, backdrop->priv->image_path);
 
-        /* we hit the end of the list, wrap around to the front */
-        if(current_file == NULL)
-            current_file = g_list_first(backdrop->priv->image_files);
-    }
+    /* We want the next valid image file in the dir, wrapping around to the
+     * front at the end */
+    cur_file = (cur_file + 1) % n_items;
 
     /* return a copy of our new item */
-    return g_strdup(current_file->data);
+    return g_strdup(xfce_backdrop_dir_index_get_file(index, cur_file));
 }
 
 /* Gets a random valid image file in the folder. Free when done using it.
@@ -446,20 +808,24 @@ gchar *
 xfce_backdrop_choose_random(XfceBackdrop *backdrop)
 {
     static gint previndex = -1;
+    XfceBackdropDirIndex *index;
     gint n_items = 0, cur_file;
 
     TRACE("entering");
 
     g_return_val_if_fail(XFCE_IS_BACKDROP(backdrop), NULL);
 
-    if(!backdrop->priv->image_files)
+    index = backdrop->priv->dir_index;
+    if(!index)
         return NULL;
 
-    n_items = g_list_length(backdrop->priv->image_files);
+    n_items = xfce_backdrop_dir_index_get_n_files(index);
+    if(n_items == 0)
+        return NULL;
 
     /* If there's only 1 item, just return it, easy */
     if(1 == n_items) {
-        return g_strdup(g_list_first(backdrop->priv->image_files)->data);
+        return g_strdup(xfce_backdrop_dir_index_get_file(index, 0));
     }
 
     do {
@@ -470,7 +836,7 @@ xfce_backdrop_choose_random(XfceBackdrop *backdrop)
     previndex = cur_file;
 
     /* return a copy of the new random item */
-    return g_strdup(g_list_nth(backdrop->priv->image_files, cur_file)->data);
+    return g_strdup(xfce_backdrop_dir_index_get_file(index, cur_file));
 }
 
 /* Provides a mapping of image files in the parent folder of file. It selects
@@ -481,21 +847,24 @@ gchar *
 xfce_backdrop_choose_chronological(XfceBackdrop *backdrop)
 {
     GDateTime *datetime;
-    GList *new_file;
+    XfceBackdropDirIndex *index;
     gint n_items = 0, epoch;
 
     TRACE("entering");
 
     g_return_val_if_fail(XFCE_IS_BACKDROP(backdrop), NULL);
 
-    if(!backdrop->priv->image_files)
+    index = backdrop->priv->dir_index;
+    if(!index)
         return NULL;
 
-    n_items = g_list_length(backdrop->priv->image_files);
+    n_items = xfce_backdrop_dir_index_get_n_files(index);
+    if(n_items == 0)
+        return NULL;
 
     /* If there's only 1 item, just return it, easy */
     if(1 == n_items) {
-        return g_strdup(g_list_first(backdrop->priv->image_files)->data);
+        return g_strdup(xfce_backdrop_dir_index_get_file(index, 0));
     }
 
     datetime = g_date_time_new_now_local();
@@ -505,12 +874,10 @@ xfce_backdrop_choose_chronological(XfceBackdrop *backdrop)
     epoch = (gdouble)g_date_time_get_hour(datetime) / (24.0f / MIN(n_items, 24.0f));
     XF_DEBUG("epoch %d, hour %d, items %d", epoch, g_date_time_get_hour(datetime), n_items);
 
-    new_file = g_list_nth(backdrop->priv->image_files, epoch);
-
     g_date_time_unref(datetime);
 
     /* return a copy of our new file */
-    return g_strdup(new_file->data);
+    return g_strdup(xfce_backdrop_dir_index_get_file(index, epoch));
 }
 
 /* gobject-related functions */
@@ -655,22 +1022,20 @@ xfce_backdrop_finalize(GObject *object)
         backdrop->priv->cycle_timer_id = 0;
     }
 
-    xfce_backdrop_clear_cached_image(backdrop);
+    if(backdrop->priv->settle_timer != 0) {
+        g_source_remove(backdrop->priv->settle_timer);
+        backdrop->priv->settle_timer = 0;
+    }
 
-    if(backdrop->priv->monitor) {
-        g_signal_handlers_disconnect_by_func(G_OBJECT(backdrop->priv->monitor),
-                                             G_CALLBACK(cb_xfce_backdrop__image_files_changed),
-                                             backdrop);
+    xfce_backdrop_clear_cached_image(backdrop);
+    xfce_backdrop_cancel_prefetch(backdrop);
 
-        g_object_unref(backdrop->priv->monitor);
-        backdrop->priv->monitor = NULL;
-    }
+    if(backdrop->priv->preview_source)
+        g_object_unref(backdrop->priv->preview_source);
+    g_free(backdrop->priv->preview_source_path);
 
-    /* Free the image files list */
-    if(backdrop->priv->image_files) {
-        g_list_free_full(backdrop->priv->image_files, g_free);
-        backdrop->priv->image_files = NULL;
-    }
+    /* Release the image files index */
+    xfce_backdrop_release_image_files(backdrop);
 
     G_OBJECT_CLASS(xfce_backdrop_parent_class)->finalize(object);
 }
@@ -855,6 +1220,7 @@ xfce_backdrop_set_size(XfceBackdrop *backdrop, gint width, gint height)
     if(backdrop->priv->width != width ||
        backdrop->priv->height != height) {
         xfce_backdrop_clear_cached_image(backdrop);
+        xfce_backdrop_cancel_prefetch(backdrop);
         backdrop->priv->width = width;
         backdrop->priv->height = height;
     }
@@ -876,6 +1242,7 @@ xfce_backdrop_set_color_style(XfceBackdrop *backdrop,
 
     if(style != backdrop->priv->color_style) {
         xfce_backdrop_clear_cached_image(backdrop);
+        xfce_backdrop_cancel_prefetch(backdrop);
         backdrop->priv->color_style = style;
         g_signal_emit(G_OBJECT(backdrop), backdrop_signals[BACKDROP_CHANGED], 0);
     }
@@ -911,6 +1278,7 @@ xfce_backdrop_set_first_color(XfceBackdrop *backdrop,
             || color->blue != backdrop->priv->color1.blue)
     {
         xfce_backdrop_clear_cached_image(backdrop);
+        xfce_backdrop_cancel_prefetch(backdrop);
         backdrop->priv->color1.red = color->red;
         backdrop->priv->color1.green = color->green;
         backdrop->priv->color1.blue = color->blue;
@@ -948,6 +1316,7 @@ xfce_backdrop_set_second_color(XfceBackdrop *backdrop,
             || color->blue != backdrop->priv->color2.blue)
     {
         xfce_backdrop_clear_cached_image(backdrop);
+        xfce_backdrop_cancel_prefetch(backdrop);
         backdrop->priv->color2.red = color->red;
         backdrop->priv->color2.green = color->green;
         backdrop->priv->color2.blue = color->blue;
@@ -983,6 +1352,7 @@ xfce_backdrop_set_image_style(XfceBackdrop *backdrop,
     
     if(style != backdrop->priv->image_style) {
         xfce_backdrop_clear_cached_image(backdrop);
+        xfce_backdrop_cancel_prefetch(backdrop);
         backdrop->priv->image_style = style;
         g_signal_emit(G_OBJECT(backdrop), backdrop_signals[BACKDROP_CHANGED], 0);
     }
@@ -1017,28 +1387,20 @@ xfce_backdrop_set_image_filename(XfceBackdrop *backdrop, const gchar *filename)
     if(g_strcmp0(backdrop->priv->image_path, filename) == 0)
         return;
 
-    /* We need to free the image_files if image_path changed directories */
-    if(backdrop->priv->image_files) {
+    /* keep the prefetched image if this is the one it was composed for */
+    if(g_strcmp0(backdrop->priv->next_image_path, filename) != 0)
+        xfce_backdrop_cancel_prefetch(backdrop);
+
+    /* We need to release the image files if image_path changed directories */
+    if(backdrop->priv->dir_index) {
         if(backdrop->priv->image_path)
             old_dir = g_path_get_dirname(backdrop->priv->image_path);
         if(filename)
             new_dir = g_path_get_dirname(filename);
 
-        /* Directories did change, free list */
-        if(g_strcmp0(old_dir, new_dir) != 0) {
-            g_list_free_full(backdrop->priv->image_files, g_free);
-            backdrop->priv->image_files = NULL;
-
-            /* release the directory monitor */
-            if(backdrop->priv->monitor) {
-                g_signal_handlers_disconnect_by_func(G_OBJECT(backdrop->priv->monitor),
-                                                     G_CALLBACK(cb_xfce_backdrop__image_files_changed),
-                                                     backdrop);
-
-                g_object_unref(backdrop->priv->monitor);
-                backdrop->priv->monitor = NULL;
-            }
-        }
+        /* Directories did change, release the index */
+        if(g_strcmp0(old_dir, new_dir) != 0)
+            xfce_backdrop_release_image_files(backdrop);
 
         g_free(old_dir);
         g_free(new_dir);
@@ -1082,9 +1444,24 @@ xfce_backdrop_cycle_backdrop(XfceBackdrop *backdrop)
     if(backdrop->priv->image_path == NULL || !backdrop->priv->cycle_backdrop)
         return;
 
+    /* the folder is still being listed, cycle once that's done */
+    if(backdrop->priv->dir_index
+       && !xfce_backdrop_dir_index_is_loaded(backdrop->priv->dir_index))
+    {
+        XF_DEBUG("image folder not indexed yet, cycling later");
+        backdrop->priv->cycle_pending = TRUE;
+        return;
+    }
+
     if(period == XFCE_BACKDROP_PERIOD_CHRONOLOGICAL) {
         /* chronological first */
         new_backdrop = xfce_backdrop_choose_chronological(backdrop);
+    } else if(backdrop->priv->next_image_path && backdrop->priv->dir_index
+              && xfce_backdrop_dir_index_find(backdrop->priv->dir_index,
+                                              backdrop->priv->next_image_path) != -1)
+    {
+        /* picked, and hopefully composed, ahead of time */
+        new_backdrop = g_strdup(backdrop->priv->next_image_path);
     } else if(backdrop->priv->random_backdrop_order) {
         /* then random */
         new_backdrop = xfce_backdrop_choose_random(backdrop);
@@ -1094,7 +1471,7 @@ xfce_backdrop_cycle_backdrop(XfceBackdrop *backdrop)
     }
 
     /* Only emit the cycle signal if something changed */
-    if(g_strcmp0(backdrop->priv->image_path, new_backdrop) != 0) {
+    if(new_backdrop && g_strcmp0(backdrop->priv->image_path, new_backdrop) != 0) {
         xfce_backdrop_set_image_filename(backdrop, new_backdrop);
         g_signal_emit(G_OBJECT(backdrop), backdrop_signals[BACKDROP_CYCLE], 0);
     }
@@ -1212,6 +1589,9 @@ xfce_backdrop_set_cycle_timer(XfceBackdrop *backdrop, guint cycle_timer)
     /* remove old timer first */
     xfce_backdrop_remove_backdrop_timer(backdrop);
 
+    /* what comes next depends on the cycle settings */
+    xfce_backdrop_cancel_prefetch(backdrop);
+
     if(backdrop->priv->cycle_timer != 0 && backdrop->priv->cycle_backdrop == TRUE) {
         switch(backdrop->priv->cycle_period) {
             case XFCE_BACKDROP_PERIOD_SECONDS:
@@ -1298,11 +1678,8 @@ xfce_backdrop_set_cycle_backdrop(XfceBackdrop *backdrop,
                                       xfce_backdrop_get_cycle_timer(backdrop));
     }
 
-    /* If we're not cycling anymore, free the image files list */
-    if(!backdrop->priv->cycle_backdrop && backdrop->priv->image_files) {
-        g_list_free_full(backdrop->priv->image_files, g_free);
-        backdrop->priv->image_files = NULL;
-    }
+    if(!backdrop->priv->cycle_backdrop)
+        backdrop->priv->cycle_pending = FALSE;
 }
 
 gboolean
@@ -1365,7 +1742,10 @@ xfce_backdrop_set_random_order(XfceBackdrop *backdrop,
 
     TRACE("entering");
 
-    backdrop->priv->random_backdrop_order = random_order;
+    if(backdrop->priv->random_backdrop_order != random_order) {
+        backdrop->priv->random_backdrop_order = random_order;
+        xfce_backdrop_cancel_prefetch(backdrop);
+    }
 }
 
 gboolean
@@ -1393,30 +1773,24 @@ xfce_backdrop_force_cycle(XfceBackdrop *backdrop)
 /* Generates the background that will either be displayed or will have the
  * image drawn on top of */
 static GdkPixbuf *
-xfce_backdrop_generate_canvas(XfceBackdrop *backdrop)
+xfce_backdrop_generate_canvas(XfceBackdropImageData *image_data)
 {
     gint w, h;
     GdkPixbuf *final_image;
 
-    w = backdrop->priv->width;
-    h = backdrop->priv->height;
-
-    /* In case we somehow end up here, give a warning and apply a temp fix */
-    if(backdrop->priv->color_style == XFCE_BACKDROP_COLOR_INVALID) {
-        g_warning("xfce_backdrop_generate_canvas: Invalid color style");
-        backdrop->priv->color_style = XFCE_BACKDROP_COLOR_SOLID;
-    }
+    w = image_data->width;
+    h = image_data->height;
 
-    if(backdrop->priv->color_style == XFCE_BACKDROP_COLOR_SOLID)
-        final_image = create_solid(&backdrop->priv->color1, w, h, FALSE, 0xff);
-    else if(backdrop->priv->color_style == XFCE_BACKDROP_COLOR_TRANSPARENT) {
+    if(image_data->color_style == XFCE_BACKDROP_COLOR_SOLID)
+        final_image = create_solid(&image_data->color1, w, h, FALSE, 0xff);
+    else if(image_data->color_style == XFCE_BACKDROP_COLOR_TRANSPARENT) {
         GdkColor c = { 0, 0xffff, 0xffff, 0xffff };
         final_image = create_solid(&c, w, h, TRUE, 0x00);
     } else {
-        final_image = create_gradient(&backdrop->priv->color1,
-                &backdrop->priv->color2, w, h, backdrop->priv->color_style);
+        final_image = create_gradient(&image_data->color1,
+                &image_data->color2, w, h, image_data->color_style);
         if(!final_image)
-            final_image = create_solid(&backdrop->priv->color1, w, h, FALSE, 0xff);
+            final_image = create_solid(&image_data->color1, w, h, FALSE, 0xff);
     }
 
     return final_image;
@@ -1430,102 +1804,636 @@ xfce_backdrop_image_data_release(XfceBackdropImageData *image_data)
     if(!image_data)
         return;
 
-    /* Only set the backdrop's image_data to NULL if it's current */
-    if(image_data->backdrop->priv->image_data == image_data)
-        image_data->backdrop->priv->image_data = NULL;
-
     if(image_data->cancellable)
         g_object_unref(image_data->cancellable);
 
-    if(image_data->image_buffer)
-        g_free(image_data->image_buffer);
+    if(image_data->pix)
+        g_object_unref(image_data->pix);
+
+    if(image_data->source)
+        g_object_unref(image_data->source);
 
-    if(image_data->loader)
-        g_object_unref(image_data->loader);
+    if(image_data->prefetcher)
+        g_object_unref(image_data->prefetcher);
+
+    g_free(image_data->key);
+    g_free(image_data->image_path);
+    g_free(image_data);
 }
 
-/**
- * xfce_backdrop_get_pixbuf:
- * @backdrop: An #XfceBackdrop.
- *
- * Returns the composited backdrop image if one has been generated. If it
- * returns NULL, call xfce_backdrop_generate_async to create the pixbuf.
- * Free with g_object_unref() when you are finished.
- **/
-GdkPixbuf *
-xfce_backdrop_get_pixbuf(XfceBackdrop *backdrop)
+/* Returns a checksum over everything that goes into the composed image, the
+ * image file's mtime and size included, so a modified image gets a new key */
+static gchar *
+xfce_backdrop_image_data_get_key(XfceBackdropImageData *image_data)
 {
-    TRACE("entering");
+    struct stat st;
+    gint64 mtime = -1, size = -1;
+    gchar *description, *key;
 
-    if(backdrop->priv->pix) {
-        /* return a reference so we can cache it */
-        return g_object_ref(backdrop->priv->pix);
+    if(image_data->image_path && g_stat(image_data->image_path, &st) == 0) {
+        mtime = st.st_mtime;
+        size = st.st_size;
     }
 
-    /* !backdrop->priv->pix, call xfce_backdrop_generate_async */
-    return NULL;
+    description = g_strdup_printf("%s\n%" G_GINT64_FORMAT "\n%" G_GINT64_FORMAT
+                                  "\n%dx%d\n%d\n%d\n%d"
+                                  "\n%04x%04x%04x\n%04x%04x%04x",
+                                  image_data->image_path ? image_data->image_path : "",
+                                  mtime, size,
+                                  image_data->width, image_data->height,
+                                  image_data->bpp,
+                                  image_data->image_style,
+                                  image_data->color_style,
+                                  image_data->color1.red,
+                                  image_data->color1.green,
+                                  image_data->color1.blue,
+                                  image_data->color2.red,
+                                  image_data->color2.green,
+                                  image_data->color2.blue);
+
+    key = g_compute_checksum_for_string(G_CHECKSUM_SHA256, description, -1);
+    g_free(description);
+
+    return key;
 }
 
-/**
- * xfce_backdrop_generate_async:
- * @backdrop: An #XfceBackdrop.
- *
- * Generates the final composited, resized image from the #XfceBackdrop.
- * Emits the "ready" signal when the image has been created.
- **/
-void
-xfce_backdrop_generate_async(XfceBackdrop *backdrop)
+/* Copies the settings of @backdrop, with @image_path as the image, into a
+ * new generation */
+static XfceBackdropImageData *
+xfce_backdrop_image_data_new(XfceBackdrop *backdrop,
+                             const gchar *image_path)
 {
-    GFile *file;
-    XfceBackdropImageData *image_data = NULL;
-    const gchar *image_path;
-
-    TRACE("entering");
-
-    if(backdrop->priv->width == 0 || backdrop->priv->height == 0) {
-        g_critical("attempting to create a backdrop without setting the width/height");
-        return;
-    }
+    XfceBackdropImageData *image_data = g_new0(XfceBackdropImageData, 1);
 
-    if(backdrop->priv->image_data && backdrop->priv->image_data->cancellable) {
-        g_cancellable_cancel(backdrop->priv->image_data->cancellable);
-        backdrop->priv->image_data = NULL;
-    }
-
-    /* If we aren't going to display an image then just create the canvas */
-    if(backdrop->priv->image_style == XFCE_BACKDROP_IMAGE_NONE) {
-        backdrop->priv->pix = xfce_backdrop_generate_canvas(backdrop);
-        g_signal_emit(G_OBJECT(backdrop), backdrop_signals[BACKDROP_READY], 0);
-        return;
-    }
+    image_data->width = backdrop->priv->width;
+    image_data->height = backdrop->priv->height;
+    image_data->bpp = backdrop->priv->bpp;
+    image_data->color_style = backdrop->priv->color_style;
+    image_data->color1 = backdrop->priv->color1;
+    image_data->color2 = backdrop->priv->color2;
+    image_data->image_style = backdrop->priv->image_style;
 
     /* If we're trying to display an image, attempt to use the one the user
      * set. If there's none set at all, fall back to our default */
-    if(backdrop->priv->image_path != NULL)
-        image_path = backdrop->priv->image_path;
-    else
-        image_path = DEFAULT_BACKDROP;
+    if(image_data->image_style != XFCE_BACKDROP_IMAGE_NONE) {
+        if(image_path != NULL)
+            image_data->image_path = g_strdup(image_path);
+        else
+            image_data->image_path = g_strdup(DEFAULT_BACKDROP);
+    }
 
-    XF_DEBUG("loading image %s", image_path);
+    image_data->key = xfce_backdrop_image_data_get_key(image_data);
 
-    file = g_file_new_for_path(image_path);
+    return image_data;
+}
 
-    image_data = g_new0(XfceBackdropImageData, 1);
-    backdrop->priv->image_data = image_data;
+/* Runs the generation in a worker thread, identical requests made until it
+ * finishes join it */
+static void
+xfce_backdrop_image_data_start(XfceBackdropImageData *image_data)
+{
+    GSimpleAsyncResult *result;
+
+    if(G_UNLIKELY(!xfce_backdrop_pending))
+        xfce_backdrop_pending = g_hash_table_new(g_str_hash, g_str_equal);
 
-    image_data->backdrop = backdrop;
-    image_data->loader = gdk_pixbuf_loader_new();
     image_data->cancellable = g_cancellable_new();
-    image_data->image_buffer = g_new0(guchar, XFCE_BACKDROP_BUFFER_SIZE);
+    if(!image_data->preview)
+        g_hash_table_insert(xfce_backdrop_pending, image_data->key, image_data);
+
+    result = g_simple_async_result_new(NULL,
+                                       xfce_backdrop_generate_ready_cb,
+                                       NULL,
+                                       xfce_backdrop_generate_async);
+    g_simple_async_result_set_op_res_gpointer(result, image_data,
+                                              (GDestroyNotify)xfce_backdrop_image_data_release);
+
+    g_simple_async_result_run_in_thread(result,
+                                        xfce_backdrop_generate_thread,
+                                        G_PRIORITY_DEFAULT,
+                                        image_data->cancellable);
+    g_object_unref(result);
+}
+
+/* cancels a generation once neither a waiting backdrop nor a prefetch
+ * needs its result anymore */
+static void
+xfce_backdrop_image_data_abandon(XfceBackdropImageData *image_data)
+{
+    if(image_data->waiters)
+        return;
+
+    if(image_data->prefetcher
+       && image_data->prefetcher->priv->prefetch_data == image_data)
+    {
+        return;
+    }
+
+    g_cancellable_cancel(image_data->cancellable);
+
+    if(xfce_backdrop_pending
+       && g_hash_table_lookup(xfce_backdrop_pending, image_data->key) == image_data)
+    {
+        g_hash_table_remove(xfce_backdrop_pending, image_data->key);
+    }
+}
+
+/* stops waiting for the backdrop's current generation, which is canceled
+ * if no other backdrop is waiting for it either */
+static void
+xfce_backdrop_detach_image_data(XfceBackdrop *backdrop)
+{
+    XfceBackdropImageData *image_data = backdrop->priv->image_data;
+
+    if(!image_data)
+        return;
+
+    backdrop->priv->image_data = NULL;
+
+    image_data->waiters = g_list_remove(image_data->waiters, backdrop);
+    xfce_backdrop_image_data_abandon(image_data);
+
+    g_object_unref(backdrop);
+}
+
+/* drops the prefetched next image, or stops composing it */
+static void
+xfce_backdrop_cancel_prefetch(XfceBackdrop *backdrop)
+{
+    XfceBackdropPriv *priv = backdrop->priv;
+    XfceBackdropImageData *image_data = priv->prefetch_data;
+
+    if(image_data) {
+        XF_DEBUG("canceling prefetch of %s", image_data->image_path);
+
+        /* the prefetcher reference is dropped once the generation ends */
+        priv->prefetch_data = NULL;
+        xfce_backdrop_image_data_abandon(image_data);
+    }
+
+    if(priv->prefetch_pix) {
+        g_object_unref(priv->prefetch_pix);
+        priv->prefetch_pix = NULL;
+    }
+
+    g_free(priv->prefetch_key);
+    priv->prefetch_key = NULL;
+    g_free(priv->next_image_path);
+    priv->next_image_path = NULL;
+}
+
+/* Picks the image the next cycle will switch to and composes it in the
+ * background, so the switch itself doesn't have to wait for decoding */
+static void
+xfce_backdrop_prefetch_next(XfceBackdrop *backdrop)
+{
+    XfceBackdropPriv *priv = backdrop->priv;
+    XfceBackdropImageData *image_data;
+    XfceBackdropSharedPix *shared;
+    gchar *next;
+
+    TRACE("entering");
+
+    /* chronological cycling changes only once an hour, not worth it */
+    if(!priv->cycle_backdrop || priv->cycle_timer == 0
+       || priv->cycle_period == XFCE_BACKDROP_PERIOD_STARTUP
+       || priv->cycle_period == XFCE_BACKDROP_PERIOD_CHRONOLOGICAL
+       || priv->image_style == XFCE_BACKDROP_IMAGE_NONE
+       || priv->width == 0 || priv->height == 0
+       || !priv->dir_index || !xfce_backdrop_dir_index_is_loaded(priv->dir_index))
+    {
+        return;
+    }
+
+    if(priv->random_backdrop_order)
+        next = xfce_backdrop_choose_random(backdrop);
+    else
+        next = xfce_backdrop_choose_next(backdrop);
+
+    if(!next || g_strcmp0(next, priv->image_path) == 0) {
+        g_free(next);
+        return;
+    }
+
+    xfce_backdrop_cancel_prefetch(backdrop);
+    priv->next_image_path = next;
+
+    image_data = xfce_backdrop_image_data_new(backdrop, next);
+
+    /* already on display somewhere else */
+    if(xfce_backdrop_shared_pixbufs
+       && (shared = g_hash_table_lookup(xfce_backdrop_shared_pixbufs, image_data->key)))
+    {
+        priv->prefetch_pix = g_object_ref(shared->pix);
+        priv->prefetch_key = g_strdup(image_data->key);
+        xfce_backdrop_image_data_release(image_data);
+        return;
+    }
+
+    /* or being generated, the cycle will simply join that */
+    if(xfce_backdrop_pending
+       && g_hash_table_lookup(xfce_backdrop_pending, image_data->key))
+    {
+        xfce_backdrop_image_data_release(image_data);
+        return;
+    }
+
+    XF_DEBUG("prefetching %s", next);
+
+    image_data->prefetcher = g_object_ref(backdrop);
+    priv->prefetch_data = image_data;
+
+    xfce_backdrop_image_data_start(image_data);
+}
+
+/**
+ * xfce_backdrop_get_pixbuf:
+ * @backdrop: An #XfceBackdrop.
+ *
+ * Returns the composited backdrop image if one has been generated. If it
+ * returns NULL, call xfce_backdrop_generate_async to create the pixbuf.
+ * For tiled backdrops this is the tile and for spanning backdrops only the
+ * image, see xfce_backdrop_render_area().
+ * Free with g_object_unref() when you are finished.
+ **/
+GdkPixbuf *
+xfce_backdrop_get_pixbuf(XfceBackdrop *backdrop)
+{
+    TRACE("entering");
+
+    if(backdrop->priv->pix) {
+        /* return a reference so we can cache it */
+        return g_object_ref(backdrop->priv->pix);
+    }
+
+    /* !backdrop->priv->pix, call xfce_backdrop_generate_async */
+    return NULL;
+}
+
+/**
+ * xfce_backdrop_render_area:
+ * @backdrop: An #XfceBackdrop.
+ * @area: The part of the backdrop to draw, in backdrop coordinates.
+ *
+ * Spanning backdrops are too large to be composed in one piece, for those
+ * xfce_backdrop_get_pixbuf() only returns the image.  This scales the part
+ * of the image covering @area into a new pixbuf of the size of @area, so
+ * the backdrop can be drawn one monitor at a time.  Where the image has
+ * transparent parts, so does the result; the canvas underneath is
+ * available from xfce_backdrop_create_canvas_pattern().  Returns NULL if
+ * the image hasn't been generated yet.  Free with g_object_unref().
+ **/
+GdkPixbuf *
+xfce_backdrop_render_area(XfceBackdrop *backdrop,
+                          const GdkRectangle *area)
+{
+    XfceBackdropPriv *priv;
+    GdkPixbuf *area_pix;
+    gint iw, ih;
+    gdouble scale, xo, yo;
+    GdkInterpType interp;
+
+    g_return_val_if_fail(XFCE_IS_BACKDROP(backdrop), NULL);
+    g_return_val_if_fail(area != NULL && area->width > 0 && area->height > 0, NULL);
+
+    priv = backdrop->priv;
+    if(!priv->pix)
+        return NULL;
+
+    iw = gdk_pixbuf_get_width(priv->pix);
+    ih = gdk_pixbuf_get_height(priv->pix);
+
+    /* zoomed over the whole backdrop, like xfce_backdrop_compose() does */
+    scale = MAX((gdouble)priv->width / iw, (gdouble)priv->height / ih);
+    xo = (priv->width - iw * scale) * 0.5;
+    yo = (priv->height - ih * scale) * 0.5;
+
+    if(scale == 1.0)
+        interp = GDK_INTERP_NEAREST;
+    else if(priv->bpp < 24)
+        interp = GDK_INTERP_HYPER;
+    else
+        interp = GDK_INTERP_BILINEAR;
+
+    area_pix = gdk_pixbuf_new(GDK_COLORSPACE_RGB,
+                              gdk_pixbuf_get_has_alpha(priv->pix), 8,
+                              area->width, area->height);
+    if(!area_pix)
+        return NULL;
+
+    if(gdk_pixbuf_get_has_alpha(area_pix))
+        gdk_pixbuf_fill(area_pix, 0x00000000);
+
+    xfce_backdrop_composite(priv->pix, area_pix, 0, 0,
+                            area->width, area->height,
+                            xo - area->x, yo - area->y, scale, scale,
+                            interp, 255);
+
+    return area_pix;
+}
+
+/**
+ * xfce_backdrop_create_canvas_pattern:
+ * @backdrop: An #XfceBackdrop.
+ *
+ * Returns the solid color or gradient the backdrop image is drawn on, as a
+ * pattern in backdrop coordinates with (0, 0) being the top left corner.
+ * Painted at whole pixel offsets, it gives the very pixels of a composed
+ * canvas.  Tiled backdrops only compose the tile, which has to be repeated
+ * over this pattern.  Free with cairo_pattern_destroy().
+ **/
+cairo_pattern_t *
+xfce_backdrop_create_canvas_pattern(XfceBackdrop *backdrop)
+{
+    XfceBackdropPriv *priv;
+
+    g_return_val_if_fail(XFCE_IS_BACKDROP(backdrop), NULL);
+
+    priv = backdrop->priv;
+
+    switch(priv->color_style) {
+        case XFCE_BACKDROP_COLOR_TRANSPARENT:
+            return cairo_pattern_create_rgba(1.0, 1.0, 1.0, 0.0);
+
+        case XFCE_BACKDROP_COLOR_HORIZ_GRADIENT:
+        case XFCE_BACKDROP_COLOR_VERT_GRADIENT:
+            if(priv->width > 0 && priv->height > 0) {
+                return create_gradient_pattern(&priv->color1, &priv->color2,
+                                               priv->width, priv->height,
+                                               priv->color_style);
+            }
+            /* fall through, there's no size to spread it over yet */
+
+        case XFCE_BACKDROP_COLOR_SOLID:
+        default:
+            return cairo_pattern_create_rgb(priv->color1.red / 65535.0,
+                                            priv->color1.green / 65535.0,
+                                            priv->color1.blue / 65535.0);
+    }
+}
+
+/**
+ * xfce_backdrop_create_color_pattern:
+ * @backdrop: An #XfceBackdrop.
+ *
+ * Backdrops without an image are only a solid color or a gradient, which
+ * can be drawn straight into the destination without composing a
+ * screen-sized pixbuf first.  Returns the canvas pattern for such backdrops
+ * or NULL if the backdrop has an image and xfce_backdrop_get_pixbuf() has
+ * to be used.  Free with cairo_pattern_destroy().
+ **/
+cairo_pattern_t *
+xfce_backdrop_create_color_pattern(XfceBackdrop *backdrop)
+{
+    g_return_val_if_fail(XFCE_IS_BACKDROP(backdrop), NULL);
+
+    if(backdrop->priv->image_style != XFCE_BACKDROP_IMAGE_NONE
+       || backdrop->priv->width <= 0 || backdrop->priv->height <= 0)
+    {
+        return NULL;
+    }
+
+    return xfce_backdrop_create_canvas_pattern(backdrop);
+}
+
+/**
+ * xfce_backdrop_is_generating:
+ * @backdrop: An #XfceBackdrop.
+ *
+ * Returns TRUE while a generation started by xfce_backdrop_generate_async()
+ * is still running for @backdrop.
+ **/
+gboolean
+xfce_backdrop_is_generating(XfceBackdrop *backdrop)
+{
+    g_return_val_if_fail(XFCE_IS_BACKDROP(backdrop), FALSE);
+
+    return backdrop->priv->image_data != NULL;
+}
+
+/**
+ * xfce_backdrop_is_preview:
+ * @backdrop: An #XfceBackdrop.
+ *
+ * Returns TRUE if the image from xfce_backdrop_get_pixbuf() is only a quick
+ * preview, which the full render replaces once the settings have settled.
+ **/
+gboolean
+xfce_backdrop_is_preview(XfceBackdrop *backdrop)
+{
+    g_return_val_if_fail(XFCE_IS_BACKDROP(backdrop), FALSE);
+
+    return backdrop->priv->pix != NULL && backdrop->priv->pix_is_preview;
+}
+
+/**
+ * xfce_backdrop_is_prefetching:
+ * @backdrop: An #XfceBackdrop.
+ *
+ * Returns TRUE while the next image of the cycle is being composed ahead
+ * of time.
+ **/
+gboolean
+xfce_backdrop_is_prefetching(XfceBackdrop *backdrop)
+{
+    g_return_val_if_fail(XFCE_IS_BACKDROP(backdrop), FALSE);
+
+    return backdrop->priv->prefetch_data != NULL;
+}
+
+/**
+ * xfce_backdrop_get_prefetched_filename:
+ * @backdrop: An #XfceBackdrop.
+ *
+ * Returns the image the next cycle will switch to if it has already been
+ * composed, NULL otherwise.  The string is owned by @backdrop.
+ **/
+const gchar *
+xfce_backdrop_get_prefetched_filename(XfceBackdrop *backdrop)
+{
+    g_return_val_if_fail(XFCE_IS_BACKDROP(backdrop), NULL);
+
+    if(!backdrop->priv->prefetch_pix)
+        return NULL;
+
+    return backdrop->priv->next_image_path;
+}
+
+/* Styles whose composition scales the image to the backdrop size, and so
+ * can be previewed at a smaller size */
+static gboolean
+xfce_backdrop_can_preview(XfceBackdrop *backdrop)
+{
+    switch(backdrop->priv->image_style) {
+        case XFCE_BACKDROP_IMAGE_STRETCHED:
+        case XFCE_BACKDROP_IMAGE_SCALED:
+        case XFCE_BACKDROP_IMAGE_ZOOMED:
+            return TRUE;
+
+        default:
+            return FALSE;
+    }
+}
+
+/* Composes the backdrop at a fraction of its size and scales it up, from
+ * the image decoded for the previous preview if it is the same one.  The
+ * decoded size depends on the image style and the backdrop size (stretched
+ * images are decoded to the backdrop's aspect ratio), so these have to
+ * match as well */
+static void
+xfce_backdrop_generate_preview(XfceBackdrop *backdrop)
+{
+    XfceBackdropPriv *priv = backdrop->priv;
+    XfceBackdropImageData *image_data;
+
+    image_data = xfce_backdrop_image_data_new(backdrop, priv->image_path);
+    image_data->preview = TRUE;
+    image_data->full_width = image_data->width;
+    image_data->full_height = image_data->height;
+    image_data->width = MAX(image_data->width / XFCE_BACKDROP_PREVIEW_SCALE, 1);
+    image_data->height = MAX(image_data->height / XFCE_BACKDROP_PREVIEW_SCALE, 1);
+
+    if(priv->preview_source
+       && g_strcmp0(priv->preview_source_path, image_data->image_path) == 0
+       && priv->preview_source_style == image_data->image_style
+       && priv->preview_source_width == image_data->width
+       && priv->preview_source_height == image_data->height)
+    {
+        image_data->source = g_object_ref(priv->preview_source);
+    }
+
+    XF_DEBUG("previewing %s", image_data->image_path);
+
+    image_data->waiters = g_list_prepend(NULL, g_object_ref(backdrop));
+    priv->image_data = image_data;
+
+    xfce_backdrop_image_data_start(image_data);
+}
+
+/* shows a finished preview and keeps its decoded image for the next one */
+static void
+xfce_backdrop_take_preview(XfceBackdrop *backdrop,
+                           XfceBackdropImageData *image_data)
+{
+    XfceBackdropPriv *priv = backdrop->priv;
+
+    xfce_backdrop_clear_cached_image(backdrop);
+    priv->pix = g_object_ref(image_data->pix);
+    priv->pix_is_preview = TRUE;
+
+    if(image_data->source && image_data->source != priv->preview_source) {
+        if(priv->preview_source)
+            g_object_unref(priv->preview_source);
+        priv->preview_source = g_object_ref(image_data->source);
+        g_free(priv->preview_source_path);
+        priv->preview_source_path = g_strdup(image_data->image_path);
+        priv->preview_source_style = image_data->image_style;
+        priv->preview_source_width = image_data->width;
+        priv->preview_source_height = image_data->height;
+    }
+}
+
+/**
+ * xfce_backdrop_generate_async:
+ * @backdrop: An #XfceBackdrop.
+ *
+ * Generates the final composited, resized image from the #XfceBackdrop.
+ * Decoding and compositing happen in a worker thread; the "ready" signal is
+ * emitted in the main loop once the image has been created.  A previous
+ * generation that hasn't finished yet is canceled.  Backdrops with identical
+ * settings share a single generation and the resulting pixbuf.  While the
+ * settings keep changing, only a low resolution preview is generated and
+ * the full render follows once they have settled.
+ **/
+void
+xfce_backdrop_generate_async(XfceBackdrop *backdrop)
+{
+    XfceBackdropImageData *image_data = NULL, *pending;
+    XfceBackdropSharedPix *shared;
+
+    TRACE("entering");
+
+    if(backdrop->priv->width == 0 || backdrop->priv->height == 0) {
+        g_critical("attempting to create a backdrop without setting the width/height");
+        return;
+    }
+
+    xfce_backdrop_detach_image_data(backdrop);
+
+    /* In case we somehow end up here, give a warning and apply a temp fix */
+    if(backdrop->priv->color_style == XFCE_BACKDROP_COLOR_INVALID) {
+        g_warning("xfce_backdrop_generate_async: Invalid color style");
+        backdrop->priv->color_style = XFCE_BACKDROP_COLOR_SOLID;
+    }
+
+    if(backdrop->priv->image_style == XFCE_BACKDROP_IMAGE_INVALID) {
+        g_warning("Invalid image style, setting to XFCE_BACKDROP_IMAGE_ZOOMED");
+        backdrop->priv->image_style = XFCE_BACKDROP_IMAGE_ZOOMED;
+    }
+
+    image_data = xfce_backdrop_image_data_new(backdrop, backdrop->priv->image_path);
+
+    /* the next image of the cycle, composed ahead of time */
+    if(backdrop->priv->prefetch_pix
+       && g_strcmp0(backdrop->priv->prefetch_key, image_data->key) == 0)
+    {
+        XF_DEBUG("using prefetched %s", image_data->image_path);
+        xfce_backdrop_take_shared_pix(backdrop, image_data->key,
+                                      backdrop->priv->prefetch_pix);
+        xfce_backdrop_image_data_release(image_data);
+
+        g_signal_emit(G_OBJECT(backdrop), backdrop_signals[BACKDROP_READY], 0);
+        xfce_backdrop_prefetch_next(backdrop);
+        return;
+    }
+
+    /* another backdrop already displays exactly this */
+    if(xfce_backdrop_shared_pixbufs
+       && (shared = g_hash_table_lookup(xfce_backdrop_shared_pixbufs, image_data->key)))
+    {
+        xfce_backdrop_take_shared_pix(backdrop, image_data->key, shared->pix);
+        xfce_backdrop_image_data_release(image_data);
+
+        g_signal_emit(G_OBJECT(backdrop), backdrop_signals[BACKDROP_READY], 0);
+        xfce_backdrop_prefetch_next(backdrop);
+        return;
+    }
+
+    /* In the middle of a burst of changes, e.g. a color being dragged in
+     * the settings dialog: preview now, render properly once it's over */
+    if(backdrop->priv->changing && xfce_backdrop_can_preview(backdrop)) {
+        xfce_backdrop_image_data_release(image_data);
+
+        if(backdrop->priv->settle_timer != 0)
+            g_source_remove(backdrop->priv->settle_timer);
+        backdrop->priv->settle_timer = g_timeout_add(XFCE_BACKDROP_SETTLE_DELAY,
+                                                     xfce_backdrop_settle_timeout,
+                                                     backdrop);
+
+        xfce_backdrop_generate_preview(backdrop);
+        return;
+    }
+
+    /* or is generating it right now */
+    if(G_UNLIKELY(!xfce_backdrop_pending))
+        xfce_backdrop_pending = g_hash_table_new(g_str_hash, g_str_equal);
+
+    pending = g_hash_table_lookup(xfce_backdrop_pending, image_data->key);
+    if(pending) {
+        XF_DEBUG("joining pending generation of %s", image_data->key);
+        pending->waiters = g_list_prepend(pending->waiters, g_object_ref(backdrop));
+        backdrop->priv->image_data = pending;
+        xfce_backdrop_image_data_release(image_data);
+        return;
+    }
 
-    g_signal_connect(image_data->loader, "size-prepared", G_CALLBACK(xfce_backdrop_loader_size_prepared_cb), image_data);
-    g_signal_connect(image_data->loader, "closed", G_CALLBACK(xfce_backdrop_loader_closed_cb), image_data);
+    if(image_data->image_path)
+        XF_DEBUG("loading image %s", image_data->image_path);
 
-    g_file_read_async(file,
-                      G_PRIORITY_DEFAULT,
-                      image_data->cancellable,
-                      xfce_backdrop_file_ready_cb,
-                      image_data);
+    image_data->waiters = g_list_prepend(NULL, g_object_ref(backdrop));
+    backdrop->priv->image_data = image_data;
+
+    xfce_backdrop_image_data_start(image_data);
 }
 
 
@@ -1536,17 +2444,11 @@ xfce_backdrop_loader_size_prepared_cb(GdkPixbufLoader *loader,
                                       gpointer user_data)
 {
     XfceBackdropImageData *image_data = user_data;
-    XfceBackdrop *backdrop = image_data->backdrop;
     gdouble xscale, yscale;
 
     TRACE("entering");
 
-    if(backdrop->priv->image_style == XFCE_BACKDROP_IMAGE_INVALID) {
-        g_warning("Invalid image style, setting to XFCE_BACKDROP_IMAGE_ZOOMED");
-        backdrop->priv->image_style = XFCE_BACKDROP_IMAGE_ZOOMED;
-    }
-
-    switch(backdrop->priv->image_style) {
+    switch(image_data->image_style) {
         case XFCE_BACKDROP_IMAGE_CENTERED:
         case XFCE_BACKDROP_IMAGE_TILED:
             /* do nothing */
@@ -1554,13 +2456,13 @@ xfce_backdrop_loader_size_prepared_cb(GdkPixbufLoader *loader,
 
         case XFCE_BACKDROP_IMAGE_STRETCHED:
             gdk_pixbuf_loader_set_size(loader,
-                                       backdrop->priv->width,
-                                       backdrop->priv->height);
+                                       image_data->width,
+                                       image_data->height);
             break;
 
         case XFCE_BACKDROP_IMAGE_SCALED:
-            xscale = (gdouble)backdrop->priv->width / width;
-            yscale = (gdouble)backdrop->priv->height / height;
+            xscale = (gdouble)image_data->width / width;
+            yscale = (gdouble)image_data->height / height;
             if(xscale < yscale) {
                 yscale = xscale;
             } else {
@@ -1574,141 +2476,164 @@ xfce_backdrop_loader_size_prepared_cb(GdkPixbufLoader *loader,
 
         case XFCE_BACKDROP_IMAGE_ZOOMED:
         case XFCE_BACKDROP_IMAGE_SPANNING_SCREENS:
-            xscale = (gdouble)backdrop->priv->width / width;
-            yscale = (gdouble)backdrop->priv->height / height;
+            xscale = (gdouble)image_data->width / width;
+            yscale = (gdouble)image_data->height / height;
             if(xscale < yscale) {
                 xscale = yscale;
             } else {
                 yscale = xscale;
             }
 
+            /* spanning images are scaled up a monitor at a time when they
+             * are drawn, see xfce_backdrop_render_area() */
+            if(image_data->image_style == XFCE_BACKDROP_IMAGE_SPANNING_SCREENS
+               && xscale >= 1.0)
+            {
+                break;
+            }
+
             gdk_pixbuf_loader_set_size(loader,
                                        width * xscale,
                                        height * yscale);
             break;
 
         default:
-            g_critical("Invalid image style: %d\n", (gint)backdrop->priv->image_style);
+            g_critical("Invalid image style: %d\n", (gint)image_data->image_style);
     }
 }
 
-static void
-xfce_backdrop_loader_closed_cb(GdkPixbufLoader *loader,
-                               XfceBackdropImageData *image_data)
+/* Runs in a worker thread: reads and decodes the image, already scaled
+ * down by the loader according to the image style */
+static GdkPixbuf *
+xfce_backdrop_load_image(XfceBackdropImageData *image_data,
+                         GCancellable *cancellable)
 {
-    XfceBackdrop *backdrop = image_data->backdrop;
-    GdkPixbuf *final_image, *image, *tmp;
-    gint i, j;
+    GFile *file;
+    GFileInputStream *input_stream;
+    GdkPixbufLoader *loader;
+    GdkPixbuf *image = NULL;
+    guchar *image_buffer;
+    gssize bytes;
+    gboolean loader_closed = FALSE;
+
+    file = g_file_new_for_path(image_data->image_path);
+    input_stream = g_file_read(file, cancellable, NULL);
+    g_object_unref(file);
+
+    /* If this fails we will only display the selected backdrop color */
+    if(input_stream == NULL)
+        return NULL;
+
+    g_atomic_int_inc(&xfce_backdrop_n_decodes);
+
+    loader = gdk_pixbuf_loader_new();
+    g_signal_connect(loader, "size-prepared",
+                     G_CALLBACK(xfce_backdrop_loader_size_prepared_cb),
+                     image_data);
+
+    image_buffer = g_new(guchar, XFCE_BACKDROP_BUFFER_SIZE);
+
+    while((bytes = g_input_stream_read(G_INPUT_STREAM(input_stream),
+                                       image_buffer,
+                                       XFCE_BACKDROP_BUFFER_SIZE,
+                                       cancellable, NULL)) > 0)
+    {
+        if(!gdk_pixbuf_loader_write(loader, image_buffer, bytes, NULL)) {
+            /* the loader closes itself when it fails */
+            loader_closed = TRUE;
+            break;
+        }
+    }
+
+    g_free(image_buffer);
+
+    g_input_stream_close(G_INPUT_STREAM(input_stream), NULL, NULL);
+    g_object_unref(input_stream);
+
+    if(!loader_closed)
+        gdk_pixbuf_loader_close(loader, NULL);
+
+    if(!g_cancellable_is_cancelled(cancellable)) {
+        image = gdk_pixbuf_loader_get_pixbuf(loader);
+        if(image)
+            g_object_ref(image);
+    }
+
+    g_object_unref(loader);
+
+    return image;
+}
+
+/* Runs in a worker thread: draws image on top of a new canvas according to
+ * the image style */
+static GdkPixbuf *
+xfce_backdrop_compose(XfceBackdropImageData *image_data,
+                      GdkPixbuf *image)
+{
+    GdkPixbuf *final_image;
     gint w, h, iw = 0, ih = 0;
     XfceBackdropImageStyle istyle;
     gint dx, dy, xo, yo;
     gdouble xscale, yscale;
     GdkInterpType interp;
 
-    TRACE("entering");
+    /* no image? return just the canvas */
+    if(!image)
+        return xfce_backdrop_generate_canvas(image_data);
 
-    g_return_if_fail(XFCE_IS_BACKDROP(backdrop));
+    iw = gdk_pixbuf_get_width(image);
+    ih = gdk_pixbuf_get_height(image);
 
-    /* canceled? quit now */
-    if(g_cancellable_is_cancelled(image_data->cancellable)) {
-        xfce_backdrop_image_data_release(image_data);
-        g_free(image_data);
-        return;
-    }
+    w = image_data->width;
+    h = image_data->height;
 
-    image = gdk_pixbuf_loader_get_pixbuf(loader);
-    if(image) {
-        iw = gdk_pixbuf_get_width(image);
-        ih = gdk_pixbuf_get_height(image);
-    }
+    istyle = image_data->image_style;
+
+    /* a screen-sized canvas spanning all monitors is too big, only the
+     * image is kept and xfce_backdrop_render_area() draws a monitor-sized
+     * part of the backdrop from it when needed */
+    if(XFCE_BACKDROP_IMAGE_SPANNING_SCREENS == istyle)
+        return g_object_ref(G_OBJECT(image));
 
-    if(backdrop->priv->width == 0 || backdrop->priv->height == 0) {
-        w = iw;
-        h = ih;
-    } else {
-        w = backdrop->priv->width;
-        h = backdrop->priv->height;
-    }
-    
-    istyle = backdrop->priv->image_style;
-    
     /* if the image is the same as the screen size, there's no reason to do
      * any scaling at all */
     if(w == iw && h == ih)
         istyle = XFCE_BACKDROP_IMAGE_CENTERED;
+
+    /* only the tile is kept, it gets repeated over the canvas pattern when
+     * painted, see xfce_backdrop_create_canvas_pattern() */
+    if(XFCE_BACKDROP_IMAGE_TILED == istyle)
+        return g_object_ref(G_OBJECT(image));
+
+    final_image = xfce_backdrop_generate_canvas(image_data);
     
     /* if we don't need to do any scaling, don't do any interpolation.  this
      * fixes a problem where hyper/bilinear filtering causes blurriness in
      * some images.  http://bugzilla.xfce.org/show_bug.cgi?id=2939 */
-    if(XFCE_BACKDROP_IMAGE_TILED == istyle
-       || XFCE_BACKDROP_IMAGE_CENTERED == istyle)
-    {
+    if(XFCE_BACKDROP_IMAGE_CENTERED == istyle) {
         interp = GDK_INTERP_NEAREST;
     } else {
         /* if the screen has a bit depth of less than 24bpp, using bilinear
          * filtering looks crappy (mainly with gradients). */
-        if(backdrop->priv->bpp < 24)
+        if(image_data->bpp < 24)
             interp = GDK_INTERP_HYPER;
         else
             interp = GDK_INTERP_BILINEAR;
     }
 
-    final_image = xfce_backdrop_generate_canvas(backdrop);
-
-    /* no image and not canceled? return just the canvas */
-    if(!image && !g_cancellable_is_cancelled(image_data->cancellable)) {
-        XF_DEBUG("image failed to load, displaying canvas only");
-        backdrop->priv->pix = final_image;
-
-        g_signal_emit(G_OBJECT(backdrop), backdrop_signals[BACKDROP_READY], 0);
-
-        backdrop->priv->image_data = NULL;
-        xfce_backdrop_image_data_release(image_data);
-        g_free(image_data);
-        return;
-    }
-
     switch(istyle) {
         case XFCE_BACKDROP_IMAGE_CENTERED:
             dx = MAX((w - iw) / 2, 0);
             dy = MAX((h - ih) / 2, 0);
             xo = MIN((w - iw) / 2, dx);
             yo = MIN((h - ih) / 2, dy);
-            gdk_pixbuf_composite(image, final_image, dx, dy,
+            xfce_backdrop_composite(image, final_image, dx, dy,
                     MIN(w, iw), MIN(h, ih), xo, yo, 1.0, 1.0,
                     interp, 255);
             break;
         
-        case XFCE_BACKDROP_IMAGE_TILED:
-            tmp = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, w, h);
-            /* Now that the image has been loaded, recalculate the image
-             * size because gdk_pixbuf_get_file_info doesn't always return
-             * the correct size */
-            iw = gdk_pixbuf_get_width(image);
-            ih = gdk_pixbuf_get_height(image);
-
-            for(i = 0; (i * iw) < w; i++) {
-                for(j = 0; (j * ih) < h; j++) {
-                    gint newx = iw * i, newy = ih * j;
-                    gint neww = iw, newh = ih;
-                    
-                    if((newx + neww) > w)
-                        neww = w - newx;
-                    if((newy + newh) > h)
-                        newh = h - newy;
-
-                    gdk_pixbuf_copy_area(image, 0, 0,
-                            neww, newh, tmp, newx, newy);
-                }
-            }
-            
-            gdk_pixbuf_composite(tmp, final_image, 0, 0, w, h,
-                    0, 0, 1.0, 1.0, interp, 255);
-            g_object_unref(G_OBJECT(tmp));
-            break;
-        
         case XFCE_BACKDROP_IMAGE_STRETCHED:
-            gdk_pixbuf_composite(image, final_image, 0, 0, w, h,
+            xfce_backdrop_composite(image, final_image, 0, 0, w, h,
                     0, 0, 1, 1, interp, 255);
             break;
         
@@ -1727,7 +2652,7 @@ xfce_backdrop_loader_closed_cb(GdkPixbufLoader *loader,
             dx = xo;
             dy = yo;
 
-            gdk_pixbuf_composite(image, final_image, dx, dy,
+            xfce_backdrop_composite(image, final_image, dx, dy,
                     iw * xscale, ih * yscale, xo, yo, 1, 1,
                     interp, 255);
             break;
@@ -1746,7 +2671,7 @@ xfce_backdrop_loader_closed_cb(GdkPixbufLoader *loader,
                 yo = (h - (ih * yscale)) * 0.5;
             }
 
-            gdk_pixbuf_composite(image, final_image, 0, 0,
+            xfce_backdrop_composite(image, final_image, 0, 0,
                     w, h, xo, yo, 1, 1, interp, 255);
             break;
         
@@ -1754,78 +2679,129 @@ xfce_backdrop_loader_closed_cb(GdkPixbufLoader *loader,
             g_critical("Invalid image style: %d\n", (gint)istyle);
     }
 
-    /* keep the backdrop and emit the signal if it hasn't been canceled */
-    if(!g_cancellable_is_cancelled(image_data->cancellable)) {
-        backdrop->priv->pix = final_image;
-        g_signal_emit(G_OBJECT(backdrop), backdrop_signals[BACKDROP_READY], 0);
-    }
-
-    backdrop->priv->image_data = NULL;
-    xfce_backdrop_image_data_release(image_data);
-    g_free(image_data);
+    return final_image;
 }
 
 static void
-xfce_backdrop_file_ready_cb(GObject *source_object,
-                            GAsyncResult *res,
-                            gpointer user_data)
+xfce_backdrop_generate_thread(GSimpleAsyncResult *result,
+                              GObject *object,
+                              GCancellable *cancellable)
 {
-    GFile *file = G_FILE(source_object);
-    XfceBackdropImageData *image_data = user_data;
-    GFileInputStream *input_stream = g_file_read_finish(file, res, NULL);
+    XfceBackdropImageData *image_data;
+    GdkPixbuf *image = NULL;
 
-    TRACE("entering");
+    image_data = g_simple_async_result_get_op_res_gpointer(result);
 
-    /* Finished with the file, clean it up */
-    g_object_unref(file);
+    if(g_cancellable_is_cancelled(cancellable))
+        return;
+
+    if(image_data->preview) {
+        GdkPixbuf *small;
+
+        if(!image_data->source && image_data->image_path)
+            image_data->source = xfce_backdrop_load_image(image_data, cancellable);
 
-    /* If this fails then close the loader, it will only display the selected
-     * backdrop color */
-    if(input_stream == NULL) {
-        gdk_pixbuf_loader_close(image_data->loader, NULL);
+        if(g_cancellable_is_cancelled(cancellable))
+            return;
+
+        small = xfce_backdrop_compose(image_data, image_data->source);
+        image_data->pix = gdk_pixbuf_scale_simple(small,
+                                                  image_data->full_width,
+                                                  image_data->full_height,
+                                                  GDK_INTERP_BILINEAR);
+        g_object_unref(small);
         return;
     }
 
-    g_input_stream_read_async(G_INPUT_STREAM(input_stream),
-                              image_data->image_buffer,
-                              XFCE_BACKDROP_BUFFER_SIZE,
-                              G_PRIORITY_LOW,
-                              image_data->cancellable,
-                              xfce_backdrop_file_input_stream_ready_cb,
-                              image_data);
+    if(image_data->image_path) {
+        /* composed before with the same inputs? */
+        image_data->pix = xfce_backdrop_cache_lookup(image_data->key);
+        if(image_data->pix)
+            return;
+
+        image = xfce_backdrop_load_image(image_data, cancellable);
+
+        /* canceled? quit now */
+        if(g_cancellable_is_cancelled(cancellable)) {
+            if(image)
+                g_object_unref(image);
+            return;
+        }
+
+        if(!image)
+            XF_DEBUG("image failed to load, displaying canvas only");
+    }
+
+    image_data->pix = xfce_backdrop_compose(image_data, image);
+
+    /* don't remember a failed load, the image may show up later */
+    if(image && !g_cancellable_is_cancelled(cancellable))
+        xfce_backdrop_cache_store(image_data->key, image_data->pix);
+
+    if(image)
+        g_object_unref(image);
 }
 
 static void
-xfce_backdrop_file_input_stream_ready_cb(GObject *source_object,
-                                         GAsyncResult *res,
-                                         gpointer user_data)
+xfce_backdrop_generate_ready_cb(GObject *source_object,
+                                GAsyncResult *res,
+                                gpointer user_data)
 {
-    GInputStream *stream = G_INPUT_STREAM(source_object);
-    XfceBackdropImageData *image_data = user_data;
-    gssize bytes = g_input_stream_read_finish(stream, res, NULL);
+    XfceBackdropImageData *image_data;
+    GList *waiters, *l;
+    gboolean succeeded;
+
+    TRACE("entering");
 
-    if(bytes == -1 || bytes == 0) {
-        /* If there was an error reading the stream or it completed, clean
-         * up and close the pixbuf loader (which will handle both conditions) */
-        g_input_stream_close(stream, image_data->cancellable, NULL);
-        g_object_unref(source_object);
+    image_data = g_simple_async_result_get_op_res_gpointer(G_SIMPLE_ASYNC_RESULT(res));
 
-        gdk_pixbuf_loader_close(image_data->loader, NULL);
-        return;
+    if(xfce_backdrop_pending
+       && g_hash_table_lookup(xfce_backdrop_pending, image_data->key) == image_data)
+    {
+        g_hash_table_remove(xfce_backdrop_pending, image_data->key);
     }
 
-    if(gdk_pixbuf_loader_write(image_data->loader, image_data->image_buffer, bytes, NULL)) {
-        g_input_stream_read_async(stream,
-                                  image_data->image_buffer,
-                                  XFCE_BACKDROP_BUFFER_SIZE,
-                                  G_PRIORITY_LOW,
-                                  image_data->cancellable,
-                                  xfce_backdrop_file_input_stream_ready_cb,
-                                  image_data);
-    } else {
-        /* If we got here, the loader will be closed, and will not accept
-         * further writes. */
-        g_input_stream_close(stream, image_data->cancellable, NULL);
-        g_object_unref(source_object);
+    /* a ready handler may start a new generation for any of the waiters,
+     * so detach all of them before emitting anything */
+    waiters = image_data->waiters;
+    image_data->waiters = NULL;
+    for(l = waiters; l; l = l->next)
+        XFCE_BACKDROP(l->data)->priv->image_data = NULL;
+
+    succeeded = (image_data->pix != NULL
+                 && !g_cancellable_is_cancelled(image_data->cancellable));
+
+    /* keep the next cycle image around, unless it was canceled meanwhile */
+    if(image_data->prefetcher
+       && image_data->prefetcher->priv->prefetch_data == image_data)
+    {
+        XfceBackdropPriv *priv = image_data->prefetcher->priv;
+
+        priv->prefetch_data = NULL;
+        if(succeeded) {
+            priv->prefetch_pix = g_object_ref(image_data->pix);
+            priv->prefetch_key = g_strdup(image_data->key);
+        }
     }
+
+    for(l = waiters; l; l = l->next) {
+        XfceBackdrop *backdrop = l->data;
+
+        /* keep the backdrop and emit the signal, unless it has moved on to
+         * a newer generation meanwhile */
+        if(succeeded && !backdrop->priv->image_data) {
+            if(image_data->preview) {
+                xfce_backdrop_take_preview(backdrop, image_data);
+                g_signal_emit(G_OBJECT(backdrop), backdrop_signals[BACKDROP_READY], 0);
+            } else {
+                xfce_backdrop_take_shared_pix(backdrop, image_data->key, image_data->pix);
+                g_signal_emit(G_OBJECT(backdrop), backdrop_signals[BACKDROP_READY], 0);
+                xfce_backdrop_prefetch_next(backdrop);
+            }
+        }
+
+        g_object_unref(backdrop);
+    }
+
+    g_list_free(waiters);
 }
@@ -145,13 +145,35 @@ gboolean xfce_backdrop_get_random_order  (XfceBackdrop *backdrop);
 
 void xfce_backdrop_force_cycle           (XfceBackdrop *backdrop);
 
+void xfce_backdrop_note_change           (XfceBackdrop *backdrop);
+
 
 GdkPixbuf *xfce_backdrop_get_pixbuf      (XfceBackdrop *backdrop);
+GdkPixbuf *xfce_backdrop_render_area     (XfceBackdrop *backdrop,
+                                          const GdkRectangle *area);
+
+cairo_pattern_t *xfce_backdrop_create_canvas_pattern
+                                         (XfceBackdrop *backdrop);
+cairo_pattern_t *xfce_backdrop_create_color_pattern
+                                         (XfceBackdrop *backdrop);
 
 void xfce_backdrop_generate_async        (XfceBackdrop *backdrop);
 
+gboolean xfce_backdrop_is_generating     (XfceBackdrop *backdrop);
+gboolean xfce_backdrop_is_preview        (XfceBackdrop *backdrop);
+
+gboolean xfce_backdrop_is_prefetching    (XfceBackdrop *backdrop);
+const gchar *xfce_backdrop_get_prefetched_filename
+                                         (XfceBackdrop *backdrop);
+
 void xfce_backdrop_clear_cached_image    (XfceBackdrop *backdrop);
 
+gsize xfce_backdrop_get_shared_bytes     (void);
+guint xfce_backdrop_get_n_decodes        (void);
+
+void xfce_backdrop_set_render_threads    (guint n_threads);
+guint xfce_backdrop_get_render_threads   (void);
+
 G_END_DECLS
 
 #endif
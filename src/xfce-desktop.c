@@ -101,6 +101,38 @@ struct _XfceDesktopPriv
     gint nworkspaces;
     XfceWorkspace **workspaces;
     gint current_workspace;
+    gint64 *workspace_last_used;
+
+    /* snapshot of the backdrop settings under property_prefix */
+    GHashTable *backdrop_settings;
+
+    guint backdrop_memory_budget;
+    guint prerender_idle;
+    guint trim_idle;
+
+    /* fully painted pixmaps of other workspaces, most recently used first,
+     * so switching to them only swaps the window background */
+    GList *workspace_pixmaps;
+
+    /* root window properties waiting for root_properties_idle: monitor
+     * number -> image filename (NULL to delete), and whether _XROOTPMAP_ID
+     * needs to be set again */
+    guint root_properties_idle;
+    GHashTable *pending_imgfiles;
+    gboolean root_pixmap_pending;
+
+    gboolean backdrop_crossfade;
+    gboolean switching_workspace;
+    /* crossfade in progress, from the old to the new backdrop in fade_rect */
+    guint fade_timer;
+    gint fade_frame;
+    GdkPixmap *fade_from, *fade_to;
+    GdkRectangle fade_rect;
+    GdkRegion *fade_clip;
+#ifdef G_ENABLE_DEBUG
+    gint64 switch_time;
+    gint switch_pending_paints;
+#endif
 
     gboolean single_workspace_mode;
     gint single_workspace_num;
@@ -140,6 +172,9 @@ enum
 #endif
     PROP_SINGLE_WORKSPACE_MODE,
     PROP_SINGLE_WORKSPACE_NUMBER,
+    PROP_BACKDROP_RENDER_THREADS,
+    PROP_BACKDROP_MEMORY_BUDGET,
+    PROP_BACKDROP_CROSSFADE,
 };
 
 
@@ -175,6 +210,11 @@ static void xfce_desktop_set_single_workspace_number(XfceDesktop *desktop,
 
 static gboolean xfce_desktop_get_single_workspace_mode(XfceDesktop *desktop);
 static gint xfce_desktop_get_current_workspace(XfceDesktop *desktop);
+static void xfce_desktop_trim_backdrops(XfceDesktop *desktop);
+static void xfce_desktop_queue_trim_backdrops(XfceDesktop *desktop);
+static gsize xfce_desktop_get_backdrop_bytes(XfceDesktop *desktop);
+static void xfce_desktop_queue_prerender(XfceDesktop *desktop);
+static void xfce_desktop_stop_fade(XfceDesktop *desktop);
 
 #ifdef ENABLE_DESKTOP_ICONS
 static void hidden_state_changed_cb(GObject *object, XfceDesktop *desktop);
@@ -327,6 +367,86 @@ set_real_root_window_pixmap(GdkScreen *gscreen,
 #endif
 }
 
+static gboolean
+xfce_desktop_root_properties_idled(gpointer user_data)
+{
+    XfceDesktop *desktop = XFCE_DESKTOP(user_data);
+    GHashTableIter iter;
+    gpointer key, value;
+
+    TRACE("entering");
+
+    desktop->priv->root_properties_idle = 0;
+
+    if(desktop->priv->pending_imgfiles) {
+        g_hash_table_iter_init(&iter, desktop->priv->pending_imgfiles);
+        while(g_hash_table_iter_next(&iter, &key, &value))
+            set_imgfile_root_property(desktop, value, GPOINTER_TO_INT(key));
+        g_hash_table_remove_all(desktop->priv->pending_imgfiles);
+    }
+
+    if(desktop->priv->root_pixmap_pending) {
+        desktop->priv->root_pixmap_pending = FALSE;
+        if(GDK_IS_PIXMAP(desktop->priv->bg_pixmap))
+            set_real_root_window_pixmap(desktop->priv->gscreen,
+                                        desktop->priv->bg_pixmap);
+    }
+
+    return FALSE;
+}
+
+/* Every property change wakes up all the clients watching the root window,
+ * so all the backdrops painted in one main loop iteration share a single
+ * update, made once nothing more urgent is left to do */
+static void
+xfce_desktop_queue_root_properties(XfceDesktop *desktop)
+{
+    if(desktop->priv->root_properties_idle == 0) {
+        desktop->priv->root_properties_idle = g_idle_add(xfce_desktop_root_properties_idled,
+                                                         desktop);
+    }
+}
+
+static void
+xfce_desktop_queue_imgfile_root_property(XfceDesktop *desktop,
+                                         const gchar *filename,
+                                         gint monitor)
+{
+    if(!desktop->priv->pending_imgfiles) {
+        desktop->priv->pending_imgfiles = g_hash_table_new_full(g_direct_hash,
+                                                                g_direct_equal,
+                                                                NULL,
+                                                                g_free);
+    }
+
+    g_hash_table_replace(desktop->priv->pending_imgfiles,
+                         GINT_TO_POINTER(monitor), g_strdup(filename));
+    xfce_desktop_queue_root_properties(desktop);
+}
+
+static void
+xfce_desktop_queue_root_window_pixmap(XfceDesktop *desktop)
+{
+    desktop->priv->root_pixmap_pending = TRUE;
+    xfce_desktop_queue_root_properties(desktop);
+}
+
+static void
+xfce_desktop_cancel_root_properties(XfceDesktop *desktop)
+{
+    if(desktop->priv->root_properties_idle != 0) {
+        g_source_remove(desktop->priv->root_properties_idle);
+        desktop->priv->root_properties_idle = 0;
+    }
+
+    if(desktop->priv->pending_imgfiles) {
+        g_hash_table_destroy(desktop->priv->pending_imgfiles);
+        desktop->priv->pending_imgfiles = NULL;
+    }
+
+    desktop->priv->root_pixmap_pending = FALSE;
+}
+
 static GdkPixmap *
 create_bg_pixmap(GdkScreen *gscreen, gpointer user_data)
 {
@@ -365,6 +485,347 @@ create_bg_pixmap(GdkScreen *gscreen, gpointer user_data)
     return desktop->priv->bg_pixmap;
 }
 
+/* Backdrops are only created, from the current settings, once their
+ * workspace is shown or pre-rendered.  Until then changes to its settings
+ * only update the snapshot. */
+static void
+xfce_desktop_ensure_workspace_backdrops(XfceDesktop *desktop,
+                                        gint workspace)
+{
+    if(xfce_workspace_get_backdrop(desktop->priv->workspaces[workspace], 0) != NULL)
+        return;
+
+    XF_DEBUG("creating backdrops of workspace %d", workspace);
+
+    xfce_workspace_monitors_changed(desktop->priv->workspaces[workspace],
+                                    desktop->priv->gscreen);
+}
+
+/* Area of the screen covered by the backdrop of @monitor on @workspace */
+static void
+xfce_desktop_get_backdrop_geometry(XfceDesktop *desktop,
+                                   gint workspace,
+                                   gint monitor,
+                                   GdkRectangle *rect)
+{
+    GdkScreen *gscreen = desktop->priv->gscreen;
+    gint i;
+
+    if(xfce_desktop_get_n_monitors(desktop) > 1
+       && xfce_workspace_get_xinerama_stretch(desktop->priv->workspaces[workspace])) {
+        /* Spanning screens */
+        GdkRectangle monitor_rect;
+
+        gdk_screen_get_monitor_geometry(gscreen, 0, rect);
+        /* Get the lowest x and y value for all the monitors in
+         * case none of them start at 0,0 for whatever reason.
+         */
+        for(i = 1; i < xfce_desktop_get_n_monitors(desktop); i++) {
+            gdk_screen_get_monitor_geometry(gscreen, i, &monitor_rect);
+
+            if(monitor_rect.x < rect->x)
+                rect->x = monitor_rect.x;
+            if(monitor_rect.y < rect->y)
+                rect->y = monitor_rect.y;
+        }
+
+        rect->width = gdk_screen_get_width(gscreen);
+        rect->height = gdk_screen_get_height(gscreen);
+        XF_DEBUG("xinerama_stretch x %d, y %d, width %d, height %d",
+                 rect->x, rect->y, rect->width, rect->height);
+    } else {
+        gdk_screen_get_monitor_geometry(gscreen, monitor, rect);
+        XF_DEBUG("monitor x %d, y %d, width %d, height %d",
+                 rect->x, rect->y, rect->width, rect->height);
+    }
+}
+
+/* Draws an opaque pixbuf into @pmap at @x, @y, limited to @clip_region if
+ * given.  gdk_draw_pixbuf() converts the pixels to the visual's format a
+ * chunk at a time and sends them through MIT-SHM scratch images when the X
+ * server supports it, plain XPutImage otherwise, so unlike cairo the whole
+ * pixbuf is never copied into a premultiplied client side surface. */
+static void
+xfce_desktop_upload_pixbuf(GdkPixmap *pmap,
+                           GdkPixbuf *pix,
+                           gint x,
+                           gint y,
+                           GdkRegion *clip_region)
+{
+    GdkGC *gc;
+
+    gc = gdk_gc_new(GDK_DRAWABLE(pmap));
+    if(clip_region)
+        gdk_gc_set_clip_region(gc, clip_region);
+
+    gdk_draw_pixbuf(GDK_DRAWABLE(pmap), gc, pix, 0, 0, x, y,
+                    gdk_pixbuf_get_width(pix), gdk_pixbuf_get_height(pix),
+                    GDK_RGB_DITHER_NONE, 0, 0);
+
+    g_object_unref(gc);
+}
+
+/* A backdrop change on the visible workspace blends from the old to the new
+ * image over XFCE_DESKTOP_FADE_FRAMES frames.  Both images are copied to
+ * server side pixmaps once, each frame only composites those two. */
+#define XFCE_DESKTOP_FADE_FRAMES   8
+#define XFCE_DESKTOP_FADE_INTERVAL 40
+
+static GdkPixmap *
+xfce_desktop_copy_area(GdkPixmap *pmap,
+                       const GdkRectangle *rect)
+{
+    GdkPixmap *copy;
+    cairo_t *cr;
+
+    copy = gdk_pixmap_new(GDK_DRAWABLE(pmap), rect->width, rect->height, -1);
+
+    cr = gdk_cairo_create(GDK_DRAWABLE(copy));
+    gdk_cairo_set_source_pixmap(cr, pmap, -rect->x, -rect->y);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    return copy;
+}
+
+static void
+xfce_desktop_fade_paint(XfceDesktop *desktop,
+                        gdouble progress)
+{
+    GdkRectangle *rect = &desktop->priv->fade_rect;
+    cairo_t *cr;
+
+    cr = gdk_cairo_create(GDK_DRAWABLE(desktop->priv->bg_pixmap));
+
+    if(desktop->priv->fade_clip) {
+        gdk_cairo_region(cr, desktop->priv->fade_clip);
+        cairo_clip(cr);
+    }
+    cairo_rectangle(cr, rect->x, rect->y, rect->width, rect->height);
+    cairo_clip(cr);
+
+    gdk_cairo_set_source_pixmap(cr, desktop->priv->fade_to, rect->x, rect->y);
+    cairo_paint(cr);
+
+    if(progress < 1.0) {
+        gdk_cairo_set_source_pixmap(cr, desktop->priv->fade_from, rect->x, rect->y);
+        cairo_paint_with_alpha(cr, 1.0 - progress);
+    }
+
+    cairo_destroy(cr);
+
+    gtk_widget_queue_draw_area(GTK_WIDGET(desktop), rect->x, rect->y,
+                               rect->width, rect->height);
+}
+
+/* paints the final frame and releases the fade */
+static void
+xfce_desktop_finish_fade(XfceDesktop *desktop)
+{
+    if(GDK_IS_PIXMAP(desktop->priv->bg_pixmap))
+        xfce_desktop_fade_paint(desktop, 1.0);
+
+    g_object_unref(desktop->priv->fade_from);
+    g_object_unref(desktop->priv->fade_to);
+    desktop->priv->fade_from = desktop->priv->fade_to = NULL;
+
+    if(desktop->priv->fade_clip) {
+        gdk_region_destroy(desktop->priv->fade_clip);
+        desktop->priv->fade_clip = NULL;
+    }
+}
+
+static gboolean
+xfce_desktop_fade_timeout(gpointer user_data)
+{
+    XfceDesktop *desktop = XFCE_DESKTOP(user_data);
+
+    if(++desktop->priv->fade_frame >= XFCE_DESKTOP_FADE_FRAMES) {
+        desktop->priv->fade_timer = 0;
+        xfce_desktop_finish_fade(desktop);
+        return FALSE;
+    }
+
+    xfce_desktop_fade_paint(desktop,
+                            (gdouble)desktop->priv->fade_frame / XFCE_DESKTOP_FADE_FRAMES);
+
+    return TRUE;
+}
+
+/* jumps to the end of a running crossfade */
+static void
+xfce_desktop_stop_fade(XfceDesktop *desktop)
+{
+    if(desktop->priv->fade_timer == 0)
+        return;
+
+    g_source_remove(desktop->priv->fade_timer);
+    desktop->priv->fade_timer = 0;
+
+    xfce_desktop_finish_fade(desktop);
+}
+
+/* Spanning backdrops cover all monitors, so instead of composing them in
+ * one screen-sized piece each monitor's part is rendered and drawn on its
+ * own.  Only one monitor-sized pixbuf exists at a time. */
+static void
+xfce_desktop_paint_spanning(XfceDesktop *desktop,
+                            GdkPixmap *pmap,
+                            XfceBackdrop *backdrop,
+                            const GdkRectangle *rect)
+{
+    gint i;
+
+    for(i = 0; i < xfce_desktop_get_n_monitors(desktop); i++) {
+        GdkRectangle monitor_rect, area;
+        GdkPixbuf *area_pix;
+
+        gdk_screen_get_monitor_geometry(desktop->priv->gscreen, i, &monitor_rect);
+        if(!gdk_rectangle_intersect(&monitor_rect, rect, &monitor_rect))
+            continue;
+
+        area = monitor_rect;
+        area.x -= rect->x;
+        area.y -= rect->y;
+
+        area_pix = xfce_backdrop_render_area(backdrop, &area);
+        if(!area_pix)
+            continue;
+
+        if(gdk_pixbuf_get_has_alpha(area_pix)) {
+            cairo_t *cr = gdk_cairo_create(GDK_DRAWABLE(pmap));
+
+            gdk_cairo_set_source_pixbuf(cr, area_pix, monitor_rect.x, monitor_rect.y);
+            cairo_paint(cr);
+            cairo_destroy(cr);
+        } else {
+            xfce_desktop_upload_pixbuf(pmap, area_pix,
+                                       monitor_rect.x, monitor_rect.y, NULL);
+        }
+
+        g_object_unref(area_pix);
+    }
+}
+
+/* Limits the backdrop of @monitor, covering @rect, to what no previous
+ * monitor covers, so overlapping monitors don't get painted twice.  @rect
+ * is then shrunk to the area left.  Returns NULL if nothing needs to be
+ * cut away. */
+static GdkRegion *
+xfce_desktop_get_backdrop_clip(XfceDesktop *desktop,
+                               gint workspace,
+                               gint monitor,
+                               GdkRectangle *rect)
+{
+    GdkRegion *clip_region;
+    gint i;
+
+    if(monitor == 0
+       || xfce_workspace_get_xinerama_stretch(desktop->priv->workspaces[workspace]))
+    {
+        return NULL;
+    }
+
+    clip_region = gdk_region_rectangle(rect);
+
+    XF_DEBUG("clip_region: x: %d, y: %d, w: %d, h: %d",
+             rect->x, rect->y, rect->width, rect->height);
+
+    /* If we are not monitor 0 on a multi-monitor setup we need to subtract
+     * all the previous monitor regions so we don't draw over them. This
+     * should prevent the overlap and double backdrop drawing bugs.
+     */
+    for(i = 0; i < monitor; i++) {
+        GdkRectangle previous_monitor;
+        GdkRegion *previous_region;
+        gdk_screen_get_monitor_geometry(desktop->priv->gscreen, i, &previous_monitor);
+
+        XF_DEBUG("previous_monitor: x: %d, y: %d, w: %d, h: %d",
+                 previous_monitor.x, previous_monitor.y,
+                 previous_monitor.width, previous_monitor.height);
+
+        previous_region = gdk_region_rectangle(&previous_monitor);
+
+        gdk_region_subtract(clip_region, previous_region);
+
+        gdk_region_destroy(previous_region);
+    }
+
+    /* Update the area to redraw to limit the icons/area painted */
+    gdk_region_get_clipbox(clip_region, rect);
+    XF_DEBUG("area to update: x: %d, y: %d, w: %d, h: %d",
+             rect->x, rect->y, rect->width, rect->height);
+
+    return clip_region;
+}
+
+/* Paints @backdrop into @rect of @pmap, limited to @clip_region if given.
+ * Plain colors and gradients come from @pattern, anything else needs the
+ * composed @pix. */
+static void
+xfce_desktop_paint_backdrop(XfceDesktop *desktop,
+                            GdkPixmap *pmap,
+                            XfceBackdrop *backdrop,
+                            const GdkRectangle *rect,
+                            GdkRegion *clip_region,
+                            cairo_pattern_t *pattern,
+                            GdkPixbuf *pix)
+{
+    gboolean tiled, spanning;
+    cairo_t *cr;
+
+    tiled = (xfce_backdrop_get_image_style(backdrop) == XFCE_BACKDROP_IMAGE_TILED);
+    spanning = (xfce_backdrop_get_image_style(backdrop) == XFCE_BACKDROP_IMAGE_SPANNING_SCREENS);
+
+    cr = gdk_cairo_create(GDK_DRAWABLE(pmap));
+
+    /* clip the area so we don't draw over a previous wallpaper */
+    if(clip_region != NULL) {
+        gdk_cairo_region(cr, clip_region);
+        cairo_clip(cr);
+    }
+
+    if(pattern || tiled || (spanning && gdk_pixbuf_get_has_alpha(pix))) {
+        cairo_pattern_t *canvas = NULL;
+        cairo_matrix_t matrix;
+
+        /* unlike a pixbuf, a pattern has no extents of its own */
+        cairo_rectangle(cr, rect->x, rect->y, rect->width, rect->height);
+        cairo_clip(cr);
+
+        /* for tiles and transparent images, the color or gradient
+         * underneath comes first */
+        if(!pattern)
+            pattern = canvas = xfce_backdrop_create_canvas_pattern(backdrop);
+
+        cairo_matrix_init_translate(&matrix, -rect->x, -rect->y);
+        cairo_pattern_set_matrix(pattern, &matrix);
+        cairo_set_source(cr, pattern);
+        cairo_paint(cr);
+
+        if(canvas)
+            cairo_pattern_destroy(canvas);
+    }
+
+    if(pix && tiled) {
+        gdk_cairo_set_source_pixbuf(cr, pix, rect->x, rect->y);
+        cairo_pattern_set_extend(cairo_get_source(cr), CAIRO_EXTEND_REPEAT);
+        cairo_paint(cr);
+    } else if(pix && !spanning && gdk_pixbuf_get_has_alpha(pix)) {
+        gdk_cairo_set_source_pixbuf(cr, pix, rect->x, rect->y);
+        cairo_paint(cr);
+    }
+
+    cairo_destroy(cr);
+
+    if(pix && spanning)
+        xfce_desktop_paint_spanning(desktop, pmap, backdrop, rect);
+
+    /* composed backdrops are opaque as a rule, skip cairo for those */
+    if(pix && !tiled && !spanning && !gdk_pixbuf_get_has_alpha(pix))
+        xfce_desktop_upload_pixbuf(pmap, pix, rect->x, rect->y, clip_region);
+}
+
 static void
 backdrop_changed_cb(XfceBackdrop *backdrop, gpointer user_data)
 {
@@ -410,78 +871,25 @@ backdrop_changed_cb(XfceBackdrop *backdrop, gpointer user_data)
     g_free(monitor_name);
 #endif
 
-    if(xfce_desktop_get_n_monitors(desktop) > 1
-       && xfce_workspace_get_xinerama_stretch(desktop->priv->workspaces[current_workspace])) {
-        /* Spanning screens */
-        GdkRectangle monitor_rect;
-
-        gdk_screen_get_monitor_geometry(gscreen, 0, &rect);
-        /* Get the lowest x and y value for all the monitors in
-         * case none of them start at 0,0 for whatever reason.
-         */
-        for(i = 1; i < xfce_desktop_get_n_monitors(desktop); i++) {
-            gdk_screen_get_monitor_geometry(gscreen, i, &monitor_rect);
-
-            if(monitor_rect.x < rect.x)
-                rect.x = monitor_rect.x;
-            if(monitor_rect.y < rect.y)
-                rect.y = monitor_rect.y;
-        }
-
-        rect.width = gdk_screen_get_width(gscreen);
-        rect.height = gdk_screen_get_height(gscreen);
-        XF_DEBUG("xinerama_stretch x %d, y %d, width %d, height %d",
-                 rect.x, rect.y, rect.width, rect.height);
-    } else {
-        gdk_screen_get_monitor_geometry(gscreen, monitor, &rect);
-        XF_DEBUG("monitor x %d, y %d, width %d, height %d",
-                 rect.x, rect.y, rect.width, rect.height);
-    }
+    xfce_desktop_get_backdrop_geometry(desktop, current_workspace, monitor, &rect);
 
     xfce_backdrop_set_size(backdrop, rect.width, rect.height);
 
-    if(monitor > 0
-       && !xfce_workspace_get_xinerama_stretch(desktop->priv->workspaces[current_workspace])) {
-        clip_region = gdk_region_rectangle(&rect);
-
-        XF_DEBUG("clip_region: x: %d, y: %d, w: %d, h: %d",
-                 rect.x, rect.y, rect.width, rect.height);
-
-        /* If we are not monitor 0 on a multi-monitor setup we need to subtract
-         * all the previous monitor regions so we don't draw over them. This
-         * should prevent the overlap and double backdrop drawing bugs.
-         */
-        for(i = 0; i < monitor; i++) {
-            GdkRectangle previous_monitor;
-            GdkRegion *previous_region;
-            gdk_screen_get_monitor_geometry(gscreen, i, &previous_monitor);
-
-            XF_DEBUG("previous_monitor: x: %d, y: %d, w: %d, h: %d",
-                     previous_monitor.x, previous_monitor.y,
-                     previous_monitor.width, previous_monitor.height);
-
-            previous_region = gdk_region_rectangle(&previous_monitor);
-
-            gdk_region_subtract(clip_region, previous_region);
-
-            gdk_region_destroy(previous_region);
-        }
-    }
-
-    if(clip_region != NULL) {
-        /* Update the area to redraw to limit the icons/area painted */
-        gdk_region_get_clipbox(clip_region, &rect);
-        XF_DEBUG("area to update: x: %d, y: %d, w: %d, h: %d",
-                 rect.x, rect.y, rect.width, rect.height);
-    }
+    clip_region = xfce_desktop_get_backdrop_clip(desktop, current_workspace,
+                                                 monitor, &rect);
 
     if(rect.width != 0 && rect.height != 0) {
-        /* get the composited backdrop pixmap */
-        GdkPixbuf *pix = xfce_backdrop_get_pixbuf(backdrop);
-        cairo_t *cr;
+        /* plain colors and gradients are drawn directly, anything else needs
+         * the composited backdrop */
+        cairo_pattern_t *pattern = xfce_backdrop_create_color_pattern(backdrop);
+        GdkPixbuf *pix = NULL;
+        GdkPixmap *fade_from = NULL;
+
+        if(!pattern)
+            pix = xfce_backdrop_get_pixbuf(backdrop);
 
         /* create the backdrop if needed */
-        if(!pix) {
+        if(!pattern && !pix) {
             xfce_backdrop_generate_async(backdrop);
 
             if(clip_region != NULL)
@@ -490,12 +898,28 @@ backdrop_changed_cb(XfceBackdrop *backdrop, gpointer user_data)
             return;
         }
 
+        /* a running crossfade is done, whatever happens next */
+        xfce_desktop_stop_fade(desktop);
+
+        /* remember what's there now to blend from it, switching workspaces
+         * stays instant though */
+        if(desktop->priv->backdrop_crossfade
+           && !desktop->priv->switching_workspace
+           && GDK_IS_PIXMAP(pmap)
+           && gtk_widget_get_mapped(GTK_WIDGET(desktop)))
+        {
+            fade_from = xfce_desktop_copy_area(pmap, &rect);
+        }
+
         /* Create the background pixmap if it isn't already */
         if(!GDK_IS_PIXMAP(pmap)) {
             pmap = create_bg_pixmap(gscreen, desktop);
 
             if(!GDK_IS_PIXMAP(pmap)) {
-                g_object_unref(pix);
+                if(pix)
+                    g_object_unref(pix);
+                if(pattern)
+                    cairo_pattern_destroy(pattern);
 
                 if(clip_region != NULL)
                     gdk_region_destroy(clip_region);
@@ -504,35 +928,451 @@ backdrop_changed_cb(XfceBackdrop *backdrop, gpointer user_data)
             }
         }
 
-        cr = gdk_cairo_create(GDK_DRAWABLE(pmap));
-        gdk_cairo_set_source_pixbuf(cr, pix, rect.x, rect.y);
+        xfce_desktop_paint_backdrop(desktop, pmap, backdrop, &rect,
+                                    clip_region, pattern, pix);
+
+        if(fade_from) {
+            desktop->priv->fade_from = fade_from;
+            desktop->priv->fade_to = xfce_desktop_copy_area(pmap, &rect);
+            desktop->priv->fade_rect = rect;
+            desktop->priv->fade_clip = clip_region ? gdk_region_copy(clip_region) : NULL;
+            desktop->priv->fade_frame = 0;
+
+            /* start out from the old image */
+            xfce_desktop_fade_paint(desktop, 0.0);
+
+            desktop->priv->fade_timer = g_timeout_add(XFCE_DESKTOP_FADE_INTERVAL,
+                                                      xfce_desktop_fade_timeout,
+                                                      desktop);
+        }
+
+        /* tell gtk to redraw the repainted area */
+        gtk_widget_queue_draw_area(GTK_WIDGET(desktop), rect.x, rect.y,
+                                   rect.width, rect.height);
+
+        xfce_desktop_queue_imgfile_root_property(desktop,
+                                                 xfce_backdrop_get_image_filename(backdrop),
+                                                 monitor);
+
+        /* do this again so apps watching the root win notice the update */
+        xfce_desktop_queue_root_window_pixmap(desktop);
+
+        if(pix)
+            g_object_unref(G_OBJECT(pix));
+        if(pattern)
+            cairo_pattern_destroy(pattern);
+        gtk_widget_show(GTK_WIDGET(desktop));
+
+#ifdef G_ENABLE_DEBUG
+        if(desktop->priv->switch_time != 0) {
+            XF_DEBUG("monitor %d painted %.1f ms after the workspace switch",
+                     monitor,
+                     (g_get_monotonic_time() - desktop->priv->switch_time) / 1000.0);
+            if(--desktop->priv->switch_pending_paints <= 0)
+                desktop->priv->switch_time = 0;
+        }
+#endif
+    }
+
+    if(clip_region != NULL)
+        gdk_region_destroy(clip_region);
+}
+
+/* Recreates bg_pixmap for the current screen size and fills it with the
+ * backdrops composed for the old size, scaled to their new geometry with
+ * the cheapest filter, to show until they are rendered again.  Each is
+ * scaled the way its image style scales the image, so nothing gets
+ * distorted that won't be in the real render */
+static gboolean
+xfce_desktop_paint_placeholder(XfceDesktop *desktop,
+                               gint workspace)
+{
+    GdkPixmap *pmap;
+    cairo_t *cr;
+    gint i, n_backdrops;
+
+    TRACE("entering");
+
+    pmap = create_bg_pixmap(desktop->priv->gscreen, desktop);
+    if(!GDK_IS_PIXMAP(pmap))
+        return FALSE;
+
+    cr = gdk_cairo_create(GDK_DRAWABLE(pmap));
+
+    /* whatever isn't covered by an old backdrop */
+    cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+    cairo_paint(cr);
+
+    if(xfce_workspace_get_xinerama_stretch(desktop->priv->workspaces[workspace]))
+        n_backdrops = 1;
+    else
+        n_backdrops = xfce_desktop_get_n_monitors(desktop);
+
+    /* backwards, so where monitors overlap the first one ends up on top
+     * just like backdrop_changed_cb() draws it */
+    for(i = n_backdrops - 1; i >= 0; i--) {
+        XfceBackdrop *backdrop;
+        XfceBackdropImageStyle style;
+        GdkRectangle rect;
+        GdkPixbuf *pix;
+        gint iw, ih;
+        gdouble xscale, yscale;
+
+        backdrop = xfce_workspace_get_backdrop(desktop->priv->workspaces[workspace], i);
+        if(!backdrop)
+            continue;
+
+        /* colors and gradients are drawn right away anyway */
+        pix = xfce_backdrop_get_pixbuf(backdrop);
+        if(!pix)
+            continue;
+
+        xfce_desktop_get_backdrop_geometry(desktop, workspace, i, &rect);
+        style = xfce_backdrop_get_image_style(backdrop);
+        iw = gdk_pixbuf_get_width(pix);
+        ih = gdk_pixbuf_get_height(pix);
+
+        cairo_save(cr);
+        cairo_rectangle(cr, rect.x, rect.y, rect.width, rect.height);
+        cairo_clip(cr);
+
+        /* where the image leaves the canvas uncovered at the new size, or
+         * for tiles and spanning images never had it composed in */
+        if(style == XFCE_BACKDROP_IMAGE_TILED
+           || style == XFCE_BACKDROP_IMAGE_CENTERED
+           || style == XFCE_BACKDROP_IMAGE_SCALED
+           || style == XFCE_BACKDROP_IMAGE_SPANNING_SCREENS)
+        {
+            cairo_pattern_t *canvas = xfce_backdrop_create_canvas_pattern(backdrop);
+            cairo_matrix_t matrix;
+
+            cairo_matrix_init_translate(&matrix, -rect.x, -rect.y);
+            cairo_pattern_set_matrix(canvas, &matrix);
+            cairo_set_source(cr, canvas);
+            cairo_paint(cr);
+            cairo_pattern_destroy(canvas);
+        }
+
+        if(style == XFCE_BACKDROP_IMAGE_TILED) {
+            /* a tile doesn't depend on the screen size */
+            gdk_cairo_set_source_pixbuf(cr, pix, rect.x, rect.y);
+            cairo_pattern_set_extend(cairo_get_source(cr), CAIRO_EXTEND_REPEAT);
+        } else {
+            switch(style) {
+                case XFCE_BACKDROP_IMAGE_CENTERED:
+                    xscale = yscale = 1.0;
+                    break;
+
+                case XFCE_BACKDROP_IMAGE_SCALED:
+                    xscale = yscale = MIN((gdouble)rect.width / iw,
+                                          (gdouble)rect.height / ih);
+                    break;
+
+                case XFCE_BACKDROP_IMAGE_ZOOMED:
+                case XFCE_BACKDROP_IMAGE_SPANNING_SCREENS:
+                    /* a spanning backdrop only has the image, zoomed over
+                     * the whole screen like xfce_backdrop_render_area() */
+                    xscale = yscale = MAX((gdouble)rect.width / iw,
+                                          (gdouble)rect.height / ih);
+                    break;
+
+                default:
+                    /* stretched, or just the canvas */
+                    xscale = (gdouble)rect.width / iw;
+                    yscale = (gdouble)rect.height / ih;
+                    break;
+            }
+
+            cairo_translate(cr,
+                            rect.x + (rect.width - iw * xscale) * 0.5,
+                            rect.y + (rect.height - ih * yscale) * 0.5);
+            cairo_scale(cr, xscale, yscale);
+            gdk_cairo_set_source_pixbuf(cr, pix, 0, 0);
+            cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_FAST);
+        }
+
+        cairo_paint(cr);
+        cairo_restore(cr);
+
+        g_object_unref(pix);
+    }
+
+    cairo_destroy(cr);
+
+    xfce_desktop_queue_root_window_pixmap(desktop);
+    gtk_widget_queue_draw(GTK_WIDGET(desktop));
+
+    return TRUE;
+}
+
+/* Number of painted workspace pixmaps kept around: the two neighbours of
+ * the visible workspace and the one visited last */
+#define XFCE_DESKTOP_PIXMAP_CACHE_SIZE 3
+
+typedef struct
+{
+    gint workspace;
+    GdkPixmap *pmap;
+} XfceDesktopWorkspacePixmap;
+
+static void
+xfce_desktop_workspace_pixmap_free(XfceDesktopWorkspacePixmap *workspace_pixmap)
+{
+    g_object_unref(workspace_pixmap->pmap);
+    g_free(workspace_pixmap);
+}
+
+static GList *
+xfce_desktop_find_workspace_pixmap(XfceDesktop *desktop,
+                                   gint workspace)
+{
+    GList *l;
+
+    for(l = desktop->priv->workspace_pixmaps; l; l = l->next) {
+        XfceDesktopWorkspacePixmap *workspace_pixmap = l->data;
+
+        if(workspace_pixmap->workspace == workspace)
+            return l;
+    }
+
+    return NULL;
+}
+
+/* Drops the pixmap painted for @workspace, or all of them if it is -1 */
+static void
+xfce_desktop_forget_workspace_pixmap(XfceDesktop *desktop,
+                                     gint workspace)
+{
+    GList *l, *next;
+
+    for(l = desktop->priv->workspace_pixmaps; l; l = next) {
+        XfceDesktopWorkspacePixmap *workspace_pixmap = l->data;
+
+        next = l->next;
+
+        if(workspace == -1 || workspace_pixmap->workspace == workspace) {
+            xfce_desktop_workspace_pixmap_free(workspace_pixmap);
+            desktop->priv->workspace_pixmaps = g_list_delete_link(desktop->priv->workspace_pixmaps,
+                                                                  l);
+        }
+    }
+}
+
+static void
+xfce_desktop_remember_workspace_pixmap(XfceDesktop *desktop,
+                                       gint workspace,
+                                       GdkPixmap *pmap)
+{
+    XfceDesktopWorkspacePixmap *workspace_pixmap;
+
+    xfce_desktop_forget_workspace_pixmap(desktop, workspace);
+
+    workspace_pixmap = g_new0(XfceDesktopWorkspacePixmap, 1);
+    workspace_pixmap->workspace = workspace;
+    workspace_pixmap->pmap = g_object_ref(pmap);
+    desktop->priv->workspace_pixmaps = g_list_prepend(desktop->priv->workspace_pixmaps,
+                                                      workspace_pixmap);
+
+    while(g_list_length(desktop->priv->workspace_pixmaps) > XFCE_DESKTOP_PIXMAP_CACHE_SIZE) {
+        GList *last = g_list_last(desktop->priv->workspace_pixmaps);
+
+        xfce_desktop_workspace_pixmap_free(last->data);
+        desktop->priv->workspace_pixmaps = g_list_delete_link(desktop->priv->workspace_pixmaps,
+                                                              last);
+    }
+}
+
+/* Hands out the pixmap painted for @workspace, if there is one, and drops
+ * it from the cache */
+static GdkPixmap *
+xfce_desktop_take_workspace_pixmap(XfceDesktop *desktop,
+                                   gint workspace)
+{
+    GList *l = xfce_desktop_find_workspace_pixmap(desktop, workspace);
+    XfceDesktopWorkspacePixmap *workspace_pixmap;
+    GdkPixmap *pmap;
+
+    if(!l)
+        return NULL;
+
+    workspace_pixmap = l->data;
+    pmap = workspace_pixmap->pmap;
+    g_free(workspace_pixmap);
+    desktop->priv->workspace_pixmaps = g_list_delete_link(desktop->priv->workspace_pixmaps,
+                                                          l);
+
+    return pmap;
+}
+
+static gint
+xfce_desktop_get_n_backdrops(XfceDesktop *desktop,
+                             gint workspace)
+{
+    /* When we're spanning screens we only care about the first monitor */
+    if(xfce_workspace_get_xinerama_stretch(desktop->priv->workspaces[workspace]))
+        return 1;
+
+    return xfce_desktop_get_n_monitors(desktop);
+}
+
+/* Whether all the backdrops of @workspace can be painted as they are: a
+ * color or a composed pixbuf, with nothing newer on its way */
+static gboolean
+xfce_desktop_workspace_is_ready(XfceDesktop *desktop,
+                                gint workspace)
+{
+    gint i;
+
+    for(i = 0; i < xfce_desktop_get_n_backdrops(desktop, workspace); i++) {
+        XfceBackdrop *backdrop;
+        cairo_pattern_t *pattern;
+        GdkPixbuf *pix;
+
+        backdrop = xfce_workspace_get_backdrop(desktop->priv->workspaces[workspace], i);
+        if(!backdrop || xfce_backdrop_is_generating(backdrop))
+            return FALSE;
+
+        pattern = xfce_backdrop_create_color_pattern(backdrop);
+        if(pattern) {
+            cairo_pattern_destroy(pattern);
+            continue;
+        }
+
+        pix = xfce_backdrop_get_pixbuf(backdrop);
+        if(!pix)
+            return FALSE;
+        g_object_unref(pix);
+    }
+
+    return TRUE;
+}
+
+/* Paints all the backdrops of @workspace into a new screen-sized pixmap,
+ * or returns NULL if they aren't ready yet */
+static GdkPixmap *
+xfce_desktop_render_workspace_pixmap(XfceDesktop *desktop,
+                                     gint workspace)
+{
+    GdkPixmap *pmap;
+    gint i;
+
+    if(!xfce_desktop_workspace_is_ready(desktop, workspace))
+        return NULL;
+
+    pmap = gdk_pixmap_new(GDK_DRAWABLE(gtk_widget_get_window(GTK_WIDGET(desktop))),
+                          gdk_screen_get_width(desktop->priv->gscreen),
+                          gdk_screen_get_height(desktop->priv->gscreen),
+                          -1);
+    if(!GDK_IS_PIXMAP(pmap))
+        return NULL;
+
+    for(i = 0; i < xfce_desktop_get_n_backdrops(desktop, workspace); i++) {
+        XfceBackdrop *backdrop;
+        GdkRectangle rect;
+        GdkRegion *clip_region;
+        cairo_pattern_t *pattern;
+        GdkPixbuf *pix = NULL;
+
+        backdrop = xfce_workspace_get_backdrop(desktop->priv->workspaces[workspace], i);
+
+        xfce_desktop_get_backdrop_geometry(desktop, workspace, i, &rect);
+        clip_region = xfce_desktop_get_backdrop_clip(desktop, workspace, i, &rect);
+
+        pattern = xfce_backdrop_create_color_pattern(backdrop);
+        if(!pattern)
+            pix = xfce_backdrop_get_pixbuf(backdrop);
+
+        if(rect.width != 0 && rect.height != 0 && (pattern || pix)) {
+            xfce_desktop_paint_backdrop(desktop, pmap, backdrop, &rect,
+                                        clip_region, pattern, pix);
+        }
+
+        if(pix)
+            g_object_unref(pix);
+        if(pattern)
+            cairo_pattern_destroy(pattern);
+        if(clip_region)
+            gdk_region_destroy(clip_region);
+    }
+
+    return pmap;
+}
+
+/* Keeps what is on screen for @workspace, which is about to be replaced,
+ * if it shows its backdrops as they are now.  Taking over @pmap avoids a
+ * copy when it isn't going to be painted on anymore. */
+static void
+xfce_desktop_remember_shown_workspace(XfceDesktop *desktop,
+                                      gint workspace,
+                                      gboolean take_over)
+{
+    GdkPixmap *pmap = desktop->priv->bg_pixmap;
+
+    if(!GDK_IS_PIXMAP(pmap)
+       || workspace < 0 || workspace >= desktop->priv->nworkspaces
+       || !xfce_desktop_workspace_is_ready(desktop, workspace))
+    {
+        return;
+    }
+
+    /* a running crossfade still has to reach the new image */
+    xfce_desktop_stop_fade(desktop);
+
+    if(take_over) {
+        xfce_desktop_remember_workspace_pixmap(desktop, workspace, pmap);
+    } else {
+        GdkRectangle rect = { 0, 0, 0, 0 };
+        GdkPixmap *copy;
+
+        gdk_drawable_get_size(GDK_DRAWABLE(pmap), &rect.width, &rect.height);
+        copy = xfce_desktop_copy_area(pmap, &rect);
+        xfce_desktop_remember_workspace_pixmap(desktop, workspace, copy);
+        g_object_unref(copy);
+    }
+}
+
+/* Switches straight to the pixmap painted ahead of time for @workspace.
+ * Returns FALSE if there is none. */
+static gboolean
+xfce_desktop_show_workspace_pixmap(XfceDesktop *desktop,
+                                   gint old_workspace,
+                                   gint workspace)
+{
+    GdkPixmap *pmap;
+    gint i;
+
+    if(desktop->priv->updates_frozen || !gtk_widget_get_realized(GTK_WIDGET(desktop)))
+        return FALSE;
+
+    pmap = xfce_desktop_take_workspace_pixmap(desktop, workspace);
+    if(!pmap)
+        return FALSE;
 
-        /* clip the area so we don't draw over a previous wallpaper */
-        if(clip_region != NULL) {
-            gdk_cairo_region(cr, clip_region);
-            cairo_clip(cr);
-        }
+    XF_DEBUG("showing the pixmap painted for workspace %d", workspace);
 
-        cairo_paint(cr);
+    xfce_desktop_stop_fade(desktop);
+    xfce_desktop_remember_shown_workspace(desktop, old_workspace, TRUE);
 
-        /* tell gtk to redraw the repainted area */
-        gtk_widget_queue_draw_area(GTK_WIDGET(desktop), rect.x, rect.y,
-                                   rect.width, rect.height);
+    if(desktop->priv->bg_pixmap)
+        g_object_unref(desktop->priv->bg_pixmap);
+    desktop->priv->bg_pixmap = pmap;
 
-        set_imgfile_root_property(desktop,
-                                  xfce_backdrop_get_image_filename(backdrop),
-                                  monitor);
+    gdk_window_set_back_pixmap(gtk_widget_get_window(GTK_WIDGET(desktop)),
+                               pmap, FALSE);
+    gtk_widget_queue_draw(GTK_WIDGET(desktop));
 
-        /* do this again so apps watching the root win notice the update */
-        set_real_root_window_pixmap(gscreen, pmap);
+    for(i = 0; i < xfce_desktop_get_n_backdrops(desktop, workspace); i++) {
+        XfceBackdrop *backdrop;
 
-        g_object_unref(G_OBJECT(pix));
-        cairo_destroy(cr);
-        gtk_widget_show(GTK_WIDGET(desktop));
+        backdrop = xfce_workspace_get_backdrop(desktop->priv->workspaces[workspace], i);
+        xfce_desktop_queue_imgfile_root_property(desktop,
+                                                 xfce_backdrop_get_image_filename(backdrop),
+                                                 i);
     }
 
-    if(clip_region != NULL)
-        gdk_region_destroy(clip_region);
+    xfce_desktop_queue_root_window_pixmap(desktop);
+
+    return TRUE;
 }
 
 static void
@@ -551,8 +1391,19 @@ screen_size_changed_cb(GdkScreen *gscreen, gpointer user_data)
     if(current_workspace < 0)
         return;
 
-    /* release the bg_pixmap since the dimensions may have changed */
-    if(desktop->priv->bg_pixmap) {
+    xfce_desktop_stop_fade(desktop);
+
+    /* painted for the old layout */
+    xfce_desktop_forget_workspace_pixmap(desktop, -1);
+
+    xfce_desktop_ensure_workspace_backdrops(desktop, current_workspace);
+
+    /* the dimensions may have changed, show the old backdrops scaled while
+     * the new ones are rendered in the background; each monitor is then
+     * replaced in one go once its backdrop is ready */
+    if(!xfce_desktop_paint_placeholder(desktop, current_workspace)
+       && desktop->priv->bg_pixmap)
+    {
         g_object_unref(desktop->priv->bg_pixmap);
         desktop->priv->bg_pixmap = NULL;
     }
@@ -580,6 +1431,98 @@ screen_composited_changed_cb(GdkScreen *gscreen,
     screen_size_changed_cb(gscreen, user_data);
 }
 
+static void
+xfce_desktop_free_setting_value(gpointer data)
+{
+    GValue *value = data;
+
+    g_value_unset(value);
+    g_free(value);
+}
+
+static void
+xfce_desktop_load_backdrop_settings(XfceDesktop *desktop)
+{
+    GHashTable *properties;
+    GHashTableIter iter;
+    gpointer key, value;
+    gchar *base;
+
+    TRACE("entering");
+
+    desktop->priv->backdrop_settings = g_hash_table_new_full(g_str_hash,
+                                                             g_str_equal,
+                                                             g_free,
+                                                             xfce_desktop_free_setting_value);
+
+    /* A single round-trip to xfconfd for every backdrop of every workspace
+     * and monitor; xfconf wants the base without the trailing slash */
+    base = g_strdup(desktop->priv->property_prefix);
+    if(g_str_has_suffix(base, "/"))
+        base[strlen(base) - 1] = '\0';
+
+    properties = xfconf_channel_get_properties(desktop->priv->channel, base);
+    g_free(base);
+
+    if(properties == NULL)
+        return;
+
+    g_hash_table_iter_init(&iter, properties);
+    while(g_hash_table_iter_next(&iter, &key, &value)) {
+        GValue *copy = g_new0(GValue, 1);
+
+        g_value_init(copy, G_VALUE_TYPE(value));
+        g_value_copy(value, copy);
+        g_hash_table_insert(desktop->priv->backdrop_settings, g_strdup(key), copy);
+    }
+
+    XF_DEBUG("loaded %u backdrop settings",
+             g_hash_table_size(desktop->priv->backdrop_settings));
+
+    g_hash_table_destroy(properties);
+}
+
+static void
+xfce_desktop_backdrop_setting_changed(XfconfChannel *channel,
+                                      const gchar *property,
+                                      const GValue *value,
+                                      gpointer user_data)
+{
+    XfceDesktop *desktop = XFCE_DESKTOP(user_data);
+    const gchar *p;
+    gchar *end;
+    glong n;
+
+    if(!g_str_has_prefix(property, desktop->priv->property_prefix))
+        return;
+
+    /* keep the snapshot current for backdrops created later on */
+    if(G_IS_VALUE(value)) {
+        GValue *copy = g_new0(GValue, 1);
+
+        g_value_init(copy, G_VALUE_TYPE(value));
+        g_value_copy(value, copy);
+        g_hash_table_replace(desktop->priv->backdrop_settings,
+                             g_strdup(property), copy);
+    } else {
+        g_hash_table_remove(desktop->priv->backdrop_settings, property);
+    }
+
+    /* Per-backdrop settings are .../monitor<name>/workspace<n>/<setting>,
+     * hand them to that workspace */
+    p = strstr(property + strlen(desktop->priv->property_prefix), "/workspace");
+    if(p == NULL)
+        return;
+
+    p += strlen("/workspace");
+    n = strtol(p, &end, 10);
+    if(end == p || *end != '/')
+        return;
+
+    if(desktop->priv->workspaces != NULL && n >= 0 && n < desktop->priv->nworkspaces)
+        xfce_workspace_setting_changed(desktop->priv->workspaces[n], property, value);
+}
+
 static void
 xfce_desktop_monitors_changed(GdkScreen *gscreen,
                               gpointer user_data)
@@ -589,8 +1532,12 @@ xfce_desktop_monitors_changed(GdkScreen *gscreen,
 
     TRACE("entering");
 
-    /* Update the workspaces */
+    /* Update the workspaces that have backdrops, the others pick up the
+     * new layout when they get created */
     for(i = 0; i < desktop->priv->nworkspaces; i++) {
+        if(xfce_workspace_get_backdrop(desktop->priv->workspaces[i], 0) == NULL)
+            continue;
+
         xfce_workspace_monitors_changed(desktop->priv->workspaces[i],
                                         gscreen);
     }
@@ -606,6 +1553,7 @@ workspace_backdrop_changed_cb(XfceWorkspace *workspace,
 {
     XfceDesktop *desktop = XFCE_DESKTOP(user_data);
     gint current_workspace = 0, monitor = 0, i;
+    GdkPixbuf *pix;
 
     TRACE("entering");
 
@@ -613,6 +1561,18 @@ workspace_backdrop_changed_cb(XfceWorkspace *workspace,
 
     current_workspace = xfce_desktop_get_current_workspace(desktop);
 
+    /* anything painted for that workspace is outdated now */
+    xfce_desktop_forget_workspace_pixmap(desktop,
+                                         xfce_workspace_get_workspace_num(workspace));
+
+    /* a freshly composed backdrop, on any workspace, may push us over the
+     * memory budget */
+    pix = xfce_backdrop_get_pixbuf(backdrop);
+    if(pix) {
+        xfce_desktop_queue_trim_backdrops(desktop);
+        g_object_unref(pix);
+    }
+
     /* Find out which monitor the backdrop is on */
     for(i = 0; i < xfce_desktop_get_n_monitors(desktop); i++) {
         if(backdrop == xfce_workspace_get_backdrop(desktop->priv->workspaces[current_workspace], i)) {
@@ -628,6 +1588,9 @@ workspace_backdrop_changed_cb(XfceWorkspace *workspace,
         if(!xfce_workspace_get_xinerama_stretch(workspace) || monitor == 0) {
             backdrop_changed_cb(backdrop, user_data);
         }
+    } else {
+        /* paint it again once it's ready, if it's a likely next one */
+        xfce_desktop_queue_prerender(desktop);
     }
 }
 
@@ -649,19 +1612,44 @@ workspace_changed_cb(WnckScreen *wnck_screen,
         return;
 
     desktop->priv->current_workspace = new_workspace;
+    desktop->priv->workspace_last_used[new_workspace] = g_get_monotonic_time();
 
     XF_DEBUG("current_workspace %d, new_workspace %d",
              current_workspace, new_workspace);
 
-    for(i = 0; i < xfce_desktop_get_n_monitors(desktop); i++) {
+    xfce_desktop_ensure_workspace_backdrops(desktop, new_workspace);
+
+    /* with a pixmap painted ahead of time, that's all there is to do */
+    if(new_workspace != current_workspace
+       && xfce_desktop_show_workspace_pixmap(desktop, current_workspace, new_workspace))
+    {
+        xfce_desktop_trim_backdrops(desktop);
+        xfce_desktop_queue_prerender(desktop);
+        return;
+    }
+
+    /* the backdrops are painted over what's shown now, keep a copy */
+    if(new_workspace != current_workspace)
+        xfce_desktop_remember_shown_workspace(desktop, current_workspace, FALSE);
+
+#ifdef G_ENABLE_DEBUG
+    desktop->priv->switch_time = g_get_monotonic_time();
+    desktop->priv->switch_pending_paints = xfce_desktop_get_n_backdrops(desktop,
+                                                                        new_workspace);
+#endif
+
+    desktop->priv->switching_workspace = TRUE;
+
+    for(i = 0; i < xfce_desktop_get_n_backdrops(desktop, new_workspace); i++) {
         backdrop = xfce_workspace_get_backdrop(desktop->priv->workspaces[new_workspace], i);
         /* update it */
         backdrop_changed_cb(backdrop, user_data);
-
-        /* When we're spanning screens we only care about the first monitor */
-        if(xfce_workspace_get_xinerama_stretch(desktop->priv->workspaces[new_workspace]))
-            break;
     }
+
+    desktop->priv->switching_workspace = FALSE;
+
+    xfce_desktop_trim_backdrops(desktop);
+    xfce_desktop_queue_prerender(desktop);
 }
 
 static void
@@ -681,15 +1669,20 @@ workspace_created_cb(WnckScreen *wnck_screen,
     /* allocate size for it */
     desktop->priv->workspaces = g_realloc(desktop->priv->workspaces,
                                           desktop->priv->nworkspaces * sizeof(XfceWorkspace *));
+    desktop->priv->workspace_last_used = g_realloc(desktop->priv->workspace_last_used,
+                                                   desktop->priv->nworkspaces * sizeof(gint64));
+    desktop->priv->workspace_last_used[nlast_workspace] = 0;
 
     /* create the new workspace and set it up */
     desktop->priv->workspaces[nlast_workspace] = xfce_workspace_new(desktop->priv->gscreen,
                                                                     desktop->priv->channel,
+                                                                    desktop->priv->backdrop_settings,
                                                                     desktop->priv->property_prefix,
                                                                     nlast_workspace);
 
-    xfce_workspace_monitors_changed(desktop->priv->workspaces[nlast_workspace],
-                                    desktop->priv->gscreen);
+    /* other workspaces get their backdrops when they are first shown */
+    if(nlast_workspace == xfce_desktop_get_current_workspace(desktop))
+        xfce_desktop_ensure_workspace_backdrops(desktop, nlast_workspace);
 
     g_signal_connect(desktop->priv->workspaces[nlast_workspace],
                      "workspace-backdrop-changed",
@@ -711,6 +1704,8 @@ workspace_destroyed_cb(WnckScreen *wnck_screen,
 
     nlast_workspace = desktop->priv->nworkspaces - 1;
 
+    xfce_desktop_forget_workspace_pixmap(desktop, nlast_workspace);
+
     g_signal_handlers_disconnect_by_func(desktop->priv->workspaces[nlast_workspace],
                                          G_CALLBACK(workspace_backdrop_changed_cb),
                                          desktop);
@@ -723,6 +1718,8 @@ workspace_destroyed_cb(WnckScreen *wnck_screen,
     /* deallocate it */
     desktop->priv->workspaces = g_realloc(desktop->priv->workspaces,
                                           desktop->priv->nworkspaces * sizeof(XfceWorkspace *));
+    desktop->priv->workspace_last_used = g_realloc(desktop->priv->workspace_last_used,
+                                                   desktop->priv->nworkspaces * sizeof(gint64));
 
     /* Make sure we stay within bounds now that we removed a workspace */
     if(desktop->priv->current_workspace > desktop->priv->nworkspaces)
@@ -889,6 +1886,27 @@ xfce_desktop_class_init(XfceDesktopClass *klass)
                                                      0, G_MAXINT16, 0,
                                                      XFDESKTOP_PARAM_FLAGS));
 
+    g_object_class_install_property(gobject_class, PROP_BACKDROP_RENDER_THREADS,
+                                    g_param_spec_uint("backdrop-render-threads",
+                                                      "backdrop-render-threads",
+                                                      "backdrop-render-threads",
+                                                      0, G_MAXUINT16, 0,
+                                                      XFDESKTOP_PARAM_FLAGS));
+
+    g_object_class_install_property(gobject_class, PROP_BACKDROP_MEMORY_BUDGET,
+                                    g_param_spec_uint("backdrop-memory-budget",
+                                                      "backdrop-memory-budget",
+                                                      "backdrop-memory-budget",
+                                                      0, G_MAXUINT16, 256,
+                                                      XFDESKTOP_PARAM_FLAGS));
+
+    g_object_class_install_property(gobject_class, PROP_BACKDROP_CROSSFADE,
+                                    g_param_spec_boolean("backdrop-crossfade",
+                                                         "backdrop-crossfade",
+                                                         "backdrop-crossfade",
+                                                         FALSE,
+                                                         XFDESKTOP_PARAM_FLAGS));
+
 #undef XFDESKTOP_PARAM_FLAGS
 }
 
@@ -905,6 +1923,8 @@ xfce_desktop_init(XfceDesktop *desktop)
     /* Can focus is needed for the gtk_grab_add/remove commands */
     gtk_widget_set_can_focus(GTK_WIDGET(desktop), TRUE);
     gtk_window_set_resizable(GTK_WINDOW(desktop), FALSE);
+
+    desktop->priv->backdrop_memory_budget = 256;
 }
 
 static void
@@ -915,6 +1935,8 @@ xfce_desktop_finalize(GObject *object)
     g_object_unref(G_OBJECT(desktop->priv->channel));
     g_free(desktop->priv->property_prefix);
 
+    xfce_desktop_forget_workspace_pixmap(desktop, -1);
+
 #ifdef ENABLE_DESKTOP_ICONS
     if(desktop->priv->style_refresh_timer != 0)
         g_source_remove(desktop->priv->style_refresh_timer);
@@ -969,6 +1991,19 @@ xfce_desktop_set_property(GObject *object,
                                                      g_value_get_int(value));
             break;
 
+        case PROP_BACKDROP_RENDER_THREADS:
+            xfce_backdrop_set_render_threads(g_value_get_uint(value));
+            break;
+
+        case PROP_BACKDROP_MEMORY_BUDGET:
+            desktop->priv->backdrop_memory_budget = g_value_get_uint(value);
+            xfce_desktop_trim_backdrops(desktop);
+            break;
+
+        case PROP_BACKDROP_CROSSFADE:
+            desktop->priv->backdrop_crossfade = g_value_get_boolean(value);
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
             break;
@@ -1014,6 +2049,18 @@ xfce_desktop_get_property(GObject *object,
             g_value_set_int(value, desktop->priv->single_workspace_num);
             break;
 
+        case PROP_BACKDROP_RENDER_THREADS:
+            g_value_set_uint(value, xfce_backdrop_get_render_threads());
+            break;
+
+        case PROP_BACKDROP_MEMORY_BUDGET:
+            g_value_set_uint(value, desktop->priv->backdrop_memory_budget);
+            break;
+
+        case PROP_BACKDROP_CROSSFADE:
+            g_value_set_boolean(value, desktop->priv->backdrop_crossfade);
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
             break;
@@ -1081,6 +2128,27 @@ xfce_desktop_realize(GtkWidget *widget)
                            SINGLE_WORKSPACE_NUMBER, G_TYPE_INT,
                            G_OBJECT(desktop), "single-workspace-number");
 
+    /* Threads used to composite large backdrops, 0 is one per processor */
+    xfconf_g_property_bind(desktop->priv->channel,
+                           BACKDROP_RENDER_THREADS, G_TYPE_UINT,
+                           G_OBJECT(desktop), "backdrop-render-threads");
+
+    /* MiB of composed backdrops kept for inactive workspaces, 0 is no limit */
+    xfconf_g_property_bind(desktop->priv->channel,
+                           BACKDROP_MEMORY_BUDGET, G_TYPE_UINT,
+                           G_OBJECT(desktop), "backdrop-memory-budget");
+
+    /* Blend into new backdrops instead of switching at once */
+    xfconf_g_property_bind(desktop->priv->channel,
+                           BACKDROP_CROSSFADE, G_TYPE_BOOLEAN,
+                           G_OBJECT(desktop), "backdrop-crossfade");
+
+    /* Backdrops are set up from one snapshot of their settings and then
+     * follow changes through a single handler */
+    xfce_desktop_load_backdrop_settings(desktop);
+    g_signal_connect(G_OBJECT(desktop->priv->channel), "property-changed",
+                     G_CALLBACK(xfce_desktop_backdrop_setting_changed), desktop);
+
     /* watch for workspace changes */
     g_signal_connect(desktop->priv->wnck_screen, "active-workspace-changed",
                      G_CALLBACK(workspace_changed_cb), desktop);
@@ -1117,6 +2185,22 @@ xfce_desktop_unrealize(GtkWidget *widget)
     /* disconnect all the xfconf settings to this desktop */
     xfconf_g_property_unbind_all(G_OBJECT(desktop));
 
+    if(desktop->priv->prerender_idle != 0) {
+        g_source_remove(desktop->priv->prerender_idle);
+        desktop->priv->prerender_idle = 0;
+    }
+
+    if(desktop->priv->trim_idle != 0) {
+        g_source_remove(desktop->priv->trim_idle);
+        desktop->priv->trim_idle = 0;
+    }
+
+    xfce_desktop_stop_fade(desktop);
+    xfce_desktop_forget_workspace_pixmap(desktop, -1);
+
+    /* the properties get deleted below anyway */
+    xfce_desktop_cancel_root_properties(desktop);
+
     g_signal_handlers_disconnect_by_func(G_OBJECT(desktop->priv->gscreen),
                                          G_CALLBACK(xfce_desktop_monitors_changed),
                                          desktop);
@@ -1155,6 +2239,16 @@ xfce_desktop_unrealize(GtkWidget *widget)
         g_free(desktop->priv->workspaces);
         desktop->priv->workspaces = NULL;
     }
+    g_free(desktop->priv->workspace_last_used);
+    desktop->priv->workspace_last_used = NULL;
+
+    g_signal_handlers_disconnect_by_func(G_OBJECT(desktop->priv->channel),
+                                         G_CALLBACK(xfce_desktop_backdrop_setting_changed),
+                                         desktop);
+    if(desktop->priv->backdrop_settings) {
+        g_hash_table_unref(desktop->priv->backdrop_settings);
+        desktop->priv->backdrop_settings = NULL;
+    }
 
     gdk_flush();
     gdk_error_trap_pop();
@@ -1415,6 +2509,359 @@ xfce_desktop_get_current_workspace(XfceDesktop *desktop)
     return current_workspace;
 }
 
+/* Sums up the composed backdrops currently held by all workspaces. Monitors
+ * and workspaces showing the same image share a single pixbuf, so each one
+ * is only counted once. */
+static gsize
+xfce_desktop_get_backdrop_bytes(XfceDesktop *desktop)
+{
+    GHashTable *seen;
+    gsize bytes = 0;
+    gint i, j;
+
+    seen = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    for(i = 0; i < desktop->priv->nworkspaces; i++) {
+        for(j = 0; j < xfce_desktop_get_n_monitors(desktop); j++) {
+            XfceBackdrop *backdrop;
+            GdkPixbuf *pix;
+
+            backdrop = xfce_workspace_get_backdrop(desktop->priv->workspaces[i], j);
+            if(!backdrop)
+                continue;
+
+            pix = xfce_backdrop_get_pixbuf(backdrop);
+            if(!pix)
+                continue;
+
+            if(!g_hash_table_lookup(seen, pix)) {
+                g_hash_table_insert(seen, pix, pix);
+                bytes += (gsize)gdk_pixbuf_get_rowstride(pix)
+                         * gdk_pixbuf_get_height(pix);
+            }
+
+            g_object_unref(pix);
+        }
+    }
+
+    g_hash_table_destroy(seen);
+
+    return bytes;
+}
+
+/* The visible workspace and its direct neighbours are the likeliest next
+ * targets of a workspace switch, so their backdrops are never evicted. */
+static gboolean
+xfce_desktop_workspace_is_exempt(XfceDesktop *desktop,
+                                 gint workspace)
+{
+    gint current = desktop->priv->current_workspace;
+    gint n = desktop->priv->nworkspaces;
+
+    if(current < 0 || current >= n)
+        return FALSE;
+
+    return workspace == current
+           || workspace == (current + 1) % n
+           || workspace == (current + n - 1) % n;
+}
+
+static gint
+xfce_desktop_compare_last_used(gconstpointer a,
+                               gconstpointer b,
+                               gpointer user_data)
+{
+    gint64 *last_used = user_data;
+    gint64 ta = last_used[GPOINTER_TO_INT(a)];
+    gint64 tb = last_used[GPOINTER_TO_INT(b)];
+
+    return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+/* How much memory one composed pixbuf takes, and who holds it */
+typedef struct
+{
+    gsize bytes;
+    /* workspaces whose backdrops still hold it */
+    gint n_workspaces;
+    /* last workspace counted in or evicted from n_workspaces, so each one
+     * is only counted once */
+    gint last_workspace;
+    gint last_evicted;
+    /* shown on an exempt workspace, so evicting it elsewhere frees nothing */
+    gboolean pinned;
+} XfceDesktopPixUsage;
+
+/* Drops the composed backdrops of the least recently visited workspaces until
+ * the total fits in the configured budget. Evicted backdrops are composed
+ * again (usually straight from the disk cache) when their workspace becomes
+ * visible. */
+static void
+xfce_desktop_trim_backdrops(XfceDesktop *desktop)
+{
+    GHashTable *usage;
+    GList *candidates = NULL, *l;
+    gsize budget, bytes = 0;
+    gint i, j, n_monitors;
+
+    if(!desktop->priv->workspaces || desktop->priv->backdrop_memory_budget == 0)
+        return;
+
+    budget = (gsize)desktop->priv->backdrop_memory_budget * 1024 * 1024;
+    n_monitors = xfce_desktop_get_n_monitors(desktop);
+
+    /* one pass over all backdrops; shared pixbufs are counted once */
+    usage = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                  g_object_unref, g_free);
+
+    for(i = 0; i < desktop->priv->nworkspaces; i++) {
+        gboolean exempt = xfce_desktop_workspace_is_exempt(desktop, i);
+
+        for(j = 0; j < n_monitors; j++) {
+            XfceBackdrop *backdrop;
+            XfceDesktopPixUsage *pix_usage;
+            GdkPixbuf *pix;
+
+            backdrop = xfce_workspace_get_backdrop(desktop->priv->workspaces[i], j);
+            if(!backdrop || !(pix = xfce_backdrop_get_pixbuf(backdrop)))
+                continue;
+
+            pix_usage = g_hash_table_lookup(usage, pix);
+            if(!pix_usage) {
+                pix_usage = g_new0(XfceDesktopPixUsage, 1);
+                pix_usage->bytes = (gsize)gdk_pixbuf_get_rowstride(pix)
+                                   * gdk_pixbuf_get_height(pix);
+                pix_usage->last_workspace = -1;
+                pix_usage->last_evicted = -1;
+                /* the table keeps the reference */
+                g_hash_table_insert(usage, pix, pix_usage);
+                bytes += pix_usage->bytes;
+            } else
+                g_object_unref(pix);
+
+            if(pix_usage->last_workspace != i) {
+                pix_usage->last_workspace = i;
+                pix_usage->n_workspaces++;
+            }
+            if(exempt)
+                pix_usage->pinned = TRUE;
+        }
+
+        if(!exempt)
+            candidates = g_list_prepend(candidates, GINT_TO_POINTER(i));
+    }
+
+    if(bytes <= budget) {
+        g_list_free(candidates);
+        g_hash_table_destroy(usage);
+        return;
+    }
+
+    candidates = g_list_sort_with_data(candidates,
+                                       xfce_desktop_compare_last_used,
+                                       desktop->priv->workspace_last_used);
+
+    for(l = candidates; l && bytes > budget; l = l->next) {
+        gint workspace = GPOINTER_TO_INT(l->data);
+
+        for(j = 0; j < n_monitors; j++) {
+            XfceBackdrop *backdrop;
+            XfceDesktopPixUsage *pix_usage;
+            GdkPixbuf *pix;
+
+            backdrop = xfce_workspace_get_backdrop(desktop->priv->workspaces[workspace], j);
+            if(!backdrop || !(pix = xfce_backdrop_get_pixbuf(backdrop)))
+                continue;
+
+            pix_usage = g_hash_table_lookup(usage, pix);
+            g_object_unref(pix);
+
+            /* still on screen or next to it, keep it */
+            if(!pix_usage || pix_usage->pinned)
+                continue;
+
+            xfce_backdrop_clear_cached_image(backdrop);
+
+            /* the memory goes once the last workspace lets go of it */
+            if(pix_usage->last_evicted != workspace) {
+                pix_usage->last_evicted = workspace;
+                if(--pix_usage->n_workspaces == 0)
+                    bytes -= pix_usage->bytes;
+            }
+        }
+
+        XF_DEBUG("evicted backdrops of workspace %d, %" G_GSIZE_FORMAT " of %"
+                 G_GSIZE_FORMAT " bytes in use", workspace, bytes, budget);
+    }
+
+    g_list_free(candidates);
+    g_hash_table_destroy(usage);
+}
+
+static gboolean
+xfce_desktop_trim_backdrops_idled(gpointer user_data)
+{
+    XfceDesktop *desktop = XFCE_DESKTOP(user_data);
+
+    desktop->priv->trim_idle = 0;
+    xfce_desktop_trim_backdrops(desktop);
+
+    return FALSE;
+}
+
+/* trims once a burst of finished backdrops has been handled */
+static void
+xfce_desktop_queue_trim_backdrops(XfceDesktop *desktop)
+{
+    if(desktop->priv->trim_idle != 0 || desktop->priv->backdrop_memory_budget == 0)
+        return;
+
+    desktop->priv->trim_idle = g_idle_add_full(G_PRIORITY_LOW,
+                                               xfce_desktop_trim_backdrops_idled,
+                                               desktop, NULL);
+}
+
+/* Number of recently visited workspaces, besides the direct neighbours of
+ * the current one, whose backdrops are rendered ahead of time */
+#define XFCE_DESKTOP_PRERENDER_MRU 2
+
+/* Starts composing the backdrops of @workspace if they aren't available yet,
+ * so switching to it only has to paint an existing pixbuf */
+static void
+xfce_desktop_prerender_workspace(XfceDesktop *desktop,
+                                 gint workspace)
+{
+    gint i;
+
+    xfce_desktop_ensure_workspace_backdrops(desktop, workspace);
+
+    for(i = 0; i < xfce_desktop_get_n_monitors(desktop); i++) {
+        XfceBackdrop *backdrop;
+        GdkRectangle rect;
+        cairo_pattern_t *pattern;
+        GdkPixbuf *pix;
+
+        backdrop = xfce_workspace_get_backdrop(desktop->priv->workspaces[workspace], i);
+        if(!backdrop)
+            continue;
+
+        xfce_desktop_get_backdrop_geometry(desktop, workspace, i, &rect);
+        xfce_backdrop_set_size(backdrop, rect.width, rect.height);
+
+        pattern = xfce_backdrop_create_color_pattern(backdrop);
+        if(pattern) {
+            /* nothing to compose, it's drawn straight from the pattern */
+            cairo_pattern_destroy(pattern);
+        } else if((pix = xfce_backdrop_get_pixbuf(backdrop))) {
+            g_object_unref(pix);
+        } else if(!xfce_backdrop_is_generating(backdrop)) {
+            XF_DEBUG("pre-rendering workspace %d, monitor %d", workspace, i);
+            xfce_backdrop_generate_async(backdrop);
+        }
+
+        /* When we're spanning screens we only care about the first monitor */
+        if(xfce_workspace_get_xinerama_stretch(desktop->priv->workspaces[workspace]))
+            break;
+    }
+}
+
+/* Paints @workspace into a pixmap of its own, so switching to it doesn't
+ * have to draw anything */
+static void
+xfce_desktop_prerender_pixmap(XfceDesktop *desktop,
+                              gint workspace)
+{
+    GdkPixmap *pmap;
+
+    if(workspace == desktop->priv->current_workspace
+       || desktop->priv->updates_frozen
+       || !gtk_widget_get_realized(GTK_WIDGET(desktop))
+       || xfce_desktop_find_workspace_pixmap(desktop, workspace))
+    {
+        return;
+    }
+
+    pmap = xfce_desktop_render_workspace_pixmap(desktop, workspace);
+    if(!pmap)
+        return;
+
+    XF_DEBUG("painted a pixmap for workspace %d", workspace);
+
+    xfce_desktop_remember_workspace_pixmap(desktop, workspace, pmap);
+    g_object_unref(pmap);
+}
+
+static gint
+xfce_desktop_compare_recently_used(gconstpointer a,
+                                   gconstpointer b,
+                                   gpointer user_data)
+{
+    return xfce_desktop_compare_last_used(b, a, user_data);
+}
+
+static gboolean
+xfce_desktop_prerender_idled(gpointer user_data)
+{
+    XfceDesktop *desktop = XFCE_DESKTOP(user_data);
+    gint current, n, i;
+    GList *recent = NULL, *l;
+    gsize budget;
+
+    TRACE("entering");
+
+    desktop->priv->prerender_idle = 0;
+
+    if(!desktop->priv->workspaces)
+        return FALSE;
+
+    current = desktop->priv->current_workspace;
+    n = desktop->priv->nworkspaces;
+    if(current < 0 || current >= n)
+        return FALSE;
+
+    /* the neighbours are exempt from eviction, always keep them ready */
+    xfce_desktop_prerender_workspace(desktop, (current + 1) % n);
+    xfce_desktop_prerender_workspace(desktop, (current + n - 1) % n);
+
+    /* and painted, if their backdrops already are */
+    xfce_desktop_prerender_pixmap(desktop, (current + 1) % n);
+    xfce_desktop_prerender_pixmap(desktop, (current + n - 1) % n);
+
+    for(i = 0; i < n; i++) {
+        if(!xfce_desktop_workspace_is_exempt(desktop, i)
+           && desktop->priv->workspace_last_used[i] != 0)
+        {
+            recent = g_list_prepend(recent, GINT_TO_POINTER(i));
+        }
+    }
+    recent = g_list_sort_with_data(recent,
+                                   xfce_desktop_compare_recently_used,
+                                   desktop->priv->workspace_last_used);
+
+    /* don't render what the memory budget would evict right away */
+    budget = (gsize)desktop->priv->backdrop_memory_budget * 1024 * 1024;
+    for(l = recent, i = 0; l && i < XFCE_DESKTOP_PRERENDER_MRU; l = l->next, i++) {
+        if(budget != 0 && xfce_desktop_get_backdrop_bytes(desktop) >= budget)
+            break;
+        xfce_desktop_prerender_workspace(desktop, GPOINTER_TO_INT(l->data));
+    }
+
+    g_list_free(recent);
+
+    return FALSE;
+}
+
+static void
+xfce_desktop_queue_prerender(XfceDesktop *desktop)
+{
+    if(desktop->priv->prerender_idle != 0)
+        return;
+
+    desktop->priv->prerender_idle = g_idle_add_full(G_PRIORITY_LOW,
+                                                    xfce_desktop_prerender_idled,
+                                                    desktop, NULL);
+}
+
 /* public api */
 
 /**
@@ -1794,6 +3241,8 @@ xfce_desktop_refresh(XfceDesktop *desktop, gboolean advance_wallpaper)
 
     current_workspace = xfce_desktop_get_current_workspace(desktop);
 
+    xfce_desktop_ensure_workspace_backdrops(desktop, current_workspace);
+
     /* reload backgrounds */
     for(i = 0; i < xfce_desktop_get_n_monitors(desktop); i++) {
         XfceBackdrop *backdrop;
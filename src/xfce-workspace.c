@@ -85,8 +85,15 @@ struct _XfceWorkspacePriv
     gboolean xinerama_stretch;
     XfceBackdrop **backdrops;
 
-    gulong *first_color_id;
-    gulong *second_color_id;
+
+    /* identity of the monitor each backdrop was bound for */
+    gchar **monitor_names;
+    GdkRectangle *monitor_geometry;
+
+    /* snapshot of the xfconf settings, kept current by the desktop, and
+     * the property path prefix each backdrop reads its settings from */
+    GHashTable *settings;
+    gchar **backdrop_prefixes;
 };
 
 enum
@@ -110,10 +117,9 @@ static void xfce_workspace_get_property(GObject *object,
 static void xfce_workspace_connect_backdrop_settings(XfceWorkspace *workspace,
                                                    XfceBackdrop *backdrop,
                                                    guint monitor);
-static void xfce_workspace_disconnect_backdrop_settings(XfceWorkspace *workspace,
-                                                        XfceBackdrop *backdrop,
-                                                        guint monitor);
 
+static void xfce_workspace_remove_backdrop(XfceWorkspace *workspace,
+                                           XfceBackdrop *backdrop);
 static void xfce_workspace_remove_backdrops(XfceWorkspace *workspace);
 
 G_DEFINE_TYPE(XfceWorkspace, xfce_workspace, G_TYPE_OBJECT)
@@ -130,12 +136,28 @@ gboolean
 xfce_workspace_get_xinerama_stretch(XfceWorkspace *workspace)
 {
     g_return_val_if_fail(XFCE_IS_WORKSPACE(workspace), FALSE);
-    g_return_val_if_fail(workspace->priv->backdrops != NULL, FALSE);
+
+    /* the desktop only creates backdrops once the workspace is needed */
+    if(workspace->priv->nbackdrops == 0)
+        return FALSE;
+
     g_return_val_if_fail(XFCE_IS_BACKDROP(workspace->priv->backdrops[0]), FALSE);
 
     return xfce_backdrop_get_image_style(workspace->priv->backdrops[0]) == XFCE_BACKDROP_IMAGE_SPANNING_SCREENS;
 }
 
+/* plug name of the monitor the backdrop at @monitor_num was bound for, NULL
+ * if it has none */
+static const gchar *
+xfce_workspace_get_monitor_name(XfceWorkspace *workspace,
+                                guint monitor_num)
+{
+    if(monitor_num >= workspace->priv->nbackdrops)
+        return NULL;
+
+    return workspace->priv->monitor_names[monitor_num];
+}
+
 static void
 xfce_workspace_set_xfconf_property_string(XfceWorkspace *workspace,
                                           guint monitor_num,
@@ -144,12 +166,11 @@ xfce_workspace_set_xfconf_property_string(XfceWorkspace *workspace,
 {
     XfconfChannel *channel = workspace->priv->channel;
     char buf[1024];
-    gchar *monitor_name = NULL;
+    const gchar *monitor_name;
 
     TRACE("entering");
 
-    monitor_name = gdk_screen_get_monitor_plug_name(workspace->priv->gscreen,
-                                                    monitor_num);
+    monitor_name = xfce_workspace_get_monitor_name(workspace, monitor_num);
 
     /* Get the backdrop's image property */
     if(monitor_name == NULL) {
@@ -158,8 +179,6 @@ xfce_workspace_set_xfconf_property_string(XfceWorkspace *workspace,
     } else {
         g_snprintf(buf, sizeof(buf), "%smonitor%s/workspace%d/%s",
                    workspace->priv->property_prefix, monitor_name, workspace->priv->workspace_num, property);
-
-        g_free(monitor_name);
     }
 
     XF_DEBUG("setting %s to %s", buf, value);
@@ -175,15 +194,14 @@ xfce_workspace_set_xfconf_property_value(XfceWorkspace *workspace,
 {
     XfconfChannel *channel = workspace->priv->channel;
     char buf[1024];
-    gchar *monitor_name = NULL;
+    const gchar *monitor_name;
 #ifdef G_ENABLE_DEBUG
     gchar *contents = NULL;
 #endif
 
     TRACE("entering");
 
-    monitor_name = gdk_screen_get_monitor_plug_name(workspace->priv->gscreen,
-                                                    monitor_num);
+    monitor_name = xfce_workspace_get_monitor_name(workspace, monitor_num);
 
     /* Get the backdrop's image property */
     if(monitor_name == NULL) {
@@ -192,8 +210,6 @@ xfce_workspace_set_xfconf_property_value(XfceWorkspace *workspace,
     } else {
         g_snprintf(buf, sizeof(buf), "%smonitor%s/workspace%d/%s",
                    workspace->priv->property_prefix, monitor_name, workspace->priv->workspace_num, property);
-
-        g_free(monitor_name);
     }
 
 #ifdef G_ENABLE_DEBUG
@@ -288,18 +304,13 @@ void
 xfce_workspace_monitors_changed(XfceWorkspace *workspace,
                                 GdkScreen *gscreen)
 {
-    guint i;
-    guint n_monitors;
-    GdkVisual *vis = NULL;
+    XfceWorkspaceMonitor *monitors;
+    guint i, n_monitors;
 
     TRACE("entering");
 
     g_return_if_fail(gscreen);
 
-    vis = gdk_screen_get_rgba_visual(gscreen);
-    if(vis == NULL)
-        vis = gdk_screen_get_system_visual(gscreen);
-
     if(workspace->priv->nbackdrops > 0 &&
        xfce_workspace_get_xinerama_stretch(workspace)) {
         /* When spanning screens we only need one backdrop */
@@ -308,22 +319,116 @@ xfce_workspace_monitors_changed(XfceWorkspace *workspace,
         n_monitors = gdk_screen_get_n_monitors(gscreen);
     }
 
-    /* Remove all backdrops so that the correct monitor is added/removed and
-     * things stay in the correct order */
-    xfce_workspace_remove_backdrops(workspace);
+    monitors = g_new0(XfceWorkspaceMonitor, n_monitors);
+    for(i = 0; i < n_monitors; ++i) {
+        monitors[i].name = gdk_screen_get_monitor_plug_name(gscreen, i);
+        gdk_screen_get_monitor_geometry(gscreen, i, &monitors[i].geometry);
+    }
 
-    /* Allocate space for the backdrops and their color properties so they
-     * can correctly be removed */
-    workspace->priv->backdrops = g_realloc(workspace->priv->backdrops,
-                                           sizeof(XfceBackdrop *) * n_monitors);
-    workspace->priv->first_color_id = g_realloc(workspace->priv->first_color_id,
-                                                sizeof(gulong) * n_monitors);
-    workspace->priv->second_color_id = g_realloc(workspace->priv->second_color_id,
-                                                 sizeof(gulong) * n_monitors);
+    xfce_workspace_set_monitors(workspace, monitors, n_monitors);
 
+    for(i = 0; i < n_monitors; ++i)
+        g_free(monitors[i].name);
+    g_free(monitors);
+}
+
+/**
+ * xfce_workspace_set_monitors:
+ * @workspace: An #XfceWorkspace.
+ * @monitors: The monitor layout, one entry per backdrop.
+ * @n_monitors: Number of entries in @monitors.
+ *
+ * Gives the workspace one backdrop per entry of @monitors.  Backdrops of
+ * monitors that are still there are kept, along with their image; only
+ * those of new monitors are created.  xfce_workspace_monitors_changed()
+ * calls this with the layout of the screen.
+ **/
+void
+xfce_workspace_set_monitors(XfceWorkspace *workspace,
+                            const XfceWorkspaceMonitor *monitors,
+                            guint n_monitors)
+{
+    guint i, j;
+    guint old_nbackdrops;
+    XfceBackdrop **old_backdrops;
+    gchar **old_monitor_names, **old_backdrop_prefixes;
+    GdkRectangle *old_monitor_geometry;
+    GdkVisual *vis = NULL;
+
+    TRACE("entering");
+
+    g_return_if_fail(XFCE_IS_WORKSPACE(workspace));
+    g_return_if_fail(monitors != NULL || n_monitors == 0);
+
+    vis = gdk_screen_get_rgba_visual(workspace->priv->gscreen);
+    if(vis == NULL)
+        vis = gdk_screen_get_system_visual(workspace->priv->gscreen);
+
+    old_nbackdrops = workspace->priv->nbackdrops;
+    old_backdrops = workspace->priv->backdrops;
+    old_monitor_names = workspace->priv->monitor_names;
+    old_monitor_geometry = workspace->priv->monitor_geometry;
+    old_backdrop_prefixes = workspace->priv->backdrop_prefixes;
+
+    workspace->priv->backdrops = g_new0(XfceBackdrop *, n_monitors);
+    workspace->priv->monitor_names = g_new0(gchar *, n_monitors);
+    workspace->priv->monitor_geometry = g_new0(GdkRectangle, n_monitors);
+    workspace->priv->backdrop_prefixes = g_new0(gchar *, n_monitors);
     workspace->priv->nbackdrops = n_monitors;
 
+    /* Backdrops are bound to their settings by the monitor's plug name, so a
+     * backdrop can be kept as long as its monitor is still connected; only
+     * its position in the array may change.  Monitors without a plug name
+     * are bound by index, so those are only kept if neither the index nor
+     * the geometry changed. */
     for(i = 0; i < n_monitors; ++i) {
+        const gchar *name = monitors[i].name;
+        GdkRectangle *geom = &workspace->priv->monitor_geometry[i];
+
+        *geom = monitors[i].geometry;
+        workspace->priv->monitor_names[i] = g_strdup(name);
+
+        for(j = 0; j < old_nbackdrops; ++j) {
+            if(old_backdrops[j] == NULL)
+                continue;
+
+            if(name != NULL && old_monitor_names[j] != NULL) {
+                if(strcmp(name, old_monitor_names[j]) != 0)
+                    continue;
+            } else if(name != NULL || old_monitor_names[j] != NULL
+                      || i != j
+                      || geom->x != old_monitor_geometry[j].x
+                      || geom->y != old_monitor_geometry[j].y
+                      || geom->width != old_monitor_geometry[j].width
+                      || geom->height != old_monitor_geometry[j].height) {
+                continue;
+            }
+
+            XF_DEBUG("Keeping workspace %d backdrop %d as %d",
+                     workspace->priv->workspace_num, j, i);
+
+            workspace->priv->backdrops[i] = old_backdrops[j];
+            workspace->priv->backdrop_prefixes[i] = old_backdrop_prefixes[j];
+            old_backdrop_prefixes[j] = NULL;
+            old_backdrops[j] = NULL;
+            break;
+        }
+    }
+
+    /* Drop the backdrops of monitors that went away */
+    for(j = 0; j < old_nbackdrops; ++j) {
+        if(old_backdrops[j] != NULL) {
+            XF_DEBUG("Removing workspace %d backdrop %d",
+                     workspace->priv->workspace_num, j);
+            xfce_workspace_remove_backdrop(workspace, old_backdrops[j]);
+        }
+    }
+
+    /* And create backdrops for the new ones */
+    for(i = 0; i < n_monitors; ++i) {
+        if(workspace->priv->backdrops[i] != NULL)
+            continue;
+
         XF_DEBUG("Adding workspace %d backdrop %d", workspace->priv->workspace_num, i);
 
         workspace->priv->backdrops[i] = xfce_backdrop_new(vis);
@@ -341,6 +446,15 @@ xfce_workspace_monitors_changed(XfceWorkspace *workspace,
                          "ready",
                          G_CALLBACK(backdrop_changed_cb), workspace);
     }
+
+    for(j = 0; j < old_nbackdrops; ++j) {
+        g_free(old_monitor_names[j]);
+        g_free(old_backdrop_prefixes[j]);
+    }
+    g_free(old_monitor_names);
+    g_free(old_backdrop_prefixes);
+    g_free(old_monitor_geometry);
+    g_free(old_backdrops);
 }
 
 static void
@@ -382,8 +496,11 @@ xfce_workspace_finalize(GObject *object)
     g_object_unref(G_OBJECT(workspace->priv->channel));
     g_free(workspace->priv->property_prefix);
     g_free(workspace->priv->backdrops);
-    g_free(workspace->priv->first_color_id);
-    g_free(workspace->priv->second_color_id);
+    g_free(workspace->priv->monitor_names);
+    g_free(workspace->priv->monitor_geometry);
+    g_free(workspace->priv->backdrop_prefixes);
+    if(workspace->priv->settings)
+        g_hash_table_unref(workspace->priv->settings);
 }
 
 static void
@@ -590,122 +707,222 @@ xfce_workspace_migrate_backdrop_image_style(XfceWorkspace *workspace,
     }
 }
 
-static void
-xfce_workspace_connect_backdrop_settings(XfceWorkspace *workspace,
+typedef void (*XfceWorkspaceMigrateFunc)(XfceWorkspace *workspace,
                                          XfceBackdrop *backdrop,
-                                         guint monitor)
+                                         guint monitor);
+
+/* The per-backdrop xfconf settings, the backdrop properties they map to and
+ * how to fill them in from the pre-4.11 format when they are missing */
+static const struct
 {
-    XfconfChannel *channel = workspace->priv->channel;
-    char buf[1024];
-    gint pp_len;
-    gchar *monitor_name = NULL;
+    const gchar *setting;
+    const gchar *property;
+    XfceWorkspaceMigrateFunc migrate;
+} backdrop_settings[] = {
+    { "color-style", "color-style", xfce_workspace_migrate_backdrop_color_style },
+    { "color1", "first-color", xfce_workspace_migrate_backdrop_first_color },
+    { "color2", "second-color", xfce_workspace_migrate_backdrop_second_color },
+    { "image-style", "image-style", xfce_workspace_migrate_backdrop_image_style },
+    { "backdrop-cycle-enable", "backdrop-cycle-enable", NULL },
+    { "backdrop-cycle-period", "backdrop-cycle-period", NULL },
+    { "backdrop-cycle-timer", "backdrop-cycle-timer", NULL },
+    { "backdrop-cycle-random-order", "backdrop-cycle-random-order", NULL },
+    { "last-image", "image-filename", xfce_workspace_migrate_backdrop_image },
+};
 
-    TRACE("entering");
+/* Colors are stored as an array of four uint16, the way
+ * xfconf_g_property_bind_gdkcolor() wrote them */
+static gboolean
+xfce_workspace_value_to_color(const GValue *value,
+                              GValue *color_value)
+{
+    GPtrArray *arr;
+    GdkColor color = { 0, };
+    guint16 *channels[3] = { &color.red, &color.green, &color.blue };
+    guint i;
 
-    monitor_name = gdk_screen_get_monitor_plug_name(workspace->priv->gscreen, monitor);
+    if(!G_VALUE_HOLDS_BOXED(value))
+        return FALSE;
 
-    if(monitor_name == NULL) {
-        g_snprintf(buf, sizeof(buf), "%smonitor%d/workspace%d/",
-                   workspace->priv->property_prefix, monitor, workspace->priv->workspace_num);
-    } else {
-        g_snprintf(buf, sizeof(buf), "%smonitor%s/workspace%d/",
-                   workspace->priv->property_prefix, monitor_name, workspace->priv->workspace_num);
-    }
-    pp_len = strlen(buf);
+    arr = g_value_get_boxed(value);
+    if(arr == NULL || arr->len < G_N_ELEMENTS(channels))
+        return FALSE;
 
-    XF_DEBUG("prefix string: %s", buf);
+    for(i = 0; i < G_N_ELEMENTS(channels); ++i) {
+        const GValue *v = g_ptr_array_index(arr, i);
 
-    g_strlcat(buf, "color-style", sizeof(buf));
-    if(!xfconf_channel_has_property(channel, buf)) {
-        xfce_workspace_migrate_backdrop_color_style(workspace, backdrop, monitor);
-    }
-    xfconf_g_property_bind(channel, buf, XFCE_TYPE_BACKDROP_COLOR_STYLE,
-                           G_OBJECT(backdrop), "color-style");
+        if(!G_VALUE_HOLDS(v, XFCONF_TYPE_UINT16))
+            return FALSE;
 
-    buf[pp_len] = 0;
-    g_strlcat(buf, "color1", sizeof(buf));
-    if(!xfconf_channel_has_property(channel, buf)) {
-        xfce_workspace_migrate_backdrop_first_color(workspace, backdrop, monitor);
+        *channels[i] = xfconf_g_value_get_uint16(v);
     }
-    workspace->priv->first_color_id[monitor] = xfconf_g_property_bind_gdkcolor(channel, buf,
-                                                            G_OBJECT(backdrop), "first-color");
 
-    buf[pp_len] = 0;
-    g_strlcat(buf, "color2", sizeof(buf));
-    if(!xfconf_channel_has_property(channel, buf)) {
-        xfce_workspace_migrate_backdrop_second_color(workspace, backdrop, monitor);
-    }
-    workspace->priv->second_color_id[monitor] = xfconf_g_property_bind_gdkcolor(channel, buf,
-                                                            G_OBJECT(backdrop), "second-color");
+    g_value_set_boxed(color_value, &color);
 
-    buf[pp_len] = 0;
-    g_strlcat(buf, "image-style", sizeof(buf));
-    if(!xfconf_channel_has_property(channel, buf)) {
-        xfce_workspace_migrate_backdrop_image_style(workspace, backdrop, monitor);
+    return TRUE;
+}
+
+/* Whether @value differs from what @backdrop has for @pspec */
+static gboolean
+xfce_workspace_backdrop_setting_differs(XfceBackdrop *backdrop,
+                                        GParamSpec *pspec,
+                                        const GValue *value)
+{
+    GValue current = { 0, };
+    gboolean differs;
+
+    g_value_init(&current, G_PARAM_SPEC_VALUE_TYPE(pspec));
+    g_object_get_property(G_OBJECT(backdrop), pspec->name, &current);
+
+    /* boxed values would only be compared by address */
+    if(G_VALUE_HOLDS(&current, GDK_TYPE_COLOR)) {
+        const GdkColor *a = g_value_get_boxed(&current);
+        const GdkColor *b = g_value_get_boxed(value);
+
+        differs = (a == NULL || b == NULL || !gdk_color_equal(a, b));
+    } else {
+        differs = (g_param_values_cmp(pspec, &current, value) != 0);
     }
-    xfconf_g_property_bind(channel, buf, XFCE_TYPE_BACKDROP_IMAGE_STYLE,
-                           G_OBJECT(backdrop), "image-style");
 
-    buf[pp_len] = 0;
-    g_strlcat(buf, "backdrop-cycle-enable", sizeof(buf));
-    xfconf_g_property_bind(channel, buf, G_TYPE_BOOLEAN,
-                           G_OBJECT(backdrop), "backdrop-cycle-enable");
+    g_value_unset(&current);
 
-    buf[pp_len] = 0;
-    g_strlcat(buf, "backdrop-cycle-period", sizeof(buf));
-    xfconf_g_property_bind(channel, buf, XFCE_TYPE_BACKDROP_CYCLE_PERIOD,
-                           G_OBJECT(backdrop), "backdrop-cycle-period");
+    return differs;
+}
 
-    buf[pp_len] = 0;
-    g_strlcat(buf, "backdrop-cycle-timer", sizeof(buf));
-    xfconf_g_property_bind(channel, buf, G_TYPE_UINT,
-                           G_OBJECT(backdrop), "backdrop-cycle-timer");
+/* Sets @property of @backdrop from an xfconf @value.  With @note_change,
+ * the backdrop learns about it as a change made from outside, unless it's
+ * just the value it already has, e.g. an echo of its own write */
+static void
+xfce_workspace_apply_backdrop_setting(XfceBackdrop *backdrop,
+                                      const gchar *property,
+                                      const GValue *value,
+                                      gboolean note_change)
+{
+    GParamSpec *pspec;
+    GValue dest = { 0, };
+    gboolean valid;
 
-    buf[pp_len] = 0;
-    g_strlcat(buf, "backdrop-cycle-random-order", sizeof(buf));
-    xfconf_g_property_bind(channel, buf, G_TYPE_BOOLEAN,
-                           G_OBJECT(backdrop), "backdrop-cycle-random-order");
+    /* A reset property leaves the backdrop as it is */
+    if(value == NULL || !G_IS_VALUE(value))
+        return;
 
-    buf[pp_len] = 0;
-    g_strlcat(buf, "last-image", sizeof(buf));
-    if(!xfconf_channel_has_property(channel, buf)) {
-        xfce_workspace_migrate_backdrop_image(workspace, backdrop, monitor);
+    pspec = g_object_class_find_property(G_OBJECT_GET_CLASS(backdrop), property);
+    g_return_if_fail(pspec != NULL);
+
+    g_value_init(&dest, G_PARAM_SPEC_VALUE_TYPE(pspec));
+
+    if(G_VALUE_HOLDS(&dest, GDK_TYPE_COLOR)) {
+        valid = xfce_workspace_value_to_color(value, &dest);
+    } else if(G_VALUE_HOLDS_ENUM(&dest) && G_VALUE_HOLDS_INT(value)) {
+        g_value_set_enum(&dest, g_value_get_int(value));
+        valid = TRUE;
+    } else {
+        valid = g_value_transform(value, &dest);
     }
-    xfconf_g_property_bind(channel, buf, G_TYPE_STRING,
-                           G_OBJECT(backdrop), "image-filename");
 
+    if(valid) {
+        if(note_change && xfce_workspace_backdrop_setting_differs(backdrop, pspec, &dest))
+            xfce_backdrop_note_change(backdrop);
+        g_object_set_property(G_OBJECT(backdrop), property, &dest);
+    } else {
+        g_warning("Ignoring backdrop setting %s of type %s", property, G_VALUE_TYPE_NAME(value));
+    }
 
-    g_free(monitor_name);
+    g_value_unset(&dest);
 }
 
 static void
-xfce_workspace_disconnect_backdrop_settings(XfceWorkspace *workspace,
-                                            XfceBackdrop *backdrop,
-                                            guint monitor)
+xfce_workspace_connect_backdrop_settings(XfceWorkspace *workspace,
+                                         XfceBackdrop *backdrop,
+                                         guint monitor)
 {
+    XfconfChannel *channel = workspace->priv->channel;
+    gchar *prefix;
+    const gchar *monitor_name;
+    guint i;
+
     TRACE("entering");
 
-    g_return_if_fail(XFCE_IS_BACKDROP(backdrop));
+    monitor_name = xfce_workspace_get_monitor_name(workspace, monitor);
+
+    if(monitor_name == NULL) {
+        prefix = g_strdup_printf("%smonitor%d/workspace%d/",
+                                 workspace->priv->property_prefix, monitor,
+                                 workspace->priv->workspace_num);
+    } else {
+        prefix = g_strdup_printf("%smonitor%s/workspace%d/",
+                                 workspace->priv->property_prefix, monitor_name,
+                                 workspace->priv->workspace_num);
+    }
+
+    XF_DEBUG("prefix string: %s", prefix);
+
+    /* set before migrating so the changes that causes already find us */
+    g_free(workspace->priv->backdrop_prefixes[monitor]);
+    workspace->priv->backdrop_prefixes[monitor] = prefix;
+
+    /* Initialize the backdrop from the settings snapshot rather than a
+     * round-trip to xfconfd per property; later changes come in through
+     * xfce_workspace_setting_changed() */
+    for(i = 0; i < G_N_ELEMENTS(backdrop_settings); ++i) {
+        gchar *property = g_strconcat(prefix, backdrop_settings[i].setting, NULL);
+        const GValue *value = NULL;
 
-    xfconf_g_property_unbind_all(G_OBJECT(backdrop));
+        if(workspace->priv->settings != NULL)
+            value = g_hash_table_lookup(workspace->priv->settings, property);
+
+        if(value == NULL && backdrop_settings[i].migrate != NULL) {
+            GValue migrated = { 0, };
+
+            backdrop_settings[i].migrate(workspace, backdrop, monitor);
+
+            /* the migration only wrote to xfconf, so read it back */
+            if(xfconf_channel_get_property(channel, property, &migrated)) {
+                xfce_workspace_apply_backdrop_setting(backdrop,
+                                                      backdrop_settings[i].property,
+                                                      &migrated, FALSE);
+                g_value_unset(&migrated);
+            }
+        } else if(value != NULL) {
+            xfce_workspace_apply_backdrop_setting(backdrop,
+                                                  backdrop_settings[i].property,
+                                                  value, FALSE);
+        }
+
+        g_free(property);
+    }
+}
+
+static void
+xfce_workspace_remove_backdrop(XfceWorkspace *workspace,
+                               XfceBackdrop *backdrop)
+{
+    g_signal_handlers_disconnect_by_func(G_OBJECT(backdrop),
+                                         G_CALLBACK(backdrop_changed_cb),
+                                         workspace);
+    g_signal_handlers_disconnect_by_func(G_OBJECT(backdrop),
+                                         G_CALLBACK(backdrop_cycle_cb),
+                                         workspace);
+    g_object_unref(G_OBJECT(backdrop));
 }
 
 static void
 xfce_workspace_remove_backdrops(XfceWorkspace *workspace)
 {
     guint i;
-    guint n_monitors;
 
     g_return_if_fail(XFCE_IS_WORKSPACE(workspace));
 
-    n_monitors = gdk_screen_get_n_monitors(workspace->priv->gscreen);
-
-    for(i = 0; i < n_monitors && i < workspace->priv->nbackdrops; ++i) {
-        xfce_workspace_disconnect_backdrop_settings(workspace,
-                                                    workspace->priv->backdrops[i],
-                                                    i);
-        g_object_unref(G_OBJECT(workspace->priv->backdrops[i]));
-        workspace->priv->backdrops[i] = NULL;
+    for(i = 0; i < workspace->priv->nbackdrops; ++i) {
+        if(workspace->priv->backdrops[i] != NULL) {
+            xfce_workspace_remove_backdrop(workspace,
+                                           workspace->priv->backdrops[i]);
+            workspace->priv->backdrops[i] = NULL;
+        }
+        g_free(workspace->priv->monitor_names[i]);
+        workspace->priv->monitor_names[i] = NULL;
+        g_free(workspace->priv->backdrop_prefixes[i]);
+        workspace->priv->backdrop_prefixes[i] = NULL;
     }
     workspace->priv->nbackdrops = 0;
 }
@@ -716,6 +933,7 @@ xfce_workspace_remove_backdrops(XfceWorkspace *workspace)
  * xfce_workspace_new:
  * @gscreen: The current #GdkScreen.
  * @channel: An #XfconfChannel to use for settings.
+ * @settings: Snapshot of the backdrop settings on @channel, or %NULL.
  * @property_prefix: String prefix for per-screen properties.
  * @number: The workspace number to represent
  *
@@ -727,6 +945,7 @@ xfce_workspace_remove_backdrops(XfceWorkspace *workspace)
 XfceWorkspace *
 xfce_workspace_new(GdkScreen *gscreen,
                    XfconfChannel *channel,
+                   GHashTable *settings,
                    const gchar *property_prefix,
                    gint number)
 {
@@ -743,6 +962,8 @@ xfce_workspace_new(GdkScreen *gscreen,
     workspace->priv->workspace_num = number;
     workspace->priv->channel = g_object_ref(G_OBJECT(channel));
     workspace->priv->property_prefix = g_strdup(property_prefix);
+    if(settings)
+        workspace->priv->settings = g_hash_table_ref(settings);
 
     return workspace;
 }
@@ -789,3 +1010,44 @@ XfceBackdrop *xfce_workspace_get_backdrop(XfceWorkspace *workspace,
 
     return workspace->priv->backdrops[monitor];
 }
+
+/**
+ * xfce_workspace_setting_changed:
+ * @workspace: An #XfceWorkspace.
+ * @property: The full path of the xfconf property that changed.
+ * @value: The new value, or an unset #GValue if the property was reset.
+ *
+ * Applies a change to one of the backdrop settings of this workspace to the
+ * backdrop it belongs to.  Changes to other properties are ignored.  Only
+ * changes made this way count towards a burst of changes the backdrop
+ * previews, see xfce_backdrop_note_change().
+ **/
+void
+xfce_workspace_setting_changed(XfceWorkspace *workspace,
+                               const gchar *property,
+                               const GValue *value)
+{
+    guint i, j;
+
+    g_return_if_fail(XFCE_IS_WORKSPACE(workspace));
+    g_return_if_fail(property != NULL);
+
+    for(i = 0; i < workspace->priv->nbackdrops; ++i) {
+        const gchar *prefix = workspace->priv->backdrop_prefixes[i];
+        const gchar *setting;
+
+        if(prefix == NULL || !g_str_has_prefix(property, prefix))
+            continue;
+
+        setting = property + strlen(prefix);
+        for(j = 0; j < G_N_ELEMENTS(backdrop_settings); ++j) {
+            if(strcmp(setting, backdrop_settings[j].setting) == 0) {
+                XF_DEBUG("%s changed", property);
+                xfce_workspace_apply_backdrop_setting(workspace->priv->backdrops[i],
+                                                      backdrop_settings[j].property,
+                                                      value, TRUE);
+                return;
+            }
+        }
+    }
+}
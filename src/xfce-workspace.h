@@ -39,6 +39,12 @@ typedef struct _XfceWorkspace XfceWorkspace;
 typedef struct _XfceWorkspaceClass XfceWorkspaceClass;
 typedef struct _XfceWorkspacePriv XfceWorkspacePriv;
 
+typedef struct
+{
+    gchar *name;            /* plug name, or NULL if it has none */
+    GdkRectangle geometry;
+} XfceWorkspaceMonitor;
+
 struct _XfceWorkspace
 {
     GObject gobject;
@@ -59,6 +65,7 @@ GType xfce_workspace_get_type                     (void) G_GNUC_CONST;
 
 XfceWorkspace *xfce_workspace_new(GdkScreen *gscreen,
                                   XfconfChannel *channel,
+                                  GHashTable *settings,
                                   const gchar *property_prefix,
                                   gint number);
 
@@ -67,6 +74,9 @@ void xfce_workspace_set_workspace_num(XfceWorkspace *workspace, gint number);
 
 void xfce_workspace_monitors_changed(XfceWorkspace *workspace,
                                      GdkScreen *gscreen);
+void xfce_workspace_set_monitors(XfceWorkspace *workspace,
+                                 const XfceWorkspaceMonitor *monitors,
+                                 guint n_monitors);
 
 gboolean xfce_workspace_get_xinerama_stretch(XfceWorkspace *workspace);
 
@@ -74,6 +84,10 @@ gboolean xfce_workspace_get_xinerama_stretch(XfceWorkspace *workspace);
 XfceBackdrop *xfce_workspace_get_backdrop(XfceWorkspace *workspace,
                                           guint monitor);
 
+void xfce_workspace_setting_changed(XfceWorkspace *workspace,
+                                    const gchar *property,
+                                    const GValue *value);
+
 G_END_DECLS
 
 #endif
@@ -79,6 +79,9 @@
 #define SAVE_DELAY  1000
 #define BORDER         8
 
+/* how long each idle pass may spend reloading icons after a theme change */
+#define THEME_RELOAD_SLICE_USEC  8000
+
 typedef enum
 {
     PROP0 = 0,
@@ -139,6 +142,9 @@ struct _XfdesktopFileIconManagerPrivate
     
     GQueue *pending_icons;
     guint pending_icons_id;
+
+    GQueue *theme_reload_icons;
+    guint theme_reload_id;
     
     GtkTargetList *drag_targets;
     GtkTargetList *drop_targets;
@@ -2720,6 +2726,9 @@ xfdesktop_file_icon_manager_file_changed(GFileMonitor     *monitor,
         case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
             XF_DEBUG("got changed event");
 
+            /* the mtime may not have moved if it changed within a second */
+            xfdesktop_file_utils_forget_launcher_info(file);
+
             icon = g_hash_table_lookup(fmanager->priv->icons, file);
             if(icon) {
                 file_info = g_file_query_info(file, XFDESKTOP_FILE_INFO_NAMESPACE,
@@ -2764,6 +2773,8 @@ xfdesktop_file_icon_manager_file_changed(GFileMonitor     *monitor,
         case G_FILE_MONITOR_EVENT_DELETED:
             XF_DEBUG("got deleted event");
 
+            xfdesktop_file_utils_forget_launcher_info(file);
+
             filename = g_file_get_path(file);
 
             icon = g_hash_table_lookup(fmanager->priv->icons, file);
@@ -3090,6 +3101,164 @@ xfdesktop_file_icon_manager_load_removable_media(XfdesktopFileIconManager *fmana
                      fmanager);
 }
 
+static void
+xfdesktop_file_icon_manager_cancel_theme_reload(XfdesktopFileIconManager *fmanager)
+{
+    if(fmanager->priv->theme_reload_id != 0) {
+        g_source_remove(fmanager->priv->theme_reload_id);
+        fmanager->priv->theme_reload_id = 0;
+    }
+
+    if(fmanager->priv->theme_reload_icons) {
+        g_queue_foreach(fmanager->priv->theme_reload_icons, (GFunc)g_object_unref, NULL);
+        g_queue_free(fmanager->priv->theme_reload_icons);
+        fmanager->priv->theme_reload_icons = NULL;
+    }
+}
+
+/* Reloads the queued icons a few at a time, so the desktop stays responsive
+ * and redraws in between.  Icons keep their old pixbuf until the new one is
+ * ready. */
+static gboolean
+xfdesktop_file_icon_manager_theme_reload_idled(gpointer user_data)
+{
+    XfdesktopFileIconManager *fmanager = XFDESKTOP_FILE_ICON_MANAGER(user_data);
+    XfdesktopIcon *icon;
+    gint64 end_time = g_get_monotonic_time() + THEME_RELOAD_SLICE_USEC;
+
+    while((icon = g_queue_pop_head(fmanager->priv->theme_reload_icons))) {
+        /* the icon may have been removed in the meantime */
+        if(xfdesktop_icon_peek_icon_view(icon))
+            xfdesktop_icon_reload_pixbuf(icon);
+        else
+            xfdesktop_icon_invalidate_pixbuf(icon);
+
+        g_object_unref(G_OBJECT(icon));
+
+        if(g_get_monotonic_time() >= end_time)
+            return TRUE;
+    }
+
+    g_queue_free(fmanager->priv->theme_reload_icons);
+    fmanager->priv->theme_reload_icons = NULL;
+    fmanager->priv->theme_reload_id = 0;
+
+    return FALSE;
+}
+
+static void
+xfdesktop_file_icon_manager_queue_theme_reload(gpointer key,
+                                               gpointer value,
+                                               gpointer user_data)
+{
+    XfdesktopFileIconManager *fmanager = XFDESKTOP_FILE_ICON_MANAGER(user_data);
+    XfdesktopIcon *icon = XFDESKTOP_ICON(value);
+
+    if(xfdesktop_icon_peek_icon_view(icon)) {
+        /* icons on the desktop get reloaded in the background */
+        g_queue_push_tail(fmanager->priv->theme_reload_icons,
+                          g_object_ref(G_OBJECT(icon)));
+    } else {
+        /* nobody sees the rest, they'll load when they are first drawn */
+        xfdesktop_icon_invalidate_pixbuf(icon);
+    }
+}
+
+/* Icons on the monitor the pointer is on come first, the rest in the order
+ * the icon view lays them out */
+static gint
+xfdesktop_file_icon_manager_compare_reload_order(gconstpointer a,
+                                                 gconstpointer b,
+                                                 gpointer user_data)
+{
+    XfdesktopIcon *icon_a = XFDESKTOP_ICON(a), *icon_b = XFDESKTOP_ICON(b);
+    const GdkRectangle *focus_area = user_data;
+    GdkRectangle extents_a, extents_b, dummy;
+    gboolean focused_a = FALSE, focused_b = FALSE;
+    gint16 row_a = G_MAXINT16, col_a = G_MAXINT16;
+    gint16 row_b = G_MAXINT16, col_b = G_MAXINT16;
+
+    if(xfdesktop_icon_get_extents(icon_a, NULL, NULL, &extents_a))
+        focused_a = gdk_rectangle_intersect(&extents_a, focus_area, &dummy);
+    if(xfdesktop_icon_get_extents(icon_b, NULL, NULL, &extents_b))
+        focused_b = gdk_rectangle_intersect(&extents_b, focus_area, &dummy);
+
+    if(focused_a != focused_b)
+        return focused_a ? -1 : 1;
+
+    xfdesktop_icon_get_position(icon_a, &row_a, &col_a);
+    xfdesktop_icon_get_position(icon_b, &row_b, &col_b);
+
+    if(col_a != col_b)
+        return col_a < col_b ? -1 : 1;
+
+    return row_a < row_b ? -1 : (row_a > row_b ? 1 : 0);
+}
+
+static void
+xfdesktop_file_icon_manager_sort_theme_reload(XfdesktopFileIconManager *fmanager)
+{
+    GdkRectangle focus_area;
+    gint x = 0, y = 0;
+
+    gdk_display_get_pointer(gdk_screen_get_display(fmanager->priv->gscreen),
+                            NULL, &x, &y, NULL);
+    gdk_screen_get_monitor_geometry(fmanager->priv->gscreen,
+                                    gdk_screen_get_monitor_at_point(fmanager->priv->gscreen,
+                                                                    x, y),
+                                    &focus_area);
+
+    g_queue_sort(fmanager->priv->theme_reload_icons,
+                 xfdesktop_file_icon_manager_compare_reload_order,
+                 &focus_area);
+}
+
+/* One handler for all of our icons: drop everything that came from the old
+ * theme and reload the icons in time-sliced batches instead of having every
+ * icon reload synchronously on the next expose. */
+static void
+xfdesktop_file_icon_manager_icon_theme_changed(GtkIconTheme *itheme,
+                                               gpointer user_data)
+{
+    XfdesktopFileIconManager *fmanager = XFDESKTOP_FILE_ICON_MANAGER(user_data);
+
+    TRACE("entering");
+
+    xfdesktop_file_utils_clear_icon_cache();
+
+    xfdesktop_file_icon_manager_cancel_theme_reload(fmanager);
+    fmanager->priv->theme_reload_icons = g_queue_new();
+
+    if(fmanager->priv->special_icons) {
+        g_hash_table_foreach(fmanager->priv->special_icons,
+                             xfdesktop_file_icon_manager_queue_theme_reload,
+                             fmanager);
+    }
+    if(fmanager->priv->removable_icons) {
+        g_hash_table_foreach(fmanager->priv->removable_icons,
+                             xfdesktop_file_icon_manager_queue_theme_reload,
+                             fmanager);
+    }
+    if(fmanager->priv->icons) {
+        g_hash_table_foreach(fmanager->priv->icons,
+                             xfdesktop_file_icon_manager_queue_theme_reload,
+                             fmanager);
+    }
+    if(fmanager->priv->desktop_icon)
+        xfdesktop_icon_invalidate_pixbuf(XFDESKTOP_ICON(fmanager->priv->desktop_icon));
+
+    /* the hash tables come in no particular order, reload what the user is
+     * looking at first */
+    xfdesktop_file_icon_manager_sort_theme_reload(fmanager);
+
+    XF_DEBUG("reloading %u icons", g_queue_get_length(fmanager->priv->theme_reload_icons));
+
+    /* the default idle priority is below redraws, so the desktop keeps
+     * painting the old icons while we work through the queue */
+    fmanager->priv->theme_reload_id = g_idle_add(xfdesktop_file_icon_manager_theme_reload_idled,
+                                                 fmanager);
+}
+
 static void
 xfdesktop_file_icon_manager_ht_remove_removable_media(gpointer key,
                                                       gpointer value,
@@ -3196,6 +3365,11 @@ xfdesktop_file_icon_manager_real_init(XfdesktopIconViewManager *manager,
     
     if(!xfdesktop_file_utils_dbus_init())
         g_warning("Unable to initialise D-Bus.  Some xfdesktop features may be unavailable.");
+
+    g_signal_connect(G_OBJECT(gtk_icon_theme_get_default()),
+                     "changed",
+                     G_CALLBACK(xfdesktop_file_icon_manager_icon_theme_changed),
+                     fmanager);
     
     /* do this in the reverse order stuff should be displayed */
     xfdesktop_file_icon_manager_load_desktop_folder(fmanager);
@@ -3248,6 +3422,11 @@ xfdesktop_file_icon_manager_fini(XfdesktopIconViewManager *manager)
     }
 
     fmanager->priv->inited = FALSE;
+
+    g_signal_handlers_disconnect_by_func(G_OBJECT(gtk_icon_theme_get_default()),
+                                         G_CALLBACK(xfdesktop_file_icon_manager_icon_theme_changed),
+                                         fmanager);
+    xfdesktop_file_icon_manager_cancel_theme_reload(fmanager);
     
     if(fmanager->priv->enumerator) {
         g_object_unref(fmanager->priv->enumerator);
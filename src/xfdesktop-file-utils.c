@@ -162,79 +162,324 @@ xfdesktop_file_utils_format_time_for_display(guint64 file_time)
     return g_strdup(_("Unknown"));
 }
 
-GKeyFile *
-xfdesktop_file_utils_query_key_file(GFile *file,
-                                    GCancellable *cancellable,
-                                    GError **error)
+/* Parsed launchers, keyed by path; an entry is only valid for the mtime it
+ * was parsed at.  The least recently used entries are dropped beyond
+ * XFDESKTOP_LAUNCHER_CACHE_SIZE. */
+#define XFDESKTOP_LAUNCHER_CACHE_SIZE  256
+
+typedef struct
 {
-    GKeyFile *key_file;
-    gchar *contents = NULL;
-    gsize length;
+    XfdesktopLauncherInfo *launcher_info;
+    GList *lru_link;  /* in xfdesktop_launcher_lru, points to the hash key */
+} XfdesktopLauncherCacheEntry;
 
-    g_return_val_if_fail(G_IS_FILE(file), NULL);
-    g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
-    g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+static GHashTable *xfdesktop_launcher_cache = NULL;
+static GQueue xfdesktop_launcher_lru = G_QUEUE_INIT;
 
-    /* try to load the entire file into memory */
-    if (!g_file_load_contents(file, cancellable, &contents, &length, NULL, error))
-        return NULL;
+XfdesktopLauncherInfo *
+xfdesktop_launcher_info_ref(XfdesktopLauncherInfo *launcher_info)
+{
+    g_return_val_if_fail(launcher_info != NULL, NULL);
+
+    g_atomic_int_inc(&launcher_info->ref_count);
+
+    return launcher_info;
+}
+
+void
+xfdesktop_launcher_info_unref(XfdesktopLauncherInfo *launcher_info)
+{
+    g_return_if_fail(launcher_info != NULL);
+
+    if(!g_atomic_int_dec_and_test(&launcher_info->ref_count))
+        return;
+
+    g_free(launcher_info->name);
+    g_free(launcher_info->icon);
+    g_free(launcher_info->comment);
+    g_free(launcher_info->path);
+    g_slice_free(XfdesktopLauncherInfo, launcher_info);
+}
+
+static guint64
+xfdesktop_launcher_info_get_mtime(GFileInfo *info)
+{
+    return g_file_info_get_attribute_uint64(info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+}
+
+static void
+xfdesktop_launcher_cache_entry_free(gpointer data)
+{
+    XfdesktopLauncherCacheEntry *entry = data;
+
+    g_queue_delete_link(&xfdesktop_launcher_lru, entry->lru_link);
+    xfdesktop_launcher_info_unref(entry->launcher_info);
+    g_slice_free(XfdesktopLauncherCacheEntry, entry);
+}
+
+static void
+xfdesktop_launcher_cache_insert(XfdesktopLauncherInfo *launcher_info)
+{
+    XfdesktopLauncherCacheEntry *entry;
+    gchar *key = g_strdup(launcher_info->path);
+
+    entry = g_slice_new(XfdesktopLauncherCacheEntry);
+    entry->launcher_info = xfdesktop_launcher_info_ref(launcher_info);
+    entry->lru_link = g_list_alloc();
+    entry->lru_link->data = key;
+
+    /* replacing an entry unlinks the old one */
+    g_hash_table_replace(xfdesktop_launcher_cache, key, entry);
+    g_queue_push_tail_link(&xfdesktop_launcher_lru, entry->lru_link);
+
+    while(g_queue_get_length(&xfdesktop_launcher_lru) > XFDESKTOP_LAUNCHER_CACHE_SIZE)
+        g_hash_table_remove(xfdesktop_launcher_cache,
+                            g_queue_peek_head(&xfdesktop_launcher_lru));
+}
+
+static void
+xfdesktop_launcher_cache_ensure(void)
+{
+    if(G_LIKELY(xfdesktop_launcher_cache))
+        return;
+
+    xfdesktop_launcher_cache = g_hash_table_new_full(g_str_hash,
+                                                     g_str_equal,
+                                                     g_free,
+                                                     xfdesktop_launcher_cache_entry_free);
+}
+
+static void
+xfdesktop_launcher_info_parse(XfdesktopLauncherInfo *launcher_info,
+                              const gchar *contents,
+                              gsize length)
+{
+    GKeyFile *key_file;
+    gchar *type, *value;
 
-    /* allocate a new key file */
     key_file = g_key_file_new();
 
-    /* try to parse the key file from the contents of the file */
-    if (length == 0
-        || g_key_file_load_from_data(key_file, contents, length,
-                                     G_KEY_FILE_KEEP_COMMENTS
-                                     | G_KEY_FILE_KEEP_TRANSLATIONS,
-                                     error))
+    if(length == 0
+       || !g_key_file_load_from_data(key_file, contents, length,
+                                     G_KEY_FILE_NONE, NULL))
     {
-        g_free(contents);
-        return key_file;
+        g_key_file_free(key_file);
+        return;
     }
-    else
+
+    launcher_info->name = g_key_file_get_locale_string(key_file,
+                                                       G_KEY_FILE_DESKTOP_GROUP,
+                                                       G_KEY_FILE_DESKTOP_KEY_NAME,
+                                                       NULL, NULL);
+    if(launcher_info->name
+       && (*launcher_info->name == '\0'
+           || !g_utf8_validate(launcher_info->name, -1, NULL)))
     {
-        g_free(contents);
-        g_key_file_free(key_file);
-        return NULL;
+        g_free(launcher_info->name);
+        launcher_info->name = NULL;
     }
+
+    launcher_info->icon = g_key_file_get_string(key_file,
+                                                G_KEY_FILE_DESKTOP_GROUP,
+                                                G_KEY_FILE_DESKTOP_KEY_ICON,
+                                                NULL);
+
+    launcher_info->comment = g_key_file_get_locale_string(key_file,
+                                                          G_KEY_FILE_DESKTOP_GROUP,
+                                                          G_KEY_FILE_DESKTOP_KEY_COMMENT,
+                                                          NULL, NULL);
+
+    /* an application needs a command line and, if it names one, its
+     * TryExec binary; a link needs a target */
+    type = g_key_file_get_string(key_file, G_KEY_FILE_DESKTOP_GROUP,
+                                 G_KEY_FILE_DESKTOP_KEY_TYPE, NULL);
+    if(!g_strcmp0(type, G_KEY_FILE_DESKTOP_TYPE_APPLICATION)) {
+        value = g_key_file_get_string(key_file, G_KEY_FILE_DESKTOP_GROUP,
+                                      G_KEY_FILE_DESKTOP_KEY_EXEC, NULL);
+        launcher_info->exec_valid = (value != NULL && *value != '\0');
+        g_free(value);
+
+        value = g_key_file_get_string(key_file, G_KEY_FILE_DESKTOP_GROUP,
+                                      G_KEY_FILE_DESKTOP_KEY_TRY_EXEC, NULL);
+        if(launcher_info->exec_valid && value && *value != '\0') {
+            gchar *program = g_find_program_in_path(value);
+            launcher_info->exec_valid = (program != NULL);
+            g_free(program);
+        }
+        g_free(value);
+    } else if(!g_strcmp0(type, G_KEY_FILE_DESKTOP_TYPE_LINK)) {
+        value = g_key_file_get_string(key_file, G_KEY_FILE_DESKTOP_GROUP,
+                                      G_KEY_FILE_DESKTOP_KEY_URL, NULL);
+        launcher_info->exec_valid = (value != NULL && *value != '\0');
+        g_free(value);
+    }
+    g_free(type);
+
+    g_key_file_free(key_file);
 }
 
-gchar *
-xfdesktop_file_utils_get_display_name(GFile *file,
-                                      GFileInfo *info)
+/**
+ * xfdesktop_file_utils_lookup_launcher_info:
+ * @file: a .desktop file.
+ * @info: the current #GFileInfo of @file.
+ *
+ * Returns: a new reference to the cached #XfdesktopLauncherInfo of @file,
+ *          or %NULL if it hasn't been parsed yet or was modified since.
+ **/
+XfdesktopLauncherInfo *
+xfdesktop_file_utils_lookup_launcher_info(GFile *file,
+                                          GFileInfo *info)
 {
-    GKeyFile *key_file;
-    gchar *display_name = NULL;
-
-    g_return_val_if_fail(G_IS_FILE_INFO(info), NULL);
-
-    /* check if we have a desktop entry */
-    if(xfdesktop_file_utils_is_desktop_file(info)) {
-        /* try to load its data into a GKeyFile */
-        key_file = xfdesktop_file_utils_query_key_file(file, NULL, NULL);
-        if(key_file) {
-            /* try to parse the display name */
-            display_name = g_key_file_get_locale_string(key_file,
-                                                        G_KEY_FILE_DESKTOP_GROUP,
-                                                        G_KEY_FILE_DESKTOP_KEY_NAME,
-                                                        NULL,
-                                                        NULL);
-
-            /* free the key file */
-            g_key_file_free (key_file);
+    XfdesktopLauncherCacheEntry *entry;
+    XfdesktopLauncherInfo *launcher_info = NULL;
+    gchar *path;
+
+    g_return_val_if_fail(G_IS_FILE(file) && G_IS_FILE_INFO(info), NULL);
+
+    if(!xfdesktop_launcher_cache)
+        return NULL;
+
+    path = g_file_get_path(file);
+    if(path) {
+        entry = g_hash_table_lookup(xfdesktop_launcher_cache, path);
+        if(entry
+           && entry->launcher_info->mtime == xfdesktop_launcher_info_get_mtime(info))
+        {
+            launcher_info = xfdesktop_launcher_info_ref(entry->launcher_info);
+
+            /* most recently used */
+            g_queue_unlink(&xfdesktop_launcher_lru, entry->lru_link);
+            g_queue_push_tail_link(&xfdesktop_launcher_lru, entry->lru_link);
         }
+        g_free(path);
     }
 
-    /* use the default display name as a fallback */
-    if(!display_name
-       || *display_name == '\0'
-       || !g_utf8_validate(display_name, -1, NULL))
+    return launcher_info;
+}
+
+static void
+xfdesktop_file_utils_launcher_contents_loaded(GObject *source_object,
+                                              GAsyncResult *res,
+                                              gpointer user_data)
+{
+    GSimpleAsyncResult *result = user_data;
+    XfdesktopLauncherInfo *launcher_info;
+    GError *error = NULL;
+    gchar *contents = NULL;
+    gsize length = 0;
+
+    launcher_info = g_simple_async_result_get_op_res_gpointer(result);
+
+    if(g_file_load_contents_finish(G_FILE(source_object), res,
+                                   &contents, &length, NULL, &error))
     {
-        display_name = g_strdup(g_file_info_get_display_name(info));
+        xfdesktop_launcher_info_parse(launcher_info, contents, length);
+        g_free(contents);
+
+        /* an unparsable launcher is cached as well, so it isn't read over
+         * and over again until it changes */
+        xfdesktop_launcher_cache_ensure();
+        xfdesktop_launcher_cache_insert(launcher_info);
+    } else
+        g_simple_async_result_take_error(result, error);
+
+    g_simple_async_result_complete(result);
+    g_object_unref(result);
+}
+
+/**
+ * xfdesktop_file_utils_load_launcher_info_async:
+ * @file: a .desktop file.
+ * @info: the current #GFileInfo of @file.
+ * @cancellable: a #GCancellable or %NULL.
+ * @callback: called once the launcher is parsed.
+ * @user_data: data for @callback.
+ *
+ * Reads @file asynchronously and parses the keys needed to display it.
+ * The result is cached until @file's modification time changes or
+ * xfdesktop_file_utils_forget_launcher_info() is called for it.
+ **/
+void
+xfdesktop_file_utils_load_launcher_info_async(GFile *file,
+                                              GFileInfo *info,
+                                              GCancellable *cancellable,
+                                              GAsyncReadyCallback callback,
+                                              gpointer user_data)
+{
+    GSimpleAsyncResult *result;
+    XfdesktopLauncherInfo *launcher_info;
+
+    g_return_if_fail(G_IS_FILE(file) && G_IS_FILE_INFO(info));
+
+    launcher_info = g_slice_new0(XfdesktopLauncherInfo);
+    launcher_info->ref_count = 1;
+    launcher_info->path = g_file_get_path(file);
+    launcher_info->mtime = xfdesktop_launcher_info_get_mtime(info);
+
+    result = g_simple_async_result_new(NULL, callback, user_data,
+                                       xfdesktop_file_utils_load_launcher_info_async);
+    g_simple_async_result_set_op_res_gpointer(result, launcher_info,
+                                              (GDestroyNotify)xfdesktop_launcher_info_unref);
+
+    if(!launcher_info->path) {
+        /* nothing to key the cache on, don't bother */
+        g_simple_async_result_set_error(result, G_IO_ERROR,
+                                        G_IO_ERROR_NOT_SUPPORTED,
+                                        "Launcher has no local path");
+        g_simple_async_result_complete_in_idle(result);
+        g_object_unref(result);
+        return;
     }
 
-    return display_name;
+    g_file_load_contents_async(file, cancellable,
+                               xfdesktop_file_utils_launcher_contents_loaded,
+                               result);
+}
+
+/**
+ * xfdesktop_file_utils_load_launcher_info_finish:
+ * @result: the #GAsyncResult passed to the callback.
+ *
+ * Returns: a new reference to the parsed launcher, or %NULL if the file
+ *          couldn't be read or the operation was cancelled.
+ **/
+XfdesktopLauncherInfo *
+xfdesktop_file_utils_load_launcher_info_finish(GAsyncResult *result)
+{
+    GSimpleAsyncResult *simple = G_SIMPLE_ASYNC_RESULT(result);
+
+    g_return_val_if_fail(g_simple_async_result_is_valid(result, NULL,
+                                                        xfdesktop_file_utils_load_launcher_info_async),
+                         NULL);
+
+    if(g_simple_async_result_propagate_error(simple, NULL))
+        return NULL;
+
+    return xfdesktop_launcher_info_ref(g_simple_async_result_get_op_res_gpointer(simple));
+}
+
+/**
+ * xfdesktop_file_utils_forget_launcher_info:
+ * @file: a .desktop file.
+ *
+ * Drops the cached launcher of @file, e.g. after the file monitor
+ * reported a change that might not have moved the modification time.
+ **/
+void
+xfdesktop_file_utils_forget_launcher_info(GFile *file)
+{
+    gchar *path;
+
+    g_return_if_fail(G_IS_FILE(file));
+
+    if(!xfdesktop_launcher_cache)
+        return;
+
+    path = g_file_get_path(file);
+    if(path) {
+        g_hash_table_remove(xfdesktop_launcher_cache, path);
+        g_free(path);
+    }
 }
 
 GList *
@@ -360,6 +605,227 @@ xfdesktop_file_utils_get_fallback_icon(gint size)
     return g_object_ref(G_OBJECT(xfdesktop_fallback_icon));
 }
 
+/* Composed icons are shared between all the desktop icons that ask for the
+ * same GIcon (which includes its emblems), size and opacity.  The cache
+ * doesn't own the pixbufs: an entry only lives as long as somebody holds a
+ * reference to its pixbuf, and the file icon manager drops the whole table
+ * when the icon theme changes.  Only themed icons are cached, thumbnails and other file
+ * icons are unique per file and may change on disk. */
+typedef struct
+{
+    GIcon *gicon;
+    gint width;
+    gint height;
+    guint opacity;
+    GdkPixbuf *pix;
+} XfdesktopIconCacheEntry;
+
+static GHashTable *xfdesktop_icon_cache = NULL;
+static guint xfdesktop_icon_cache_hits = 0;
+static guint xfdesktop_icon_cache_misses = 0;
+
+static guint
+xfdesktop_icon_cache_entry_hash(gconstpointer data)
+{
+    const XfdesktopIconCacheEntry *entry = data;
+
+    return g_icon_hash((gpointer)entry->gicon)
+           ^ ((guint)entry->width << 20)
+           ^ ((guint)entry->height << 8)
+           ^ entry->opacity;
+}
+
+static gboolean
+xfdesktop_icon_cache_entry_equal(gconstpointer a,
+                                 gconstpointer b)
+{
+    const XfdesktopIconCacheEntry *entry_a = a;
+    const XfdesktopIconCacheEntry *entry_b = b;
+
+    return entry_a->width == entry_b->width
+           && entry_a->height == entry_b->height
+           && entry_a->opacity == entry_b->opacity
+           && g_icon_equal(entry_a->gicon, entry_b->gicon);
+}
+
+static void
+xfdesktop_icon_cache_entry_free(gpointer data)
+{
+    XfdesktopIconCacheEntry *entry = data;
+
+    g_object_unref(entry->gicon);
+    g_slice_free(XfdesktopIconCacheEntry, entry);
+}
+
+/* called when the last user of a cached pixbuf drops it */
+static void
+xfdesktop_icon_cache_pixbuf_finalized(gpointer data,
+                                      GObject *where_the_object_was)
+{
+    if(xfdesktop_icon_cache)
+        g_hash_table_remove(xfdesktop_icon_cache, data);
+}
+
+static void
+xfdesktop_icon_cache_forget_pixbuf(gpointer key,
+                                   gpointer value,
+                                   gpointer user_data)
+{
+    XfdesktopIconCacheEntry *entry = value;
+
+    g_object_weak_unref(G_OBJECT(entry->pix),
+                        xfdesktop_icon_cache_pixbuf_finalized,
+                        entry);
+}
+
+/**
+ * xfdesktop_file_utils_clear_icon_cache:
+ *
+ * Drops every composed icon from the shared icon cache.  Pixbufs that are
+ * still in use stay valid, but new lookups will load the icon again.  This
+ * must be called when the icon theme changes.
+ **/
+void
+xfdesktop_file_utils_clear_icon_cache(void)
+{
+    if(!xfdesktop_icon_cache)
+        return;
+
+    XF_DEBUG("dropping %u cached icons (%u hits, %u misses)",
+             g_hash_table_size(xfdesktop_icon_cache),
+             xfdesktop_icon_cache_hits, xfdesktop_icon_cache_misses);
+
+    g_hash_table_foreach(xfdesktop_icon_cache,
+                         xfdesktop_icon_cache_forget_pixbuf, NULL);
+    g_hash_table_remove_all(xfdesktop_icon_cache);
+}
+
+/**
+ * xfdesktop_file_utils_get_icon_cache_stats:
+ * @hits: return location for the number of lookups served from the cache,
+ *        or %NULL.
+ * @misses: return location for the number of lookups that had to load the
+ *          icon, or %NULL.
+ *
+ * Returns: the number of icons currently held in the shared icon cache.
+ **/
+guint
+xfdesktop_file_utils_get_icon_cache_stats(guint *hits,
+                                          guint *misses)
+{
+    if(hits)
+        *hits = xfdesktop_icon_cache_hits;
+    if(misses)
+        *misses = xfdesktop_icon_cache_misses;
+
+    return xfdesktop_icon_cache ? g_hash_table_size(xfdesktop_icon_cache) : 0;
+}
+
+static GdkPixbuf *
+xfdesktop_icon_cache_lookup(GIcon *gicon,
+                            gint width,
+                            gint height,
+                            guint opacity)
+{
+    XfdesktopIconCacheEntry key, *entry;
+
+    if(G_UNLIKELY(!xfdesktop_icon_cache)) {
+        xfdesktop_icon_cache = g_hash_table_new_full(xfdesktop_icon_cache_entry_hash,
+                                                     xfdesktop_icon_cache_entry_equal,
+                                                     NULL,
+                                                     xfdesktop_icon_cache_entry_free);
+    }
+
+    key.gicon = gicon;
+    key.width = width;
+    key.height = height;
+    key.opacity = opacity;
+
+    entry = g_hash_table_lookup(xfdesktop_icon_cache, &key);
+    if(entry) {
+        xfdesktop_icon_cache_hits++;
+        return g_object_ref(G_OBJECT(entry->pix));
+    }
+
+    xfdesktop_icon_cache_misses++;
+
+    return NULL;
+}
+
+static void
+xfdesktop_icon_cache_insert(GIcon *gicon,
+                            gint width,
+                            gint height,
+                            guint opacity,
+                            GdkPixbuf *pix)
+{
+    XfdesktopIconCacheEntry *entry;
+
+    entry = g_slice_new(XfdesktopIconCacheEntry);
+    entry->gicon = g_object_ref(gicon);
+    entry->width = width;
+    entry->height = height;
+    entry->opacity = opacity;
+    entry->pix = pix;
+
+    g_object_weak_ref(G_OBJECT(pix), xfdesktop_icon_cache_pixbuf_finalized, entry);
+    g_hash_table_replace(xfdesktop_icon_cache, entry, entry);
+}
+
+/* loads an image icon that isn't part of the icon theme, this may be called
+ * from a worker thread */
+static GdkPixbuf *
+xfdesktop_file_utils_load_image_icon(GIcon *base_icon,
+                                     gint width,
+                                     gint height,
+                                     GCancellable *cancellable)
+{
+    GdkPixbuf *pix = NULL;
+
+    if(G_IS_LOADABLE_ICON(base_icon)) {
+        GInputStream *stream = g_loadable_icon_load(G_LOADABLE_ICON(base_icon),
+                                                    MIN(width, height), NULL,
+                                                    cancellable, NULL);
+        if(stream) {
+            pix = gdk_pixbuf_new_from_stream_at_scale(stream, width, height, TRUE,
+                                                      cancellable, NULL);
+            g_object_unref(stream);
+        }
+    } else if(G_IS_FILE_ICON(base_icon)) {
+        GFile *file = g_file_icon_get_file(G_FILE_ICON(base_icon));
+        gchar *path = g_file_get_path(file);
+
+        if(path)
+            pix = gdk_pixbuf_new_from_file_at_size(path, width, height, NULL);
+
+        g_free(path);
+    }
+
+    return pix;
+}
+
+/* adds the emblems and applies the opacity, takes ownership of @pix which
+ * must not be shared if @icon has emblems */
+static GdkPixbuf *
+xfdesktop_file_utils_finish_icon(GIcon *icon,
+                                 GdkPixbuf *pix,
+                                 guint opacity)
+{
+    /* Add the emblems */
+    if(G_IS_EMBLEMED_ICON(icon))
+        xfdesktop_file_utils_add_emblems(pix, g_emblemed_icon_get_emblems(G_EMBLEMED_ICON(icon)));
+
+    if(opacity != 100) {
+        GdkPixbuf *tmp = exo_gdk_pixbuf_lucent(pix, opacity);
+        g_object_unref(G_OBJECT(pix));
+        pix = tmp;
+    }
+
+    return pix;
+}
+
+/* The returned pixbuf may be shared with other icons and must not be
+ * modified by the caller. */
 GdkPixbuf *
 xfdesktop_file_utils_get_icon(GIcon *icon,
                               gint width,
@@ -370,6 +836,7 @@ xfdesktop_file_utils_get_icon(GIcon *icon,
     GdkPixbuf *pix_theme = NULL, *pix = NULL;
     GIcon *base_icon = NULL;
     gint size = MIN(width, height);
+    gboolean cacheable;
 
     g_return_val_if_fail(width > 0 && height > 0 && icon != NULL, NULL);
 
@@ -382,6 +849,13 @@ xfdesktop_file_utils_get_icon(GIcon *icon,
     if(!base_icon)
         return NULL;
 
+    cacheable = G_IS_THEMED_ICON(base_icon);
+    if(cacheable) {
+        pix = xfdesktop_icon_cache_lookup(icon, width, height, opacity);
+        if(pix)
+            return pix;
+    }
+
     if(G_IS_THEMED_ICON(base_icon)) {
       GtkIconInfo *icon_info = gtk_icon_theme_lookup_by_gicon(itheme,
                                                               base_icon, size,
@@ -390,21 +864,8 @@ xfdesktop_file_utils_get_icon(GIcon *icon,
           pix_theme = gtk_icon_info_load_icon(icon_info, NULL);
           gtk_icon_info_free(icon_info);
       }
-    } else if(G_IS_LOADABLE_ICON(base_icon)) {
-        GInputStream *stream = g_loadable_icon_load(G_LOADABLE_ICON(base_icon),
-                                                    size, NULL, NULL, NULL);
-        if(stream) {
-            pix = gdk_pixbuf_new_from_stream_at_scale(stream, width, height, TRUE, NULL, NULL);
-            g_object_unref(stream);
-        }
-    } else if(G_IS_FILE_ICON(base_icon)) {
-        GFile *file = g_file_icon_get_file(G_FILE_ICON(icon));
-        gchar *path = g_file_get_path(file);
-
-        pix = gdk_pixbuf_new_from_file_at_size(path, width, height, NULL);
-
-        g_free(path);
-        g_object_unref(file);
+    } else {
+        pix = xfdesktop_file_utils_load_image_icon(base_icon, width, height, NULL);
     }
 
 
@@ -432,19 +893,180 @@ xfdesktop_file_utils_get_icon(GIcon *icon,
         return NULL;
     }
 
-    /* Add the emblems */
-    if(G_IS_EMBLEMED_ICON(icon))
-        xfdesktop_file_utils_add_emblems(pix, g_emblemed_icon_get_emblems(G_EMBLEMED_ICON(icon)));
-
-    if(opacity != 100) {
-        GdkPixbuf *tmp = exo_gdk_pixbuf_lucent(pix, opacity);
+    /* don't draw the emblems on the shared fallback icon */
+    if(G_IS_EMBLEMED_ICON(icon) && pix == xfdesktop_fallback_icon) {
+        GdkPixbuf *tmp = gdk_pixbuf_copy(pix);
         g_object_unref(G_OBJECT(pix));
         pix = tmp;
     }
 
+    pix = xfdesktop_file_utils_finish_icon(icon, pix, opacity);
+
+    /* the fallback icon has its own cache */
+    if(cacheable && pix != xfdesktop_fallback_icon)
+        xfdesktop_icon_cache_insert(icon, width, height, opacity, pix);
+
     return pix;
 }
 
+/**
+ * xfdesktop_file_utils_icon_needs_decoding:
+ * @icon: a #GIcon, possibly with emblems.
+ *
+ * Returns: %TRUE if @icon refers to an image (e.g. a thumbnail) that has to
+ *          be decoded rather than looked up in the icon theme.  Such icons
+ *          should be loaded with xfdesktop_file_utils_decode_icon_async().
+ **/
+gboolean
+xfdesktop_file_utils_icon_needs_decoding(GIcon *icon)
+{
+    GIcon *base_icon;
+
+    if(G_IS_EMBLEMED_ICON(icon))
+        base_icon = g_emblemed_icon_get_icon(G_EMBLEMED_ICON(icon));
+    else
+        base_icon = icon;
+
+    return base_icon != NULL
+           && !G_IS_THEMED_ICON(base_icon)
+           && (G_IS_LOADABLE_ICON(base_icon) || G_IS_FILE_ICON(base_icon));
+}
+
+typedef struct
+{
+    GIcon *base_icon;
+    gint width;
+    gint height;
+    GdkPixbuf *pix;
+} XfdesktopIconDecodeData;
+
+static void
+xfdesktop_icon_decode_data_free(gpointer data)
+{
+    XfdesktopIconDecodeData *decode_data = data;
+
+    g_object_unref(decode_data->base_icon);
+    if(decode_data->pix)
+        g_object_unref(decode_data->pix);
+    g_slice_free(XfdesktopIconDecodeData, decode_data);
+}
+
+/* runs in a worker thread: only touches the image, never the icon theme */
+static void
+xfdesktop_file_utils_decode_icon_thread(GSimpleAsyncResult *result,
+                                        GObject *object,
+                                        GCancellable *cancellable)
+{
+    XfdesktopIconDecodeData *decode_data;
+
+    decode_data = g_simple_async_result_get_op_res_gpointer(result);
+
+    if(g_cancellable_is_cancelled(cancellable))
+        return;
+
+    decode_data->pix = xfdesktop_file_utils_load_image_icon(decode_data->base_icon,
+                                                            decode_data->width,
+                                                            decode_data->height,
+                                                            cancellable);
+}
+
+/**
+ * xfdesktop_file_utils_decode_icon_async:
+ * @icon: a #GIcon for which xfdesktop_file_utils_icon_needs_decoding()
+ *        returns %TRUE.
+ * @width: the maximum width of the image.
+ * @height: the maximum height of the image.
+ * @cancellable: a #GCancellable or %NULL.
+ * @callback: called in the main loop once the image is decoded.
+ * @user_data: data for @callback.
+ *
+ * Decodes the image behind @icon in a worker thread, so that large or slow
+ * images don't block the main loop.  Emblems are not applied, use
+ * xfdesktop_file_utils_compose_icon() on the result for that.
+ **/
+void
+xfdesktop_file_utils_decode_icon_async(GIcon *icon,
+                                       gint width,
+                                       gint height,
+                                       GCancellable *cancellable,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+    GSimpleAsyncResult *result;
+    XfdesktopIconDecodeData *decode_data;
+
+    g_return_if_fail(xfdesktop_file_utils_icon_needs_decoding(icon));
+    g_return_if_fail(width > 0 && height > 0);
+
+    decode_data = g_slice_new0(XfdesktopIconDecodeData);
+    if(G_IS_EMBLEMED_ICON(icon))
+        decode_data->base_icon = g_object_ref(g_emblemed_icon_get_icon(G_EMBLEMED_ICON(icon)));
+    else
+        decode_data->base_icon = g_object_ref(icon);
+    decode_data->width = width;
+    decode_data->height = height;
+
+    result = g_simple_async_result_new(NULL, callback, user_data,
+                                       xfdesktop_file_utils_decode_icon_async);
+    g_simple_async_result_set_op_res_gpointer(result, decode_data,
+                                              xfdesktop_icon_decode_data_free);
+
+    g_simple_async_result_run_in_thread(result,
+                                        xfdesktop_file_utils_decode_icon_thread,
+                                        G_PRIORITY_DEFAULT,
+                                        cancellable);
+    g_object_unref(result);
+}
+
+/**
+ * xfdesktop_file_utils_decode_icon_finish:
+ * @result: the #GAsyncResult passed to the callback.
+ *
+ * Returns: the decoded image, which the caller owns, or %NULL if the image
+ *          couldn't be loaded or the operation was cancelled.
+ **/
+GdkPixbuf *
+xfdesktop_file_utils_decode_icon_finish(GAsyncResult *result)
+{
+    XfdesktopIconDecodeData *decode_data;
+
+    g_return_val_if_fail(g_simple_async_result_is_valid(result, NULL,
+                                                        xfdesktop_file_utils_decode_icon_async),
+                         NULL);
+
+    decode_data = g_simple_async_result_get_op_res_gpointer(G_SIMPLE_ASYNC_RESULT(result));
+
+    return decode_data->pix ? g_object_ref(decode_data->pix) : NULL;
+}
+
+/**
+ * xfdesktop_file_utils_compose_icon:
+ * @icon: the #GIcon @base_pix was decoded from.
+ * @base_pix: the decoded image, it isn't modified.
+ * @opacity: the opacity of the icon in percent.
+ *
+ * Adds the emblems of @icon to @base_pix and applies @opacity, just like
+ * xfdesktop_file_utils_get_icon() would do.
+ *
+ * Returns: a new reference to the composed icon.
+ **/
+GdkPixbuf *
+xfdesktop_file_utils_compose_icon(GIcon *icon,
+                                  GdkPixbuf *base_pix,
+                                  guint opacity)
+{
+    GdkPixbuf *pix;
+
+    g_return_val_if_fail(G_IS_ICON(icon) && GDK_IS_PIXBUF(base_pix), NULL);
+
+    if(G_IS_EMBLEMED_ICON(icon))
+        pix = gdk_pixbuf_copy(base_pix);
+    else
+        pix = g_object_ref(G_OBJECT(base_pix));
+
+    return xfdesktop_file_utils_finish_icon(icon, pix, opacity);
+}
+
 static void
 xfdesktop_file_utils_add_emblems(GdkPixbuf *pix, GList *emblems)
 {
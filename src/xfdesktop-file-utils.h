@@ -33,11 +33,32 @@
 gboolean xfdesktop_file_utils_is_desktop_file(GFileInfo *info);
 gboolean xfdesktop_file_utils_file_is_executable(GFileInfo *info);
 gchar *xfdesktop_file_utils_format_time_for_display(guint64 file_time);
-GKeyFile *xfdesktop_file_utils_query_key_file(GFile *file, 
-                                              GCancellable *cancellable, 
-                                              GError **error);
-gchar *xfdesktop_file_utils_get_display_name(GFile *file,
-                                             GFileInfo *info);
+
+typedef struct _XfdesktopLauncherInfo XfdesktopLauncherInfo;
+struct _XfdesktopLauncherInfo
+{
+    gchar *name;          /* localized Name, %NULL if missing or invalid */
+    gchar *icon;          /* Icon key as written in the file */
+    gchar *comment;       /* localized Comment */
+    gboolean exec_valid;  /* the launcher has something to launch */
+
+    /*< private >*/
+    gint ref_count;
+    gchar *path;
+    guint64 mtime;
+};
+
+XfdesktopLauncherInfo *xfdesktop_launcher_info_ref(XfdesktopLauncherInfo *launcher_info);
+void xfdesktop_launcher_info_unref(XfdesktopLauncherInfo *launcher_info);
+XfdesktopLauncherInfo *xfdesktop_file_utils_lookup_launcher_info(GFile *file,
+                                                                 GFileInfo *info);
+void xfdesktop_file_utils_load_launcher_info_async(GFile *file,
+                                                   GFileInfo *info,
+                                                   GCancellable *cancellable,
+                                                   GAsyncReadyCallback callback,
+                                                   gpointer user_data);
+XfdesktopLauncherInfo *xfdesktop_file_utils_load_launcher_info_finish(GAsyncResult *result);
+void xfdesktop_file_utils_forget_launcher_info(GFile *file);
 
 GList *xfdesktop_file_utils_file_icon_list_to_file_list(GList *icon_list);
 GList *xfdesktop_file_utils_file_list_from_string(const gchar *string);
@@ -51,6 +72,20 @@ GdkPixbuf *xfdesktop_file_utils_get_icon(GIcon *icon,
                                          gint width,
                                          gint height,
                                          guint opacity);
+GdkPixbuf *xfdesktop_file_utils_compose_icon(GIcon *icon,
+                                             GdkPixbuf *base_pix,
+                                             guint opacity);
+gboolean xfdesktop_file_utils_icon_needs_decoding(GIcon *icon);
+void xfdesktop_file_utils_decode_icon_async(GIcon *icon,
+                                            gint width,
+                                            gint height,
+                                            GCancellable *cancellable,
+                                            GAsyncReadyCallback callback,
+                                            gpointer user_data);
+GdkPixbuf *xfdesktop_file_utils_decode_icon_finish(GAsyncResult *result);
+void xfdesktop_file_utils_clear_icon_cache(void);
+guint xfdesktop_file_utils_get_icon_cache_stats(guint *hits,
+                                                guint *misses);
 
 void xfdesktop_file_utils_set_window_cursor(GtkWindow *window,
                                             GdkCursorType cursor_type);
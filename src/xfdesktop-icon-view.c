@@ -72,6 +72,11 @@
 #define MIN_MARGIN        8
 #define DEFAULT_RUBBERBAND_ALPHA  64
 
+/* icons are scaled while the icon size keeps changing, and reloaded at the
+ * exact size once it has been stable for this long */
+#define ICON_SIZE_SETTLE_DELAY  300
+#define ICON_SIZE_SETTLE_SLICE_USEC  8000
+
 #if defined(DEBUG) && DEBUG > 0
 #define DUMP_GRID_LAYOUT(icon_view) \
 {\
@@ -109,6 +114,16 @@ typedef struct
     guint source_id;
 } XfdesktopIdleRepaintData;
 
+/* In retained mode icons are painted into one ARGB pixmap per monitor, which
+ * is only repainted where icons changed; exposes just composite it over the
+ * backdrop.  damage is in root window coordinates. */
+typedef struct
+{
+    GdkRectangle geometry;
+    GdkPixmap *pixmap;
+    GdkRegion *damage;
+} XfdesktopIconLayer;
+
 struct _XfdesktopIconViewPrivate
 {
     XfdesktopIconViewManager *manager;
@@ -139,8 +154,23 @@ struct _XfdesktopIconViewPrivate
     gint16 nrows;
     gint16 ncols;
     XfdesktopIcon **grid_layout;
+    /* number of cells an icon's extents may reach beyond its own cell */
+    gint16 extents_overflow;
+    /* icons painted by the last expose */
+    guint n_repainted_icons;
+
+    gboolean retained_layer;
+    XfdesktopIconLayer *icon_layers;
+    gint n_icon_layers;
     
     guint grid_resize_timeout;
+
+    guint icon_size_settle_timeout;
+    guint icon_size_settle_idle;
+    /* icons waiting to be reloaded at their exact size, and the same icons
+     * as a set for quick membership checks from the paint loop */
+    GQueue *settle_icons;
+    GHashTable *settle_icon_set;
     
     GtkSelectionMode sel_mode;
     guint maybe_begin_drag:1,
@@ -292,9 +322,19 @@ static void xfdesktop_icon_view_invalidate_icon_pixbuf(XfdesktopIconView *icon_v
 
 static void xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
                                            XfdesktopIcon *icon,
+                                           GdkDrawable *drawable,
+                                           gint x_origin,
+                                           gint y_origin,
                                            GdkRectangle *area);
 static void xfdesktop_icon_view_repaint_icons(XfdesktopIconView *icon_view,
-                                              GdkRectangle *area);
+                                              GdkDrawable *drawable,
+                                              gint x_origin,
+                                              gint y_origin,
+                                              GdkRegion *region);
+
+static void xfdesktop_icon_view_damage_icon_layers(XfdesktopIconView *icon_view,
+                                                   const GdkRectangle *area);
+static void xfdesktop_icon_view_free_icon_layers(XfdesktopIconView *icon_view);
                                   
 static void xfdesktop_setup_grids(XfdesktopIconView *icon_view);
 static gboolean xfdesktop_grid_get_next_free_position(XfdesktopIconView *icon_view,
@@ -328,8 +368,13 @@ static inline void xfdesktop_xy_to_rowcol(XfdesktopIconView *icon_view,
                                           gint16 *row,
                                           gint16 *col);
 static gboolean xfdesktop_grid_resize_timeout(gpointer user_data);
+static void xfdesktop_icon_view_cancel_icon_size_settle(XfdesktopIconView *icon_view);
+static void xfdesktop_icon_view_queue_icon_settle(XfdesktopIconView *icon_view,
+                                                  XfdesktopIcon *icon);
 static void xfdesktop_screen_size_changed_cb(GdkScreen *gscreen,
                                              gpointer user_data);
+static void xfdesktop_screen_monitors_changed_cb(GdkScreen *gscreen,
+                                                 gpointer user_data);
 static GdkFilterReturn xfdesktop_rootwin_watch_workarea(GdkXEvent *gxevent,
                                                         GdkEvent *event,
                                                         gpointer user_data);
@@ -385,6 +430,7 @@ enum
     PROP_SINGLE_CLICK,
     PROP_SHOW_TOOLTIPS,
     PROP_TOOLTIP_SIZE,
+    PROP_RETAINED_LAYER,
 };
 
 
@@ -647,6 +693,13 @@ xfdesktop_icon_view_class_init(XfdesktopIconViewClass *klass)
                                                         -1, MAX_TOOLTIP_SIZE, -1,
                                                         XFDESKTOP_PARAM_FLAGS));
 
+    g_object_class_install_property(gobject_class, PROP_RETAINED_LAYER,
+                                    g_param_spec_boolean("retained-layer",
+                                                         "retained layer",
+                                                         "keep painted icons in an offscreen layer",
+                                                         FALSE,
+                                                         XFDESKTOP_PARAM_FLAGS));
+
 #undef XFDESKTOP_PARAM_FLAGS
 
     /* same binding entries as GtkIconView */
@@ -722,6 +775,10 @@ xfdesktop_icon_view_init(XfdesktopIconView *icon_view)
 
     icon_view->priv->allow_rubber_banding = TRUE;
     icon_view->priv->selection_box_alpha = DEFAULT_RUBBERBAND_ALPHA;
+
+    icon_view->priv->settle_icons = g_queue_new();
+    icon_view->priv->settle_icon_set = g_hash_table_new(g_direct_hash,
+                                                        g_direct_equal);
     
     icon_view->priv->native_targets = gtk_target_list_new(icon_view_targets,
                                                           icon_view_n_targets);
@@ -760,6 +817,10 @@ xfdesktop_icon_view_finalize(GObject *obj)
     g_list_free(icon_view->priv->pending_icons);
     /* icon_view->priv->icons should be cleared in _unrealize() */
 
+    xfdesktop_icon_view_cancel_icon_size_settle(icon_view);
+    g_queue_free(icon_view->priv->settle_icons);
+    g_hash_table_destroy(icon_view->priv->settle_icon_set);
+
     if (icon_view->priv->channel)
         icon_view->priv->channel = NULL;
 
@@ -787,6 +848,13 @@ xfce_icon_view_set_property(GObject *object,
             icon_view->priv->tooltip_size_from_xfconf = g_value_get_double(value);
             break;
 
+        case PROP_RETAINED_LAYER:
+            icon_view->priv->retained_layer = g_value_get_boolean(value);
+            xfdesktop_icon_view_free_icon_layers(icon_view);
+            if(gtk_widget_get_realized(GTK_WIDGET(icon_view)))
+                gtk_widget_queue_draw(GTK_WIDGET(icon_view));
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
             break;
@@ -814,6 +882,10 @@ xfce_icon_view_get_property(GObject *object,
             g_value_set_double(value, icon_view->priv->tooltip_size_from_xfconf);
             break;
 
+        case PROP_RETAINED_LAYER:
+            g_value_set_boolean(value, icon_view->priv->retained_layer);
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
             break;
@@ -1910,6 +1982,7 @@ static void
 xfdesktop_icon_view_icon_theme_changed(GtkIconTheme *icon_theme,
                                        gpointer user_data)
 {
+    xfdesktop_icon_view_damage_icon_layers(XFDESKTOP_ICON_VIEW(user_data), NULL);
     gtk_widget_queue_draw(GTK_WIDGET(user_data));
 }    
 
@@ -2014,6 +2087,8 @@ xfdesktop_icon_view_style_set(GtkWidget *widget,
     GTK_WIDGET_CLASS(xfdesktop_icon_view_parent_class)->style_set(widget,
                                                                   previous_style);
 
+    xfdesktop_icon_view_damage_icon_layers(icon_view, NULL);
+
     /* do this after we're sure we have a style set */
     if(!icon_view->priv->selection_box_color) {
         GtkStyle *style = gtk_widget_get_style(widget);
@@ -2097,6 +2172,8 @@ xfdesktop_icon_view_realize(GtkWidget *widget)
     
     g_signal_connect(G_OBJECT(gscreen), "size-changed",
                      G_CALLBACK(xfdesktop_screen_size_changed_cb), icon_view);
+    g_signal_connect(G_OBJECT(gscreen), "monitors-changed",
+                     G_CALLBACK(xfdesktop_screen_monitors_changed_cb), icon_view);
     
     g_signal_connect_after(G_OBJECT(gtk_icon_theme_get_for_screen(gscreen)),
                            "changed",
@@ -2142,10 +2219,17 @@ xfdesktop_icon_view_unrealize(GtkWidget *widget)
         g_source_remove(icon_view->priv->grid_resize_timeout);
         icon_view->priv->grid_resize_timeout = 0;
     }
+
+    xfdesktop_icon_view_cancel_icon_size_settle(icon_view);
+
+    xfdesktop_icon_view_free_icon_layers(icon_view);
     
     g_signal_handlers_disconnect_by_func(G_OBJECT(gscreen),
                                          G_CALLBACK(xfdesktop_screen_size_changed_cb),
                                          icon_view);
+    g_signal_handlers_disconnect_by_func(G_OBJECT(gscreen),
+                                         G_CALLBACK(xfdesktop_screen_monitors_changed_cb),
+                                         icon_view);
     
     /* FIXME: really clear these? */
     g_list_free(icon_view->priv->selected_icons);
@@ -2184,7 +2268,9 @@ xfdesktop_icon_view_expose(GtkWidget *widget,
 {
     XfdesktopIconView *icon_view = XFDESKTOP_ICON_VIEW(widget);
     GdkRectangle *rects = NULL;
+#ifdef G_ENABLE_DEBUG
     GdkRectangle clipbox;
+#endif
     gint n_rects = 0, i;
 
     /*TRACE("entering");*/
@@ -2193,9 +2279,23 @@ xfdesktop_icon_view_expose(GtkWidget *widget,
         return FALSE;
 
     gdk_region_get_rectangles(evt->region, &rects, &n_rects);
-    gdk_region_get_clipbox(evt->region, &clipbox);
 
-    xfdesktop_icon_view_repaint_icons(icon_view, &clipbox);
+    icon_view->priv->n_repainted_icons = 0;
+
+    if(xfdesktop_icon_view_ensure_icon_layers(icon_view))
+        xfdesktop_icon_view_composite_icon_layers(icon_view, evt->region);
+    else {
+        xfdesktop_icon_view_repaint_icons(icon_view,
+                                          GDK_DRAWABLE(gtk_widget_get_window(widget)),
+                                          0, 0, evt->region);
+    }
+
+#ifdef G_ENABLE_DEBUG
+    gdk_region_get_clipbox(evt->region, &clipbox);
+    XF_DEBUG("expose %dx%d+%d+%d repainted %u icons",
+             clipbox.width, clipbox.height, clipbox.x, clipbox.y,
+             icon_view->priv->n_repainted_icons);
+#endif
 
     if(icon_view->priv->definitely_rubber_banding) {
         GdkRectangle intersect;
@@ -2581,6 +2681,9 @@ xfdesktop_screen_size_changed_cb(GdkScreen *gscreen,
                                  gpointer user_data)
 {
     XfdesktopIconView *icon_view = XFDESKTOP_ICON_VIEW(user_data);
+
+    /* the monitor layout may have changed too */
+    xfdesktop_icon_view_free_icon_layers(icon_view);
     
    /* this is kinda icky.  we want to use _NET_WORKAREA to reset the size of
      * the grid, but we can never be sure it'll actually change.  so let's
@@ -2592,38 +2695,247 @@ xfdesktop_screen_size_changed_cb(GdkScreen *gscreen,
                                                          icon_view);   
 }
 
+/* Monitors can be moved or resized without the screen changing size, the
+ * icon layers are per monitor and get recreated on the next expose */
+static void
+xfdesktop_screen_monitors_changed_cb(GdkScreen *gscreen,
+                                     gpointer user_data)
+{
+    XfdesktopIconView *icon_view = XFDESKTOP_ICON_VIEW(user_data);
+
+    xfdesktop_icon_view_free_icon_layers(icon_view);
+    gtk_widget_queue_draw(GTK_WIDGET(icon_view));
+}
+
+/* Icons whose extents aren't known yet have never been painted, those are
+ * painted on any expose of their cell */
+static inline gboolean
+xfdesktop_icon_view_icon_is_damaged(XfdesktopIcon *icon,
+                                    GdkRegion *region)
+{
+    GdkRectangle extents;
+
+    if(!xfdesktop_icon_get_extents(icon, NULL, NULL, &extents))
+        return TRUE;
+
+    return gdk_region_rect_in(region, &extents) != GDK_OVERLAP_RECTANGLE_OUT;
+}
+
+/* Repaints the icons overlapping region into drawable (see
+ * xfdesktop_icon_view_paint_icon()).  Rather than checking every icon,
+ * only the grid cells under the damage, widened by how far icons can reach
+ * beyond their cell, are looked at. */
 static void
 xfdesktop_icon_view_repaint_icons(XfdesktopIconView *icon_view,
-                                  GdkRectangle *area)
+                                  GdkDrawable *drawable,
+                                  gint x_origin,
+                                  gint y_origin,
+                                  GdkRegion *region)
 {
-    GdkRectangle extents, dummy;
-    GList *l;
+    GdkRectangle clipbox;
+    GList *selected = NULL, *l;
     XfdesktopIcon *icon;
-    
+    gint16 first_row, first_col, last_row, last_col, row, col;
+    gint16 overflow = icon_view->priv->extents_overflow;
+
+    if(!icon_view->priv->grid_layout
+       || icon_view->priv->nrows <= 0 || icon_view->priv->ncols <= 0)
+    {
+        return;
+    }
+
+    gdk_region_get_clipbox(region, &clipbox);
+    if(clipbox.width <= 0 || clipbox.height <= 0)
+        return;
+
+    xfdesktop_xy_to_rowcol(icon_view, clipbox.x, clipbox.y,
+                           &first_row, &first_col);
+    xfdesktop_xy_to_rowcol(icon_view,
+                           clipbox.x + clipbox.width - 1,
+                           clipbox.y + clipbox.height - 1,
+                           &last_row, &last_col);
+
+    first_row = MAX(first_row - overflow - 1, 0);
+    first_col = MAX(first_col - overflow - 1, 0);
+    last_row = MIN(last_row + overflow + 1, icon_view->priv->nrows - 1);
+    last_col = MIN(last_col + overflow + 1, icon_view->priv->ncols - 1);
+
     /* fist paint non-selected items, then paint selected items */
-    for(l = icon_view->priv->icons; l; l = l->next) {
-        icon = (XfdesktopIcon *)l->data;
-        if (xfdesktop_icon_view_is_icon_selected(icon_view, icon))
-            continue;
+    for(col = first_col; col <= last_col; ++col) {
+        for(row = first_row; row <= last_row; ++row) {
+            icon = xfdesktop_icon_view_icon_in_cell(icon_view, row, col);
+            if(!icon || !xfdesktop_icon_view_icon_is_damaged(icon, region))
+                continue;
 
-        if(!xfdesktop_icon_get_extents(icon, NULL, NULL, &extents)
-           || gdk_rectangle_intersect(area, &extents, &dummy))
-        {
-            xfdesktop_icon_view_paint_icon(icon_view, icon, area);
+            if(xfdesktop_icon_view_is_icon_selected(icon_view, icon)) {
+                selected = g_list_prepend(selected, icon);
+                continue;
+            }
+
+            xfdesktop_icon_view_paint_icon(icon_view, icon, drawable,
+                                           x_origin, y_origin, &clipbox);
+            icon_view->priv->n_repainted_icons++;
         }
     }
-    
-    for(l = icon_view->priv->icons; l; l = l->next) {
-        icon = (XfdesktopIcon *)l->data;
-        if (!xfdesktop_icon_view_is_icon_selected(icon_view, icon))
+
+    for(l = selected; l; l = l->next) {
+        xfdesktop_icon_view_paint_icon(icon_view, XFDESKTOP_ICON(l->data),
+                                       drawable, x_origin, y_origin, &clipbox);
+        icon_view->priv->n_repainted_icons++;
+    }
+
+    g_list_free(selected);
+}
+
+static void
+xfdesktop_icon_view_free_icon_layers(XfdesktopIconView *icon_view)
+{
+    gint i;
+
+    for(i = 0; i < icon_view->priv->n_icon_layers; ++i) {
+        g_object_unref(G_OBJECT(icon_view->priv->icon_layers[i].pixmap));
+        gdk_region_destroy(icon_view->priv->icon_layers[i].damage);
+    }
+
+    g_free(icon_view->priv->icon_layers);
+    icon_view->priv->icon_layers = NULL;
+    icon_view->priv->n_icon_layers = 0;
+}
+
+/* Creates the icon layers if retained mode is on.  Returns FALSE if icons
+ * should be painted straight to the window, e.g. when the screen has no
+ * ARGB visual. */
+static gboolean
+xfdesktop_icon_view_ensure_icon_layers(XfdesktopIconView *icon_view)
+{
+    GdkScreen *gscreen;
+    GdkColormap *cmap;
+    GdkWindow *window;
+    gint i, depth;
+
+    if(icon_view->priv->icon_layers)
+        return TRUE;
+
+    if(!icon_view->priv->retained_layer
+       || !gtk_widget_get_realized(GTK_WIDGET(icon_view)))
+    {
+        return FALSE;
+    }
+
+    gscreen = gtk_widget_get_screen(GTK_WIDGET(icon_view));
+    cmap = gdk_screen_get_rgba_colormap(gscreen);
+    if(!cmap) {
+        XF_DEBUG("no ARGB visual, painting icons directly");
+        return FALSE;
+    }
+
+    window = gtk_widget_get_window(GTK_WIDGET(icon_view));
+    depth = gdk_visual_get_depth(gdk_colormap_get_visual(cmap));
+
+    icon_view->priv->n_icon_layers = gdk_screen_get_n_monitors(gscreen);
+    icon_view->priv->icon_layers = g_new0(XfdesktopIconLayer,
+                                          icon_view->priv->n_icon_layers);
+
+    for(i = 0; i < icon_view->priv->n_icon_layers; ++i) {
+        XfdesktopIconLayer *layer = &icon_view->priv->icon_layers[i];
+
+        gdk_screen_get_monitor_geometry(gscreen, i, &layer->geometry);
+
+        layer->pixmap = gdk_pixmap_new(window, layer->geometry.width,
+                                       layer->geometry.height, depth);
+        gdk_drawable_set_colormap(GDK_DRAWABLE(layer->pixmap), cmap);
+
+        /* everything needs painting at first */
+        layer->damage = gdk_region_rectangle(&layer->geometry);
+    }
+
+    return TRUE;
+}
+
+/* Marks area (or everything if NULL) to be repainted in the icon layers on
+ * the next expose.  Callers still have to queue the redraw themselves. */
+static void
+xfdesktop_icon_view_damage_icon_layers(XfdesktopIconView *icon_view,
+                                       const GdkRectangle *area)
+{
+    GdkRectangle intersection;
+    gint i;
+
+    for(i = 0; i < icon_view->priv->n_icon_layers; ++i) {
+        XfdesktopIconLayer *layer = &icon_view->priv->icon_layers[i];
+
+        if(!area)
+            gdk_region_union_with_rect(layer->damage, &layer->geometry);
+        else if(gdk_rectangle_intersect(&layer->geometry, area, &intersection))
+            gdk_region_union_with_rect(layer->damage, &intersection);
+    }
+}
+
+/* Brings the damaged part of layer up to date.  The damage is rounded up
+ * to its bounding box, since the label boxes and shadows are translucent
+ * and must not be painted twice over pixels that weren't cleared. */
+static void
+xfdesktop_icon_view_update_icon_layer(XfdesktopIconView *icon_view,
+                                      XfdesktopIconLayer *layer)
+{
+    GdkRectangle clipbox;
+    GdkRegion *region;
+    cairo_t *cr;
+
+    if(gdk_region_empty(layer->damage))
+        return;
+
+    gdk_region_get_clipbox(layer->damage, &clipbox);
+    gdk_region_destroy(layer->damage);
+    layer->damage = gdk_region_new();
+
+    cr = gdk_cairo_create(GDK_DRAWABLE(layer->pixmap));
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_rectangle(cr, clipbox.x - layer->geometry.x,
+                    clipbox.y - layer->geometry.y,
+                    clipbox.width, clipbox.height);
+    cairo_fill(cr);
+    cairo_destroy(cr);
+
+    region = gdk_region_rectangle(&clipbox);
+    xfdesktop_icon_view_repaint_icons(icon_view, GDK_DRAWABLE(layer->pixmap),
+                                      layer->geometry.x, layer->geometry.y,
+                                      region);
+    gdk_region_destroy(region);
+}
+
+/* Composites the icon layers over the backdrop GDK has already cleared the
+ * exposed region to */
+static void
+xfdesktop_icon_view_composite_icon_layers(XfdesktopIconView *icon_view,
+                                          GdkRegion *region)
+{
+    GdkWindow *window = gtk_widget_get_window(GTK_WIDGET(icon_view));
+    cairo_t *cr;
+    gint i;
+
+    cr = gdk_cairo_create(GDK_DRAWABLE(window));
+    gdk_cairo_region(cr, region);
+    cairo_clip(cr);
+
+    for(i = 0; i < icon_view->priv->n_icon_layers; ++i) {
+        XfdesktopIconLayer *layer = &icon_view->priv->icon_layers[i];
+
+        if(gdk_region_rect_in(region, &layer->geometry) == GDK_OVERLAP_RECTANGLE_OUT)
             continue;
 
-        if(!xfdesktop_icon_get_extents(icon, NULL, NULL, &extents)
-           || gdk_rectangle_intersect(area, &extents, &dummy))
-        {
-            xfdesktop_icon_view_paint_icon(icon_view, icon, area);
-        }
+        xfdesktop_icon_view_update_icon_layer(icon_view, layer);
+
+        cairo_save(cr);
+        gdk_cairo_rectangle(cr, &layer->geometry);
+        cairo_clip(cr);
+        gdk_cairo_set_source_pixmap(cr, layer->pixmap,
+                                    layer->geometry.x, layer->geometry.y);
+        cairo_paint(cr);
+        cairo_restore(cr);
     }
+
+    cairo_destroy(cr);
 }
 
 static inline gboolean
@@ -2798,6 +3110,7 @@ xfdesktop_icon_view_invalidate_icon(XfdesktopIconView *icon_view,
     /* we always have to invalidate the old extents */
     if(xfdesktop_icon_get_extents(icon, NULL, NULL, &extents)) {
         if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
+            xfdesktop_icon_view_damage_icon_layers(icon_view, &extents);
             gtk_widget_queue_draw_area(GTK_WIDGET(icon_view), extents.x,
                                        extents.y, extents.width,
                                        extents.height);
@@ -2817,6 +3130,7 @@ xfdesktop_icon_view_invalidate_icon(XfdesktopIconView *icon_view,
         {
             g_warning("Trying to invalidate icon, but can't recalculate extents");
         } else if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
+            xfdesktop_icon_view_damage_icon_layers(icon_view, &total_extents);
             gtk_widget_queue_draw_area(GTK_WIDGET(icon_view),
                                        total_extents.x, total_extents.y,
                                        total_extents.width, total_extents.height);
@@ -2850,6 +3164,7 @@ xfdesktop_icon_view_invalidate_icon_pixbuf(XfdesktopIconView *icon_view,
         rect.y += CELL_PADDING + (ICON_SIZE - rect.height) / 2;;
     
         if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
+            xfdesktop_icon_view_damage_icon_layers(icon_view, &rect);
             gtk_widget_queue_draw_area(GTK_WIDGET(icon_view), rect.x, rect.y,
                                        rect.width, rect.height);
         }
@@ -2858,6 +3173,7 @@ xfdesktop_icon_view_invalidate_icon_pixbuf(XfdesktopIconView *icon_view,
 
 static void
 xfdesktop_paint_rounded_box(XfdesktopIconView *icon_view,
+                            cairo_t *cr,
                             GtkStateType state,
                             GdkRectangle *box_area,
                             GdkRectangle *expose_area)
@@ -2865,7 +3181,6 @@ xfdesktop_paint_rounded_box(XfdesktopIconView *icon_view,
     GdkRectangle intersection;
     
     if(gdk_rectangle_intersect(box_area, expose_area, &intersection)) {
-        cairo_t *cr = gdk_cairo_create(gtk_widget_get_window(GTK_WIDGET(icon_view)));
         GtkStyle *style = gtk_widget_get_style(GTK_WIDGET(icon_view));
         double alpha;
 
@@ -2874,6 +3189,8 @@ xfdesktop_paint_rounded_box(XfdesktopIconView *icon_view,
         else
             alpha = icon_view->priv->selected_label_alpha / 255.;
 
+        cairo_save(cr);
+
         cairo_set_source_rgba(cr, style->base[state].red / 65535.,
                               style->base[state].green / 65535.,
                               style->base[state].blue / 65535.,
@@ -2912,7 +3229,7 @@ xfdesktop_paint_rounded_box(XfdesktopIconView *icon_view,
 
         cairo_fill(cr);
 
-        cairo_destroy(cr);
+        cairo_restore(cr);
     }
 }
 
@@ -3013,6 +3330,31 @@ xfdesktop_icon_view_shift_area_to_cell(XfdesktopIconView *icon_view,
     return TRUE;
 }
 
+/* Long labels and shadows can stick out of an icon's cell; remembers the
+ * farthest any icon reaches, in cells, for xfdesktop_icon_view_repaint_icons() */
+static void
+xfdesktop_icon_view_update_extents_overflow(XfdesktopIconView *icon_view,
+                                            XfdesktopIcon *icon,
+                                            GdkRectangle *total_extents)
+{
+    GdkRectangle cell;
+    gint cell_size = CELL_SIZE, overflow, cells;
+
+    if(cell_size <= 0 || !xfdesktop_icon_view_shift_area_to_cell(icon_view, icon, &cell))
+        return;
+
+    overflow = MAX(MAX(cell.x - total_extents->x,
+                       cell.y - total_extents->y),
+                   MAX(total_extents->x + total_extents->width - (cell.x + cell_size),
+                       total_extents->y + total_extents->height - (cell.y + cell_size)));
+    if(overflow <= 0)
+        return;
+
+    cells = (overflow + cell_size - 1) / cell_size;
+    if(cells > icon_view->priv->extents_overflow)
+        icon_view->priv->extents_overflow = MIN(cells, G_MAXINT16);
+}
+
 static gboolean
 xfdesktop_icon_view_update_icon_extents(XfdesktopIconView *icon_view,
                                         XfdesktopIcon *icon,
@@ -3061,6 +3403,8 @@ xfdesktop_icon_view_update_icon_extents(XfdesktopIconView *icon_view,
 
     xfdesktop_icon_set_extents(icon, pixbuf_extents, text_extents, total_extents);
 
+    xfdesktop_icon_view_update_extents_overflow(icon_view, icon, total_extents);
+
     return TRUE;
 }
 
@@ -3107,9 +3451,14 @@ xfdesktop_icon_view_draw_text(cairo_t *cr, PangoLayout *playout, GdkRectangle *t
     cairo_restore(cr);
 }
 
+/* Paints icon into drawable, whose top left corner is at x_origin, y_origin
+ * in root window coordinates.  Nothing outside area is touched. */
 static void
 xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
                                XfdesktopIcon *icon,
+                               GdkDrawable *drawable,
+                               gint x_origin,
+                               gint y_origin,
                                GdkRectangle *area)
 {
     GtkWidget *widget = GTK_WIDGET(icon_view);
@@ -3129,7 +3478,10 @@ xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
 
     playout = icon_view->priv->playout;
 
-    cr = gdk_cairo_create(GDK_DRAWABLE(gtk_widget_get_window(widget)));
+    cr = gdk_cairo_create(drawable);
+    cairo_translate(cr, -x_origin, -y_origin);
+    gdk_cairo_rectangle(cr, area);
+    cairo_clip(cr);
     
     if(!xfdesktop_icon_get_extents(icon, &pixbuf_extents,
                                    &text_extents, &total_extents))
@@ -3159,6 +3511,9 @@ xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
         GdkPixbuf *pix = xfdesktop_icon_peek_pixbuf(icon, ICON_WIDTH, ICON_SIZE);
         GdkPixbuf *pix_free = NULL;
 
+        if(xfdesktop_icon_has_scaled_pixbuf(icon))
+            xfdesktop_icon_view_queue_icon_settle(icon_view, icon);
+
         if(state != GTK_STATE_NORMAL) {
             pix_free = exo_gdk_pixbuf_colorize(pix, &gtk_widget_get_style(widget)->base[state]);
             pix = pix_free;
@@ -3191,7 +3546,9 @@ xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
     if(gdk_rectangle_intersect(area, &box_extents, &intersection)
        && icon_view->priv->font_size > 0)
     {
-        xfdesktop_paint_rounded_box(icon_view, state, &box_extents, area);
+        GdkRectangle layout_area = *area;
+
+        xfdesktop_paint_rounded_box(icon_view, cr, state, &box_extents, area);
 
         if (state == GTK_STATE_NORMAL) {
             x_offset = icon_view->priv->shadow_x_offset;
@@ -3219,9 +3576,12 @@ xfdesktop_icon_view_paint_icon(XfdesktopIconView *icon_view,
               text_extents.width, text_extents.height,
               text_extents.x, text_extents.y);
 
-        gtk_paint_layout(gtk_widget_get_style(widget), gtk_widget_get_window(widget),
-                         state, FALSE, area, widget, "label",
-                         text_extents.x, text_extents.y, playout);
+        layout_area.x -= x_origin;
+        layout_area.y -= y_origin;
+        gtk_paint_layout(gtk_widget_get_style(widget), drawable,
+                         state, FALSE, &layout_area, widget, "label",
+                         text_extents.x - x_origin, text_extents.y - y_origin,
+                         playout);
     }
 
 
@@ -3476,6 +3836,7 @@ xfdesktop_grid_do_resize(XfdesktopIconView *icon_view)
         xfdesktop_setup_grids (icon_view);
     }
 
+    xfdesktop_icon_view_damage_icon_layers(icon_view, NULL);
     gtk_widget_queue_draw(GTK_WIDGET(icon_view));
 }
 
@@ -3805,6 +4166,12 @@ xfdesktop_icon_view_new(XfdesktopIconViewManager *manager)
                            G_TYPE_DOUBLE,
                            G_OBJECT(icon_view),
                            "tooltip_size");
+
+    xfconf_g_property_bind(icon_view->priv->channel,
+                           "/desktop-icons/retained-layer",
+                           G_TYPE_BOOLEAN,
+                           G_OBJECT(icon_view),
+                           "retained_layer");
     
     return GTK_WIDGET(icon_view);
 }
@@ -3836,7 +4203,15 @@ xfdesktop_icon_view_add_item_internal(XfdesktopIconView *icon_view,
     fake_area.x = icon_view->priv->xorigin + icon_view->priv->xmargin + col * CELL_SIZE + col * icon_view->priv->xspacing;
     fake_area.y = icon_view->priv->yorigin + icon_view->priv->ymargin + row * CELL_SIZE + row * icon_view->priv->yspacing;
     fake_area.width = fake_area.height = CELL_SIZE;
-    xfdesktop_icon_view_paint_icon(icon_view, icon, &fake_area);
+
+    if(icon_view->priv->icon_layers) {
+        /* the layer gets repainted on the next expose */
+        xfdesktop_icon_view_invalidate_icon(icon_view, icon, TRUE);
+    } else {
+        xfdesktop_icon_view_paint_icon(icon_view, icon,
+                                       gtk_widget_get_window(GTK_WIDGET(icon_view)),
+                                       0, 0, &fake_area);
+    }
 }
 
 static gboolean
@@ -4261,6 +4636,99 @@ xfdesktop_icon_view_unselect_all(XfdesktopIconView *icon_view)
     }
 }
 
+static void
+xfdesktop_icon_view_cancel_icon_size_settle(XfdesktopIconView *icon_view)
+{
+    if(icon_view->priv->icon_size_settle_timeout) {
+        g_source_remove(icon_view->priv->icon_size_settle_timeout);
+        icon_view->priv->icon_size_settle_timeout = 0;
+    }
+
+    if(icon_view->priv->icon_size_settle_idle) {
+        g_source_remove(icon_view->priv->icon_size_settle_idle);
+        icon_view->priv->icon_size_settle_idle = 0;
+    }
+
+    g_queue_foreach(icon_view->priv->settle_icons, (GFunc)g_object_unref, NULL);
+    g_queue_clear(icon_view->priv->settle_icons);
+    g_hash_table_remove_all(icon_view->priv->settle_icon_set);
+}
+
+static void
+xfdesktop_icon_view_push_settle_icon(XfdesktopIconView *icon_view,
+                                     XfdesktopIcon *icon)
+{
+    if(g_hash_table_lookup(icon_view->priv->settle_icon_set, icon))
+        return;
+
+    g_hash_table_insert(icon_view->priv->settle_icon_set, icon, icon);
+    g_queue_push_tail(icon_view->priv->settle_icons, g_object_ref(icon));
+}
+
+/* reloads the scaled icons at their exact size, a few at a time */
+static gboolean
+xfdesktop_icon_view_settle_icons_idled(gpointer user_data)
+{
+    XfdesktopIconView *icon_view = XFDESKTOP_ICON_VIEW(user_data);
+    XfdesktopIcon *icon;
+    gint64 end_time = g_get_monotonic_time() + ICON_SIZE_SETTLE_SLICE_USEC;
+
+    while((icon = g_queue_pop_head(icon_view->priv->settle_icons))) {
+        g_hash_table_remove(icon_view->priv->settle_icon_set, icon);
+
+        if(xfdesktop_icon_peek_icon_view(icon) == GTK_WIDGET(icon_view))
+            xfdesktop_icon_settle_pixbuf(icon);
+        g_object_unref(G_OBJECT(icon));
+
+        if(g_get_monotonic_time() >= end_time)
+            return TRUE;
+    }
+
+    icon_view->priv->icon_size_settle_idle = 0;
+
+    return FALSE;
+}
+
+static gboolean
+xfdesktop_icon_view_icon_size_settle_timeout(gpointer user_data)
+{
+    XfdesktopIconView *icon_view = XFDESKTOP_ICON_VIEW(user_data);
+    GList *l;
+
+    icon_view->priv->icon_size_settle_timeout = 0;
+
+    for(l = icon_view->priv->icons; l; l = l->next) {
+        if(xfdesktop_icon_has_scaled_pixbuf(l->data))
+            xfdesktop_icon_view_push_settle_icon(icon_view, l->data);
+    }
+
+    if(!g_queue_is_empty(icon_view->priv->settle_icons)
+       && !icon_view->priv->icon_size_settle_idle)
+    {
+        icon_view->priv->icon_size_settle_idle = g_idle_add(xfdesktop_icon_view_settle_icons_idled,
+                                                            icon_view);
+    }
+
+    return FALSE;
+}
+
+/* for icons that only got painted after the size settled, e.g. because they
+ * were still pending while the size changed */
+static void
+xfdesktop_icon_view_queue_icon_settle(XfdesktopIconView *icon_view,
+                                      XfdesktopIcon *icon)
+{
+    if(icon_view->priv->icon_size_settle_timeout)
+        return;
+
+    xfdesktop_icon_view_push_settle_icon(icon_view, icon);
+
+    if(!icon_view->priv->icon_size_settle_idle) {
+        icon_view->priv->icon_size_settle_idle = g_idle_add(xfdesktop_icon_view_settle_icons_idled,
+                                                            icon_view);
+    }
+}
+
 void
 xfdesktop_icon_view_set_icon_size(XfdesktopIconView *icon_view,
                                   guint icon_size)
@@ -4273,7 +4741,15 @@ xfdesktop_icon_view_set_icon_size(XfdesktopIconView *icon_view,
     icon_view->priv->icon_size = icon_size;
     
     if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
+        /* icons get drawn with a scaled copy of their current pixbuf until
+         * the size stops changing */
+        xfdesktop_icon_view_cancel_icon_size_settle(icon_view);
+        icon_view->priv->icon_size_settle_timeout = g_timeout_add(ICON_SIZE_SETTLE_DELAY,
+                                                                  xfdesktop_icon_view_icon_size_settle_timeout,
+                                                                  icon_view);
+
         xfdesktop_grid_do_resize(icon_view);
+        xfdesktop_icon_view_damage_icon_layers(icon_view, NULL);
         gtk_widget_queue_draw(GTK_WIDGET(icon_view));
     }
 }
@@ -4285,6 +4761,14 @@ xfdesktop_icon_view_get_icon_size(XfdesktopIconView *icon_view)
     return icon_view->priv->icon_size;
 }
 
+/* Number of icons the last expose repainted, for debugging and testing */
+guint
+xfdesktop_icon_view_get_n_repainted_icons(XfdesktopIconView *icon_view)
+{
+    g_return_val_if_fail(XFDESKTOP_IS_ICON_VIEW(icon_view), 0);
+    return icon_view->priv->n_repainted_icons;
+}
+
 void
 xfdesktop_icon_view_set_font_size(XfdesktopIconView *icon_view,
                                   gdouble font_size_points)
@@ -4299,6 +4783,7 @@ xfdesktop_icon_view_set_font_size(XfdesktopIconView *icon_view,
     if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
         xfdesktop_icon_view_modify_font_size(icon_view, font_size_points);
         xfdesktop_grid_do_resize(icon_view);
+        xfdesktop_icon_view_damage_icon_layers(icon_view, NULL);
         gtk_widget_queue_draw(GTK_WIDGET(icon_view));
     }
 }
@@ -4322,6 +4807,7 @@ xfdesktop_icon_view_set_center_text (XfdesktopIconView *icon_view,
     icon_view->priv->center_text = center_text;
     
     if(gtk_widget_get_realized(GTK_WIDGET(icon_view))) {
+        xfdesktop_icon_view_damage_icon_layers(icon_view, NULL);
         gtk_widget_queue_draw(GTK_WIDGET(icon_view));
     }
 }
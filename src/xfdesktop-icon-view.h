@@ -113,6 +113,7 @@ void xfdesktop_icon_view_unselect_all(XfdesktopIconView *icon_view);
 void xfdesktop_icon_view_set_icon_size(XfdesktopIconView *icon_view,
                                        guint icon_size);
 guint xfdesktop_icon_view_get_icon_size(XfdesktopIconView *icon_view);
+guint xfdesktop_icon_view_get_n_repainted_icons(XfdesktopIconView *icon_view);
 
 void xfdesktop_icon_view_set_font_size(XfdesktopIconView *icon_view,
                                        gdouble font_size_points);
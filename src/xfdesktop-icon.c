@@ -43,6 +43,11 @@ struct _XfdesktopIconPrivate
 
     GdkPixbuf *pix, *tooltip_pix;
     gint cur_pix_width, cur_pix_height;
+
+    /* the largest pixbuf loaded at its exact size, used to quickly scale a
+     * stand-in while the icon size is being changed */
+    GdkPixbuf *source_pix;
+    gboolean pix_is_scaled;
     gint cur_tooltip_pix_width, cur_tooltip_pix_height;
 };
 
@@ -192,6 +197,46 @@ xfdesktop_icon_get_extents(XfdesktopIcon *icon,
     return TRUE;
 }
 
+/* remembers @pix as the source for scaled stand-ins, unless we already
+ * have a larger image of the same icon */
+static void
+xfdesktop_icon_update_source_pixbuf(XfdesktopIcon *icon,
+                                    GdkPixbuf *pix,
+                                    gboolean keep_larger)
+{
+    if(icon->priv->source_pix) {
+        if(keep_larger && pix
+           && gdk_pixbuf_get_width(icon->priv->source_pix) > gdk_pixbuf_get_width(pix)
+           && gdk_pixbuf_get_height(icon->priv->source_pix) > gdk_pixbuf_get_height(pix))
+        {
+            return;
+        }
+
+        g_object_unref(G_OBJECT(icon->priv->source_pix));
+        icon->priv->source_pix = NULL;
+    }
+
+    if(pix)
+        icon->priv->source_pix = g_object_ref(G_OBJECT(pix));
+}
+
+/* a cheap rescale of the source pixbuf to fit into width x height */
+static GdkPixbuf *
+xfdesktop_icon_scale_source_pixbuf(XfdesktopIcon *icon,
+                                   gint width, gint height)
+{
+    gint src_width = gdk_pixbuf_get_width(icon->priv->source_pix);
+    gint src_height = gdk_pixbuf_get_height(icon->priv->source_pix);
+    gdouble scale;
+
+    scale = MIN((gdouble)width / src_width, (gdouble)height / src_height);
+
+    return gdk_pixbuf_scale_simple(icon->priv->source_pix,
+                                   MAX(1, (gint)(src_width * scale + 0.5)),
+                                   MAX(1, (gint)(src_height * scale + 0.5)),
+                                   GDK_INTERP_BILINEAR);
+}
+
 /*< required >*/
 GdkPixbuf *
 xfdesktop_icon_peek_pixbuf(XfdesktopIcon *icon,
@@ -203,8 +248,21 @@ xfdesktop_icon_peek_pixbuf(XfdesktopIcon *icon,
     klass = XFDESKTOP_ICON_GET_CLASS(icon);
     g_return_val_if_fail(klass->peek_pixbuf, NULL);
 
-    if(width != icon->priv->cur_pix_width || height != icon->priv->cur_pix_height)
-        xfdesktop_icon_invalidate_regular_pixbuf(icon);
+    if(width != icon->priv->cur_pix_width || height != icon->priv->cur_pix_height) {
+        if(icon->priv->source_pix) {
+            /* The size is changing, scale what we have for now and let
+             * xfdesktop_icon_settle_pixbuf() load the exact size once the
+             * size stops changing */
+            if(icon->priv->pix)
+                g_object_unref(G_OBJECT(icon->priv->pix));
+
+            icon->priv->cur_pix_width = width;
+            icon->priv->cur_pix_height = height;
+            icon->priv->pix = xfdesktop_icon_scale_source_pixbuf(icon, width, height);
+            icon->priv->pix_is_scaled = TRUE;
+        } else
+            xfdesktop_icon_invalidate_regular_pixbuf(icon);
+    }
 
     if(icon->priv->pix == NULL) {
         icon->priv->cur_pix_width = width;
@@ -212,6 +270,8 @@ xfdesktop_icon_peek_pixbuf(XfdesktopIcon *icon,
 
         /* Generate a new pixbuf */
         icon->priv->pix = klass->peek_pixbuf(icon, width, height);
+        icon->priv->pix_is_scaled = FALSE;
+        xfdesktop_icon_update_source_pixbuf(icon, icon->priv->pix, FALSE);
     }
 
     return icon->priv->pix;
@@ -401,6 +461,9 @@ xfdesktop_icon_invalidate_regular_pixbuf(XfdesktopIcon *icon)
         g_object_unref(G_OBJECT(icon->priv->pix));
         icon->priv->pix = NULL;
     }
+
+    xfdesktop_icon_update_source_pixbuf(icon, NULL, FALSE);
+    icon->priv->pix_is_scaled = FALSE;
 }
 
 void
@@ -419,6 +482,64 @@ xfdesktop_icon_invalidate_pixbuf(XfdesktopIcon *icon)
     xfdesktop_icon_invalidate_tooltip_pixbuf(icon);
 }
 
+/* Regenerates the pixbuf at its current size.  Unlike invalidating it, the
+ * old pixbuf stays in place until the new one has been created, so the
+ * icon never has to be painted without an image.  Icons that don't have a
+ * pixbuf yet are left alone, they'll be loaded when they're first drawn. */
+static void
+xfdesktop_icon_regenerate_pixbuf(XfdesktopIcon *icon,
+                                 gboolean same_image)
+{
+    XfdesktopIconClass *klass = XFDESKTOP_ICON_GET_CLASS(icon);
+    GdkPixbuf *pix;
+
+    g_return_if_fail(klass->peek_pixbuf);
+
+    pix = klass->peek_pixbuf(icon, icon->priv->cur_pix_width,
+                             icon->priv->cur_pix_height);
+
+    g_object_unref(G_OBJECT(icon->priv->pix));
+    icon->priv->pix = pix;
+    icon->priv->pix_is_scaled = FALSE;
+    xfdesktop_icon_update_source_pixbuf(icon, pix, same_image);
+
+    xfdesktop_icon_pixbuf_changed(icon);
+}
+
+void
+xfdesktop_icon_reload_pixbuf(XfdesktopIcon *icon)
+{
+    g_return_if_fail(XFDESKTOP_IS_ICON(icon));
+
+    xfdesktop_icon_invalidate_tooltip_pixbuf(icon);
+
+    if(icon->priv->pix == NULL)
+        return;
+
+    xfdesktop_icon_regenerate_pixbuf(icon, FALSE);
+}
+
+gboolean
+xfdesktop_icon_has_scaled_pixbuf(XfdesktopIcon *icon)
+{
+    g_return_val_if_fail(XFDESKTOP_IS_ICON(icon), FALSE);
+
+    return icon->priv->pix != NULL && icon->priv->pix_is_scaled;
+}
+
+/* Replaces a scaled stand-in (see xfdesktop_icon_peek_pixbuf()) with a
+ * pixbuf loaded at the exact size.  Call this once the icon size settled. */
+void
+xfdesktop_icon_settle_pixbuf(XfdesktopIcon *icon)
+{
+    g_return_if_fail(XFDESKTOP_IS_ICON(icon));
+
+    if(icon->priv->pix == NULL || !icon->priv->pix_is_scaled)
+        return;
+
+    xfdesktop_icon_regenerate_pixbuf(icon, TRUE);
+}
+
 /*< signal triggers >*/
 
 void
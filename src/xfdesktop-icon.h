@@ -125,6 +125,9 @@ void xfdesktop_icon_delete_thumbnail(XfdesktopIcon *icon);
 void xfdesktop_icon_invalidate_regular_pixbuf(XfdesktopIcon *icon);
 void xfdesktop_icon_invalidate_tooltip_pixbuf(XfdesktopIcon *icon);
 void xfdesktop_icon_invalidate_pixbuf(XfdesktopIcon *icon);
+void xfdesktop_icon_reload_pixbuf(XfdesktopIcon *icon);
+gboolean xfdesktop_icon_has_scaled_pixbuf(XfdesktopIcon *icon);
+void xfdesktop_icon_settle_pixbuf(XfdesktopIcon *icon);
 
 /*< signal triggers >*/
 
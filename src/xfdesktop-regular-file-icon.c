@@ -70,8 +70,31 @@ struct _XfdesktopRegularFileIconPrivate
     GdkScreen *gscreen;
     XfdesktopFileIconManager *fmanager;
     gboolean show_thumbnails;
+
+    /* images that have to be decoded are loaded in a worker thread */
+    GCancellable *decode_cancellable;
+    GdkPixbuf *decoded_pix;
+    gint decoded_width, decoded_height;
+    gboolean decode_failed;
+
+    /* same for the larger tooltip image */
+    GCancellable *tooltip_decode_cancellable;
+    GdkPixbuf *tooltip_decoded_pix;
+    gint tooltip_decoded_width, tooltip_decoded_height;
+    gboolean tooltip_decode_failed;
+
+    /* .desktop files are parsed asynchronously and shared via a cache */
+    XfdesktopLauncherInfo *launcher_info;
+    GCancellable *launcher_cancellable;
 };
 
+/* an outstanding decode or launcher parse, icon is a weak pointer */
+typedef struct
+{
+    XfdesktopRegularFileIcon *icon;
+    GCancellable *cancellable;
+} XfdesktopIconDecodeRequest;
+
 static void xfdesktop_regular_file_icon_finalize(GObject *obj);
 
 static void xfdesktop_regular_file_icon_set_thumbnail_file(XfdesktopIcon *icon, GFile *file);
@@ -98,6 +121,12 @@ static void xfdesktop_regular_file_icon_update_file_info(XfdesktopFileIcon *icon
                                                          GFileInfo *info);
 static gboolean xfdesktop_regular_file_can_write_parent(XfdesktopFileIcon *icon);
 
+static void xfdesktop_regular_file_icon_cancel_decode(XfdesktopRegularFileIcon *icon);
+static void xfdesktop_regular_file_icon_cancel_tooltip_decode(XfdesktopRegularFileIcon *icon);
+static void xfdesktop_regular_file_icon_cancel_launcher_load(XfdesktopRegularFileIcon *icon);
+static void xfdesktop_regular_file_icon_update_launcher_info(XfdesktopRegularFileIcon *icon);
+static gchar *xfdesktop_regular_file_icon_get_display_name(XfdesktopRegularFileIcon *icon);
+
 #ifdef HAVE_THUNARX
 static void xfdesktop_regular_file_icon_tfi_init(ThunarxFileInfoIface *iface);
 
@@ -157,11 +186,13 @@ static void
 xfdesktop_regular_file_icon_finalize(GObject *obj)
 {
     XfdesktopRegularFileIcon *icon = XFDESKTOP_REGULAR_FILE_ICON(obj);
-    GtkIconTheme *itheme = gtk_icon_theme_get_for_screen(icon->priv->gscreen);
-    
-    g_signal_handlers_disconnect_by_func(G_OBJECT(itheme),
-                                         G_CALLBACK(xfdesktop_icon_invalidate_pixbuf),
-                                         icon);
+
+    xfdesktop_regular_file_icon_cancel_decode(icon);
+    xfdesktop_regular_file_icon_cancel_tooltip_decode(icon);
+    xfdesktop_regular_file_icon_cancel_launcher_load(icon);
+
+    if(icon->priv->launcher_info)
+        xfdesktop_launcher_info_unref(icon->priv->launcher_info);
     
     if(icon->priv->file_info)
         g_object_unref(icon->priv->file_info);
@@ -217,6 +248,8 @@ xfdesktop_regular_file_icon_delete_thumbnail_file(XfdesktopIcon *icon)
         file_icon->priv->thumbnail_file = NULL;
     }
 
+    xfdesktop_regular_file_icon_cancel_decode(file_icon);
+    xfdesktop_regular_file_icon_cancel_tooltip_decode(file_icon);
     xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(icon));
 
     xfdesktop_icon_invalidate_pixbuf(icon);
@@ -238,6 +271,8 @@ xfdesktop_regular_file_icon_set_thumbnail_file(XfdesktopIcon *icon, GFile *file)
 
     file_icon->priv->thumbnail_file = file;
 
+    xfdesktop_regular_file_icon_cancel_decode(file_icon);
+    xfdesktop_regular_file_icon_cancel_tooltip_decode(file_icon);
     xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(icon));
 
     xfdesktop_icon_invalidate_pixbuf(icon);
@@ -265,6 +300,8 @@ cb_show_thumbnails_notify(GObject *gobject,
     if(regular_file_icon->priv->show_thumbnails != show_thumbnails) {
         XF_DEBUG("show-thumbnails changed! now: %s", show_thumbnails ? "TRUE" : "FALSE");
         regular_file_icon->priv->show_thumbnails = show_thumbnails;
+        xfdesktop_regular_file_icon_cancel_decode(regular_file_icon);
+        xfdesktop_regular_file_icon_cancel_tooltip_decode(regular_file_icon);
         xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(regular_file_icon));
         xfdesktop_icon_invalidate_pixbuf(XFDESKTOP_ICON(regular_file_icon));
         xfdesktop_icon_pixbuf_changed(XFDESKTOP_ICON(regular_file_icon));
@@ -364,42 +401,24 @@ xfdesktop_load_icon_location_from_folder(XfdesktopFileIcon *icon)
 static GIcon *
 xfdesktop_load_icon_from_desktop_file(XfdesktopRegularFileIcon *regular_icon)
 {
-    gchar *contents, *icon_name;
-    gsize length;
+    const gchar *icon_name;
     GIcon *gicon = NULL;
     gchar *p;
-    GKeyFile *key_file;
-
-    /* try to load the file into memory */
-    if(!g_file_load_contents(regular_icon->priv->file, NULL, &contents, &length, NULL, NULL))
-        return NULL;
-
-    /* allocate a new key file */
-    key_file = g_key_file_new();
 
-    /* try to parse the key file from the contents of the file */
-    if(!g_key_file_load_from_data(key_file, contents, length, 0, NULL)) {
-        g_free(contents);
+    /* not parsed yet, or no icon name in the desktop file */
+    if(!regular_icon->priv->launcher_info
+       || !regular_icon->priv->launcher_info->icon)
+    {
         return NULL;
     }
 
-    /* try to determine the custom icon name */
-    icon_name = g_key_file_get_string(key_file,
-                                      G_KEY_FILE_DESKTOP_GROUP,
-                                      G_KEY_FILE_DESKTOP_KEY_ICON,
-                                      NULL);
-
-    /* No icon name in the desktop file */
-    if(icon_name == NULL) {
-        /* free key file and in-memory data */
-        g_key_file_free(key_file);
-        g_free(contents);
-        return NULL;
-    }
+    icon_name = regular_icon->priv->launcher_info->icon;
 
     /* icon_name is an absolute path, create it as a file icon */
     if(g_file_test(icon_name, G_FILE_TEST_IS_REGULAR)) {
-        gicon = g_file_icon_new(g_file_new_for_path(icon_name));
+        GFile *file = g_file_new_for_path(icon_name);
+        gicon = g_file_icon_new(file);
+        g_object_unref(file);
     }
 
     /* check if the icon theme includes the icon name as-is */
@@ -434,18 +453,16 @@ xfdesktop_load_icon_from_desktop_file(XfdesktopRegularFileIcon *regular_icon)
         if(filename)
             tmp_name = xfce_resource_lookup(XFCE_RESOURCE_DATA, filename);
 
-        if(tmp_name)
-            gicon = g_file_icon_new(g_file_new_for_path(tmp_name));
+        if(tmp_name) {
+            GFile *file = g_file_new_for_path(tmp_name);
+            gicon = g_file_icon_new(file);
+            g_object_unref(file);
+        }
 
         g_free(filename);
         g_free(tmp_name);
     }
 
-    /* free key file and in-memory data */
-    g_key_file_free(key_file);
-    g_free(contents);
-    g_free(icon_name);
-
     return gicon;
 }
 
@@ -534,6 +551,142 @@ xfdesktop_regular_file_icon_load_icon(XfdesktopIcon *icon)
     return gicon;
 }
 
+/* drops the decoded image and abandons any decode that's still running */
+static void
+xfdesktop_regular_file_icon_cancel_decode(XfdesktopRegularFileIcon *icon)
+{
+    if(icon->priv->decode_cancellable) {
+        g_cancellable_cancel(icon->priv->decode_cancellable);
+        g_object_unref(icon->priv->decode_cancellable);
+        icon->priv->decode_cancellable = NULL;
+    }
+
+    if(icon->priv->decoded_pix) {
+        g_object_unref(icon->priv->decoded_pix);
+        icon->priv->decoded_pix = NULL;
+    }
+
+    icon->priv->decoded_width = icon->priv->decoded_height = 0;
+    icon->priv->decode_failed = FALSE;
+}
+
+static void
+xfdesktop_regular_file_icon_cancel_tooltip_decode(XfdesktopRegularFileIcon *icon)
+{
+    if(icon->priv->tooltip_decode_cancellable) {
+        g_cancellable_cancel(icon->priv->tooltip_decode_cancellable);
+        g_object_unref(icon->priv->tooltip_decode_cancellable);
+        icon->priv->tooltip_decode_cancellable = NULL;
+    }
+
+    if(icon->priv->tooltip_decoded_pix) {
+        g_object_unref(icon->priv->tooltip_decoded_pix);
+        icon->priv->tooltip_decoded_pix = NULL;
+    }
+
+    icon->priv->tooltip_decoded_width = icon->priv->tooltip_decoded_height = 0;
+    icon->priv->tooltip_decode_failed = FALSE;
+}
+
+static void
+xfdesktop_regular_file_icon_decode_ready(GObject *source_object,
+                                         GAsyncResult *result,
+                                         gpointer user_data)
+{
+    XfdesktopIconDecodeRequest *request = user_data;
+    XfdesktopRegularFileIcon *icon = request->icon;
+    GdkPixbuf *pix;
+
+    pix = xfdesktop_file_utils_decode_icon_finish(result);
+
+    if(icon)
+        g_object_remove_weak_pointer(G_OBJECT(icon), (gpointer *)&request->icon);
+
+    /* the icon went away, got resized or changed its image meanwhile */
+    if(!icon || g_cancellable_is_cancelled(request->cancellable)) {
+        if(pix)
+            g_object_unref(pix);
+        g_object_unref(request->cancellable);
+        g_slice_free(XfdesktopIconDecodeRequest, request);
+        return;
+    }
+
+    g_object_unref(icon->priv->decode_cancellable);
+    icon->priv->decode_cancellable = NULL;
+
+    icon->priv->decoded_pix = pix;
+    icon->priv->decode_failed = (pix == NULL);
+
+    g_object_unref(request->cancellable);
+    g_slice_free(XfdesktopIconDecodeRequest, request);
+
+    /* replace the placeholder */
+    xfdesktop_icon_invalidate_regular_pixbuf(XFDESKTOP_ICON(icon));
+    xfdesktop_icon_pixbuf_changed(XFDESKTOP_ICON(icon));
+}
+
+static GdkPixbuf *
+xfdesktop_regular_file_icon_get_decoded_pixbuf(XfdesktopRegularFileIcon *regular_icon,
+                                               GIcon *gicon,
+                                               gint width, gint height)
+{
+    XfdesktopIconDecodeRequest *request;
+    GIcon *placeholder;
+    GdkPixbuf *previous_pix = NULL, *pix;
+
+    /* the icon got resized, decode the image again at the new size */
+    if(width != regular_icon->priv->decoded_width
+       || height != regular_icon->priv->decoded_height)
+    {
+        if(regular_icon->priv->decoded_pix)
+            previous_pix = g_object_ref(regular_icon->priv->decoded_pix);
+        xfdesktop_regular_file_icon_cancel_decode(regular_icon);
+    }
+
+    if(regular_icon->priv->decoded_pix) {
+        return xfdesktop_file_utils_compose_icon(gicon,
+                                                 regular_icon->priv->decoded_pix,
+                                                 regular_icon->priv->pix_opacity);
+    }
+
+    if(!regular_icon->priv->decode_cancellable && !regular_icon->priv->decode_failed) {
+        regular_icon->priv->decoded_width = width;
+        regular_icon->priv->decoded_height = height;
+        regular_icon->priv->decode_cancellable = g_cancellable_new();
+
+        request = g_slice_new(XfdesktopIconDecodeRequest);
+        request->icon = regular_icon;
+        request->cancellable = g_object_ref(regular_icon->priv->decode_cancellable);
+        g_object_add_weak_pointer(G_OBJECT(regular_icon), (gpointer *)&request->icon);
+
+        xfdesktop_file_utils_decode_icon_async(gicon, width, height,
+                                               request->cancellable,
+                                               xfdesktop_regular_file_icon_decode_ready,
+                                               request);
+    }
+
+    /* scale the image we had for the old size until the new one is ready */
+    if(previous_pix) {
+        GdkPixbuf *scaled = exo_gdk_pixbuf_scale_ratio(previous_pix, MIN(width, height));
+
+        pix = xfdesktop_file_utils_compose_icon(gicon, scaled,
+                                                regular_icon->priv->pix_opacity);
+        g_object_unref(scaled);
+        g_object_unref(previous_pix);
+
+        return pix;
+    }
+
+    /* show the mime type icon until the image is ready (or if it can't be
+     * loaded at all) */
+    placeholder = g_file_info_get_icon(regular_icon->priv->file_info);
+    if(!G_IS_ICON(placeholder))
+        return xfdesktop_file_utils_get_fallback_icon(MIN(width, height));
+
+    return xfdesktop_file_utils_get_icon(placeholder, width, height,
+                                         regular_icon->priv->pix_opacity);
+}
+
 static GdkPixbuf *
 xfdesktop_regular_file_icon_peek_pixbuf(XfdesktopIcon *icon,
                                         gint width, gint height)
@@ -547,17 +700,62 @@ xfdesktop_regular_file_icon_peek_pixbuf(XfdesktopIcon *icon,
     else
         g_object_get(XFDESKTOP_FILE_ICON(icon), "gicon", &gicon, NULL);
 
+    /* thumbnails and other images are decoded off the main loop */
+    if(xfdesktop_file_utils_icon_needs_decoding(gicon)) {
+        return xfdesktop_regular_file_icon_get_decoded_pixbuf(regular_icon, gicon,
+                                                              width, height);
+    }
+
     pix = xfdesktop_file_utils_get_icon(gicon, width, height,
                                         regular_icon->priv->pix_opacity);
 
     return pix;
 }
 
+static void
+xfdesktop_regular_file_icon_tooltip_decode_ready(GObject *source_object,
+                                                 GAsyncResult *result,
+                                                 gpointer user_data)
+{
+    XfdesktopIconDecodeRequest *request = user_data;
+    XfdesktopRegularFileIcon *icon = request->icon;
+    GdkPixbuf *pix;
+
+    pix = xfdesktop_file_utils_decode_icon_finish(result);
+
+    if(icon)
+        g_object_remove_weak_pointer(G_OBJECT(icon), (gpointer *)&request->icon);
+
+    if(!icon || g_cancellable_is_cancelled(request->cancellable)) {
+        if(pix)
+            g_object_unref(pix);
+        g_object_unref(request->cancellable);
+        g_slice_free(XfdesktopIconDecodeRequest, request);
+        return;
+    }
+
+    g_object_unref(icon->priv->tooltip_decode_cancellable);
+    icon->priv->tooltip_decode_cancellable = NULL;
+
+    icon->priv->tooltip_decoded_pix = pix;
+    icon->priv->tooltip_decode_failed = (pix == NULL);
+
+    g_object_unref(request->cancellable);
+    g_slice_free(XfdesktopIconDecodeRequest, request);
+
+    /* if the tooltip is still up, have it show the image now */
+    xfdesktop_icon_invalidate_tooltip_pixbuf(XFDESKTOP_ICON(icon));
+    if(icon->priv->gscreen)
+        gtk_tooltip_trigger_tooltip_query(gdk_screen_get_display(icon->priv->gscreen));
+}
+
 static GdkPixbuf *
 xfdesktop_regular_file_icon_peek_tooltip_pixbuf(XfdesktopIcon *icon,
                                                 gint width, gint height)
 {
-    GIcon *gicon = NULL;
+    XfdesktopRegularFileIcon *regular_icon = XFDESKTOP_REGULAR_FILE_ICON(icon);
+    XfdesktopIconDecodeRequest *request;
+    GIcon *gicon = NULL, *placeholder;
     GdkPixbuf *tooltip_pix = NULL;
 
     if(!xfdesktop_file_icon_has_gicon(XFDESKTOP_FILE_ICON(icon)))
@@ -565,9 +763,57 @@ xfdesktop_regular_file_icon_peek_tooltip_pixbuf(XfdesktopIcon *icon,
     else
         g_object_get(XFDESKTOP_FILE_ICON(icon), "gicon", &gicon, NULL);
 
-    tooltip_pix = xfdesktop_file_utils_get_icon(gicon, width, height, 100);
+    /* don't block the hover on decoding a large image */
+    if(!xfdesktop_file_utils_icon_needs_decoding(gicon))
+        return xfdesktop_file_utils_get_icon(gicon, width, height, 100);
+
+    if(width != regular_icon->priv->tooltip_decoded_width
+       || height != regular_icon->priv->tooltip_decoded_height)
+    {
+        xfdesktop_regular_file_icon_cancel_tooltip_decode(regular_icon);
+    }
+
+    if(regular_icon->priv->tooltip_decoded_pix) {
+        return xfdesktop_file_utils_compose_icon(gicon,
+                                                 regular_icon->priv->tooltip_decoded_pix,
+                                                 100);
+    }
+
+    if(!regular_icon->priv->tooltip_decode_cancellable
+       && !regular_icon->priv->tooltip_decode_failed)
+    {
+        regular_icon->priv->tooltip_decoded_width = width;
+        regular_icon->priv->tooltip_decoded_height = height;
+        regular_icon->priv->tooltip_decode_cancellable = g_cancellable_new();
+
+        request = g_slice_new(XfdesktopIconDecodeRequest);
+        request->icon = regular_icon;
+        request->cancellable = g_object_ref(regular_icon->priv->tooltip_decode_cancellable);
+        g_object_add_weak_pointer(G_OBJECT(regular_icon), (gpointer *)&request->icon);
+
+        xfdesktop_file_utils_decode_icon_async(gicon, width, height,
+                                               request->cancellable,
+                                               xfdesktop_regular_file_icon_tooltip_decode_ready,
+                                               request);
+    }
+
+    /* until then show the small image if there is one, else the mime type
+     * icon */
+    if(regular_icon->priv->decoded_pix) {
+        GdkPixbuf *scaled = exo_gdk_pixbuf_scale_ratio(regular_icon->priv->decoded_pix,
+                                                       MIN(width, height));
+
+        tooltip_pix = xfdesktop_file_utils_compose_icon(gicon, scaled, 100);
+        g_object_unref(scaled);
+
+        return tooltip_pix;
+    }
+
+    placeholder = g_file_info_get_icon(regular_icon->priv->file_info);
+    if(!G_IS_ICON(placeholder))
+        return xfdesktop_file_utils_get_fallback_icon(MIN(width, height));
 
-    return tooltip_pix;
+    return xfdesktop_file_utils_get_icon(placeholder, width, height, 100);
 }
 
 static const gchar *
@@ -635,6 +881,7 @@ static GdkDragAction
 xfdesktop_regular_file_icon_get_allowed_drop_actions(XfdesktopIcon *icon,
                                                      GdkDragAction *suggested_action)
 {
+    XfdesktopRegularFileIcon *regular_file_icon = XFDESKTOP_REGULAR_FILE_ICON(icon);
     GFileInfo *info = xfdesktop_file_icon_peek_file_info(XFDESKTOP_FILE_ICON(icon));
     
     if(!info) {
@@ -652,7 +899,11 @@ xfdesktop_regular_file_icon_get_allowed_drop_actions(XfdesktopIcon *icon,
             return GDK_ACTION_MOVE | GDK_ACTION_COPY | GDK_ACTION_LINK | GDK_ACTION_ASK;
         }
     } else {
-        if(xfdesktop_file_utils_file_is_executable(info)) {
+        /* launchers without anything to run can't take files either */
+        if(xfdesktop_file_utils_file_is_executable(info)
+           && (!regular_file_icon->priv->launcher_info
+               || regular_file_icon->priv->launcher_info->exec_valid))
+        {
             if(suggested_action)
                 *suggested_action = GDK_ACTION_COPY;
             return GDK_ACTION_COPY;
@@ -786,27 +1037,17 @@ xfdesktop_regular_file_icon_peek_tooltip(XfdesktopIcon *icon)
             g_strdup_printf(_("Type: %s\nSize: %s\nLast modified: %s"),
                             description, size_string, time_string);
 
-        /* Extract the Comment entry from the .desktop file */
-        if(is_desktop_file)
-        {
-            gchar *path = g_file_get_path(regular_file_icon->priv->file);
-            XfceRc *rcfile = xfce_rc_simple_open(path, TRUE);
-            g_free(path);
-
-            if(rcfile) {
-                xfce_rc_set_group(rcfile, "Desktop Entry");
-                comment = xfce_rc_read_entry(rcfile, "Comment", NULL);
-            }
-            /* Prepend the comment to the tooltip */
-            if(comment != NULL && *comment != '\0') {
-                gchar *tooltip = regular_file_icon->priv->tooltip;
-                regular_file_icon->priv->tooltip = g_strdup_printf("%s\n%s",
-                                                                   comment,
-                                                                   tooltip);
-                g_free(tooltip);
-            }
-
-            xfce_rc_close(rcfile);
+        /* Use the Comment entry of the parsed .desktop file */
+        if(is_desktop_file && regular_file_icon->priv->launcher_info)
+            comment = regular_file_icon->priv->launcher_info->comment;
+
+        /* Prepend the comment to the tooltip */
+        if(comment != NULL && *comment != '\0') {
+            gchar *tooltip = regular_file_icon->priv->tooltip;
+            regular_file_icon->priv->tooltip = g_strdup_printf("%s\n%s",
+                                                               comment,
+                                                               tooltip);
+            g_free(tooltip);
         }
 
         g_free(time_string);
@@ -896,10 +1137,12 @@ xfdesktop_regular_file_icon_update_file_info(XfdesktopFileIcon *icon,
                                                                             XFDESKTOP_FILESYSTEM_INFO_NAMESPACE,
                                                                             NULL, NULL);
 
+    /* re-parse the launcher if it was modified */
+    xfdesktop_regular_file_icon_update_launcher_info(regular_file_icon);
+
     /* get both, old and new display name */
     old_display_name = regular_file_icon->priv->display_name;
-    new_display_name = xfdesktop_file_utils_get_display_name(regular_file_icon->priv->file,
-                                                             regular_file_icon->priv->file_info);
+    new_display_name = xfdesktop_regular_file_icon_get_display_name(regular_file_icon);
 
     /* check whether the display name has changed with the info update */
     if(g_strcmp0 (old_display_name, new_display_name) != 0) {
@@ -919,11 +1162,129 @@ xfdesktop_regular_file_icon_update_file_info(XfdesktopFileIcon *icon,
     regular_file_icon->priv->tooltip = NULL;
     
     /* not really easy to check if this changed or not, so just invalidate it */
+    xfdesktop_regular_file_icon_cancel_decode(regular_file_icon);
+    xfdesktop_regular_file_icon_cancel_tooltip_decode(regular_file_icon);
     xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(icon));
     xfdesktop_icon_invalidate_pixbuf(XFDESKTOP_ICON(icon));
     xfdesktop_icon_pixbuf_changed(XFDESKTOP_ICON(icon));
 }
 
+/* launchers are labelled by their Name key, everything else by file name */
+static gchar *
+xfdesktop_regular_file_icon_get_display_name(XfdesktopRegularFileIcon *icon)
+{
+    if(icon->priv->launcher_info && icon->priv->launcher_info->name)
+        return g_strdup(icon->priv->launcher_info->name);
+
+    return g_strdup(g_file_info_get_display_name(icon->priv->file_info));
+}
+
+static void
+xfdesktop_regular_file_icon_cancel_launcher_load(XfdesktopRegularFileIcon *icon)
+{
+    if(icon->priv->launcher_cancellable) {
+        g_cancellable_cancel(icon->priv->launcher_cancellable);
+        g_object_unref(icon->priv->launcher_cancellable);
+        icon->priv->launcher_cancellable = NULL;
+    }
+}
+
+static void
+xfdesktop_regular_file_icon_launcher_ready(GObject *source_object,
+                                           GAsyncResult *result,
+                                           gpointer user_data)
+{
+    XfdesktopIconDecodeRequest *request = user_data;
+    XfdesktopRegularFileIcon *icon = request->icon;
+    XfdesktopLauncherInfo *launcher_info;
+    gchar *new_display_name;
+
+    launcher_info = xfdesktop_file_utils_load_launcher_info_finish(result);
+
+    if(icon)
+        g_object_remove_weak_pointer(G_OBJECT(icon), (gpointer *)&request->icon);
+
+    /* the icon went away or the file changed again meanwhile */
+    if(!icon || g_cancellable_is_cancelled(request->cancellable)) {
+        if(launcher_info)
+            xfdesktop_launcher_info_unref(launcher_info);
+        g_object_unref(request->cancellable);
+        g_slice_free(XfdesktopIconDecodeRequest, request);
+        return;
+    }
+
+    g_object_unref(icon->priv->launcher_cancellable);
+    icon->priv->launcher_cancellable = NULL;
+
+    g_object_unref(request->cancellable);
+    g_slice_free(XfdesktopIconDecodeRequest, request);
+
+    /* unreadable, keep showing it as a plain file */
+    if(!launcher_info)
+        return;
+
+    if(icon->priv->launcher_info)
+        xfdesktop_launcher_info_unref(icon->priv->launcher_info);
+    icon->priv->launcher_info = launcher_info;
+
+    new_display_name = xfdesktop_regular_file_icon_get_display_name(icon);
+    if(g_strcmp0(icon->priv->display_name, new_display_name) != 0) {
+        g_free(icon->priv->display_name);
+        icon->priv->display_name = new_display_name;
+        xfdesktop_icon_label_changed(XFDESKTOP_ICON(icon));
+    } else
+        g_free(new_display_name);
+
+    g_free(icon->priv->tooltip);
+    icon->priv->tooltip = NULL;
+
+    xfdesktop_file_icon_invalidate_icon(XFDESKTOP_FILE_ICON(icon));
+    xfdesktop_icon_invalidate_pixbuf(XFDESKTOP_ICON(icon));
+    xfdesktop_icon_pixbuf_changed(XFDESKTOP_ICON(icon));
+}
+
+/* picks up the launcher from the cache if it's current, otherwise starts
+ * parsing it and keeps the previous one around until that's done */
+static void
+xfdesktop_regular_file_icon_update_launcher_info(XfdesktopRegularFileIcon *icon)
+{
+    XfdesktopLauncherInfo *launcher_info;
+    XfdesktopIconDecodeRequest *request;
+
+    xfdesktop_regular_file_icon_cancel_launcher_load(icon);
+
+    if(!icon->priv->file_info
+       || !xfdesktop_file_utils_is_desktop_file(icon->priv->file_info))
+    {
+        if(icon->priv->launcher_info) {
+            xfdesktop_launcher_info_unref(icon->priv->launcher_info);
+            icon->priv->launcher_info = NULL;
+        }
+        return;
+    }
+
+    launcher_info = xfdesktop_file_utils_lookup_launcher_info(icon->priv->file,
+                                                              icon->priv->file_info);
+    if(launcher_info) {
+        if(icon->priv->launcher_info)
+            xfdesktop_launcher_info_unref(icon->priv->launcher_info);
+        icon->priv->launcher_info = launcher_info;
+        return;
+    }
+
+    request = g_slice_new0(XfdesktopIconDecodeRequest);
+    request->icon = icon;
+    g_object_add_weak_pointer(G_OBJECT(icon), (gpointer *)&request->icon);
+    request->cancellable = g_cancellable_new();
+    icon->priv->launcher_cancellable = g_object_ref(request->cancellable);
+
+    xfdesktop_file_utils_load_launcher_info_async(icon->priv->file,
+                                                  icon->priv->file_info,
+                                                  request->cancellable,
+                                                  xfdesktop_regular_file_icon_launcher_ready,
+                                                  request);
+}
+
 static void
 cb_folder_contents_changed(GFileMonitor     *monitor,
                            GFile            *file,
@@ -982,9 +1343,11 @@ xfdesktop_regular_file_icon_new(GFile *file,
     regular_file_icon->priv->file = g_object_ref(file);
     regular_file_icon->priv->file_info = g_object_ref(file_info);
 
+    /* parse the launcher, or pick it up from the cache */
+    xfdesktop_regular_file_icon_update_launcher_info(regular_file_icon);
+
     /* set the display name */
-    regular_file_icon->priv->display_name = xfdesktop_file_utils_get_display_name(file, 
-                                                                                  file_info);
+    regular_file_icon->priv->display_name = xfdesktop_regular_file_icon_get_display_name(regular_file_icon);
 
     /* query file system information from GIO */
     regular_file_icon->priv->filesystem_info = g_file_query_filesystem_info(regular_file_icon->priv->file,
@@ -1001,11 +1364,6 @@ xfdesktop_regular_file_icon_new(GFile *file,
 
     regular_file_icon->priv->fmanager = fmanager;
 
-    g_signal_connect_swapped(G_OBJECT(gtk_icon_theme_get_for_screen(screen)),
-                             "changed",
-                             G_CALLBACK(xfdesktop_icon_invalidate_pixbuf),
-                             regular_file_icon);
-
     if(g_file_info_get_file_type(regular_file_icon->priv->file_info) == G_FILE_TYPE_DIRECTORY) {
         regular_file_icon->priv->monitor = g_file_monitor(regular_file_icon->priv->file,
                                                           G_FILE_MONITOR_NONE,
@@ -162,16 +162,11 @@ static void
 xfdesktop_volume_icon_finalize(GObject *obj)
 {
     XfdesktopVolumeIcon *icon = XFDESKTOP_VOLUME_ICON(obj);
-    GtkIconTheme *itheme = gtk_icon_theme_get_for_screen(icon->priv->gscreen);
 
     /* remove pending change timeouts */
     if(icon->priv->changed_timeout_id > 0)
         g_source_remove(icon->priv->changed_timeout_id);
     
-    g_signal_handlers_disconnect_by_func(G_OBJECT(itheme),
-                                         G_CALLBACK(xfdesktop_icon_invalidate_pixbuf),
-                                         icon);
-    
     if(icon->priv->label) {
         g_free(icon->priv->label);
         icon->priv->label = NULL;
@@ -1096,11 +1091,6 @@ xfdesktop_volume_icon_new(GVolume *volume,
         g_object_unref(mount);
     }
 
-    g_signal_connect_swapped(G_OBJECT(gtk_icon_theme_get_for_screen(screen)),
-                             "changed",
-                             G_CALLBACK(xfdesktop_icon_invalidate_pixbuf),
-                             volume_icon);
-
     g_signal_connect(volume, "changed", 
                      G_CALLBACK(xfdesktop_volume_icon_changed), 
                      volume_icon);
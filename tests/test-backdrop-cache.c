@@ -0,0 +1,210 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* Checks the on-disk backdrop cache: entries come back as stored, broken
+ * ones are dropped, and temporary files left behind by a crash are
+ * cleaned up once they are old enough. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <time.h>
+#include <utime.h>
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <glib/gstdio.h>
+
+#include "xfce-backdrop-cache.h"
+
+static gchar *test_dir = NULL;
+static gchar *cache_dir = NULL;
+
+static void
+remove_dir(const gchar *path)
+{
+    GDir *dir = g_dir_open(path, 0, NULL);
+    const gchar *name;
+
+    if(dir) {
+        while((name = g_dir_read_name(dir))) {
+            gchar *child = g_build_filename(path, name, NULL);
+
+            if(g_file_test(child, G_FILE_TEST_IS_DIR))
+                remove_dir(child);
+            else
+                g_unlink(child);
+            g_free(child);
+        }
+        g_dir_close(dir);
+    }
+
+    g_rmdir(path);
+}
+
+static GdkPixbuf *
+create_pixbuf(gboolean has_alpha,
+              gint width,
+              gint height)
+{
+    GdkPixbuf *pix = gdk_pixbuf_new(GDK_COLORSPACE_RGB, has_alpha, 8, width, height);
+    guchar *pixels = gdk_pixbuf_get_pixels(pix);
+    gint rowstride = gdk_pixbuf_get_rowstride(pix);
+    gint n_channels = gdk_pixbuf_get_n_channels(pix);
+    gint x, y;
+
+    for(y = 0; y < height; y++) {
+        for(x = 0; x < width * n_channels; x++)
+            pixels[y * rowstride + x] = (x * 7 + y * 13) & 0xff;
+    }
+
+    return pix;
+}
+
+static void
+assert_pixbufs_equal(GdkPixbuf *a,
+                     GdkPixbuf *b)
+{
+    gint y, row_bytes;
+
+    g_assert_cmpint(gdk_pixbuf_get_width(a), ==, gdk_pixbuf_get_width(b));
+    g_assert_cmpint(gdk_pixbuf_get_height(a), ==, gdk_pixbuf_get_height(b));
+    g_assert_cmpint(gdk_pixbuf_get_has_alpha(a), ==, gdk_pixbuf_get_has_alpha(b));
+
+    row_bytes = gdk_pixbuf_get_width(a) * gdk_pixbuf_get_n_channels(a);
+    for(y = 0; y < gdk_pixbuf_get_height(a); y++) {
+        g_assert(memcmp(gdk_pixbuf_get_pixels(a) + y * gdk_pixbuf_get_rowstride(a),
+                        gdk_pixbuf_get_pixels(b) + y * gdk_pixbuf_get_rowstride(b),
+                        row_bytes) == 0);
+    }
+}
+
+static gchar *
+write_file(const gchar *name,
+           const gchar *contents,
+           time_t mtime)
+{
+    gchar *filename = g_build_filename(cache_dir, name, NULL);
+
+    g_assert(g_file_set_contents(filename, contents, -1, NULL));
+
+    if(mtime) {
+        struct utimbuf times = { mtime, mtime };
+        g_assert_cmpint(g_utime(filename, &times), ==, 0);
+    }
+
+    return filename;
+}
+
+static void
+test_backdrop_cache_roundtrip(void)
+{
+    GdkPixbuf *pix, *cached;
+
+    g_assert(xfce_backdrop_cache_lookup("roundtrip-rgb") == NULL);
+
+    /* odd widths, so the rows of the pixbuf are padded */
+    pix = create_pixbuf(FALSE, 33, 17);
+    xfce_backdrop_cache_store("roundtrip-rgb", pix);
+    cached = xfce_backdrop_cache_lookup("roundtrip-rgb");
+    g_assert(cached != NULL);
+    assert_pixbufs_equal(pix, cached);
+    g_object_unref(cached);
+    g_object_unref(pix);
+
+    pix = create_pixbuf(TRUE, 31, 9);
+    xfce_backdrop_cache_store("roundtrip-rgba", pix);
+    cached = xfce_backdrop_cache_lookup("roundtrip-rgba");
+    g_assert(cached != NULL);
+    assert_pixbufs_equal(pix, cached);
+    g_object_unref(cached);
+    g_object_unref(pix);
+}
+
+static void
+test_backdrop_cache_invalid_entry(void)
+{
+    gchar *filename;
+
+    filename = write_file("invalid.raw", "not a backdrop", 0);
+
+    g_assert(xfce_backdrop_cache_lookup("invalid") == NULL);
+    g_assert(!g_file_test(filename, G_FILE_TEST_EXISTS));
+
+    g_free(filename);
+}
+
+static void
+test_backdrop_cache_stale_temp_files(void)
+{
+    GdkPixbuf *pix;
+    gchar *stale, *fresh;
+    time_t now = time(NULL);
+
+    stale = write_file("stale.raw.AbC123", "left behind", now - 2 * 60 * 60);
+    fresh = write_file("fresh.raw.XyZ789", "being written", 0);
+
+    /* storing an entry trims the cache */
+    pix = create_pixbuf(FALSE, 8, 8);
+    xfce_backdrop_cache_store("trigger-trim", pix);
+    g_object_unref(pix);
+
+    g_assert(!g_file_test(stale, G_FILE_TEST_EXISTS));
+    g_assert(g_file_test(fresh, G_FILE_TEST_EXISTS));
+
+    g_free(stale);
+    g_free(fresh);
+}
+
+int
+main(int argc, char **argv)
+{
+    gchar *cache_home;
+    int ret;
+
+#if !GLIB_CHECK_VERSION (2, 36, 0)
+    g_type_init();
+#endif
+
+    test_dir = g_dir_make_tmp("xfdesktop-test-XXXXXX", NULL);
+    g_assert(test_dir != NULL);
+
+    cache_home = g_build_filename(test_dir, "cache", NULL);
+    g_setenv("XDG_CACHE_HOME", cache_home, TRUE);
+    cache_dir = g_build_filename(cache_home, "xfdesktop", "backdrops", NULL);
+    g_assert_cmpint(g_mkdir_with_parents(cache_dir, 0700), ==, 0);
+    g_free(cache_home);
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/backdrop-cache/roundtrip",
+                    test_backdrop_cache_roundtrip);
+    g_test_add_func("/backdrop-cache/invalid-entry",
+                    test_backdrop_cache_invalid_entry);
+    g_test_add_func("/backdrop-cache/stale-temp-files",
+                    test_backdrop_cache_stale_temp_files);
+
+    ret = g_test_run();
+
+    remove_dir(test_dir);
+    g_free(test_dir);
+    g_free(cache_dir);
+
+    return ret;
+}
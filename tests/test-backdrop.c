@@ -0,0 +1,1273 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* Checks xfce_backdrop_generate_async(): images are decoded and composed in
+ * a worker thread while the main loop keeps running, "ready" arrives in the
+ * main loop, and a generation started on top of a running one replaces it.
+ * A modified image misses the disk cache, and identical backdrops on every
+ * workspace and monitor are decoded once and share one pixbuf.  Compositing
+ * in parallel bands has to give the same bytes as a single
+ * gdk_pixbuf_composite(), and spanning backdrops are never composed in one
+ * piece.  Color patterns and repeated tiles give the same bytes as a
+ * composed canvas.  A listed directory is indexed in collation order.
+ * Changing the cycle settings drops the prefetched next image.  A burst of
+ * changes gets a preview, then the full render. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <time.h>
+#include <utime.h>
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+
+#include "xfce-backdrop.h"
+#include "xfce-backdrop-dir-index.h"
+
+#define TEST_TIMEOUT  10  /* seconds */
+
+/* while a large image is generated, the main loop has to keep serving a
+ * timeout every LATENCY_TICK ms without stalling for LATENCY_BOUND ms */
+#define LATENCY_TICK   10   /* ms */
+#define LATENCY_BOUND  250  /* ms */
+
+#define IMAGE_COLOR   0xcc0000ff
+#define CANVAS_COLOR  { 0, 0x0000, 0x6666, 0x0000 }
+#define OTHER_COLOR   { 0, 0x0000, 0x0000, 0x9999 }
+
+static gchar *test_dir = NULL;
+static gchar *image_path = NULL;
+
+typedef struct
+{
+    GMainLoop *loop;
+    guint n_ready;
+    GThread *ready_thread;
+} ReadyData;
+
+typedef struct
+{
+    gint64 last_tick;
+    gint64 max_gap;
+    guint n_ticks;
+} TickData;
+
+/* fixed seed, so failures can be reproduced */
+static GdkPixbuf *
+create_noise_image(gint width,
+                   gint height)
+{
+    GdkPixbuf *pix = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, width, height);
+    GRand *rand = g_rand_new_with_seed(4242);
+    guchar *pixels = gdk_pixbuf_get_pixels(pix);
+    gint rowstride = gdk_pixbuf_get_rowstride(pix);
+    gint x, y;
+
+    for(y = 0; y < height; y++) {
+        for(x = 0; x < width * 4; x++)
+            pixels[y * rowstride + x] = g_rand_int_range(rand, 0, 256);
+    }
+
+    g_rand_free(rand);
+
+    return pix;
+}
+
+static GdkPixbuf *
+create_image(gint width,
+             gint height,
+             guint32 rgba)
+{
+    GdkPixbuf *pix = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, width, height);
+
+    gdk_pixbuf_fill(pix, rgba);
+
+    return pix;
+}
+
+static gchar *
+save_image(GdkPixbuf *pix,
+           const gchar *name)
+{
+    gchar *filename = g_build_filename(test_dir, name, NULL);
+
+    g_assert(gdk_pixbuf_save(pix, filename, "png", NULL, NULL));
+
+    return filename;
+}
+
+static void
+remove_dir(const gchar *path)
+{
+    GDir *dir = g_dir_open(path, 0, NULL);
+    const gchar *name;
+
+    if(dir) {
+        while((name = g_dir_read_name(dir))) {
+            gchar *child = g_build_filename(path, name, NULL);
+
+            if(g_file_test(child, G_FILE_TEST_IS_DIR))
+                remove_dir(child);
+            else
+                g_unlink(child);
+            g_free(child);
+        }
+        g_dir_close(dir);
+    }
+
+    g_rmdir(path);
+}
+
+static void
+setup_test_dir(void)
+{
+    GdkPixbuf *pix;
+    gchar *cache_dir;
+
+    test_dir = g_dir_make_tmp("xfdesktop-test-XXXXXX", NULL);
+    g_assert(test_dir != NULL);
+
+    /* keep composed backdrops out of the real cache */
+    cache_dir = g_build_filename(test_dir, "cache", NULL);
+    g_setenv("XDG_CACHE_HOME", cache_dir, TRUE);
+    g_free(cache_dir);
+
+    pix = create_image(64, 48, IMAGE_COLOR);
+    image_path = save_image(pix, "image.png");
+    g_object_unref(pix);
+}
+
+static void
+teardown_test_dir(void)
+{
+    remove_dir(test_dir);
+    g_free(test_dir);
+    g_free(image_path);
+}
+
+static void
+assert_pixbufs_equal(GdkPixbuf *a,
+                     GdkPixbuf *b)
+{
+    gint y, row_bytes;
+
+    g_assert_cmpint(gdk_pixbuf_get_width(a), ==, gdk_pixbuf_get_width(b));
+    g_assert_cmpint(gdk_pixbuf_get_height(a), ==, gdk_pixbuf_get_height(b));
+    g_assert_cmpint(gdk_pixbuf_get_n_channels(a), ==, gdk_pixbuf_get_n_channels(b));
+
+    /* the padding at the end of the rows is undefined */
+    row_bytes = gdk_pixbuf_get_width(a) * gdk_pixbuf_get_n_channels(a);
+    for(y = 0; y < gdk_pixbuf_get_height(a); y++) {
+        const guchar *row_a = gdk_pixbuf_get_pixels(a) + y * gdk_pixbuf_get_rowstride(a);
+        const guchar *row_b = gdk_pixbuf_get_pixels(b) + y * gdk_pixbuf_get_rowstride(b);
+
+        if(memcmp(row_a, row_b, row_bytes) != 0)
+            g_error("pixbufs differ in row %d", y);
+    }
+}
+
+static void
+get_pixel(GdkPixbuf *pix,
+          gint x,
+          gint y,
+          guchar rgb[3])
+{
+    const guchar *p = gdk_pixbuf_get_pixels(pix)
+                      + y * gdk_pixbuf_get_rowstride(pix)
+                      + x * gdk_pixbuf_get_n_channels(pix);
+
+    memcpy(rgb, p, 3);
+}
+
+static void
+assert_pixel(GdkPixbuf *pix,
+             gint x,
+             gint y,
+             guint r,
+             guint g,
+             guint b)
+{
+    guchar rgb[3];
+
+    get_pixel(pix, x, y, rgb);
+    g_assert_cmpuint(rgb[0], ==, r);
+    g_assert_cmpuint(rgb[1], ==, g);
+    g_assert_cmpuint(rgb[2], ==, b);
+}
+
+static void
+ready_cb(XfceBackdrop *backdrop,
+         gpointer user_data)
+{
+    ReadyData *data = user_data;
+
+    data->n_ready++;
+    data->ready_thread = g_thread_self();
+
+    g_main_loop_quit(data->loop);
+}
+
+static gboolean
+timeout_cb(gpointer user_data)
+{
+    g_assert_not_reached();
+    return FALSE;
+}
+
+static gboolean
+quit_cb(gpointer user_data)
+{
+    g_main_loop_quit(user_data);
+    return FALSE;
+}
+
+/* runs the main loop until "ready" or, failing that, the test times out */
+static void
+wait_for_ready(ReadyData *data)
+{
+    guint timeout_id = g_timeout_add_seconds(TEST_TIMEOUT, timeout_cb, NULL);
+
+    g_main_loop_run(data->loop);
+    g_source_remove(timeout_id);
+}
+
+/* gives stray generations a chance to report back */
+static void
+run_main_loop_for(guint ms)
+{
+    GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+
+    g_timeout_add(ms, quit_cb, loop);
+    g_main_loop_run(loop);
+    g_main_loop_unref(loop);
+}
+
+static XfceBackdrop *
+new_backdrop(gint width,
+             gint height,
+             XfceBackdropImageStyle image_style)
+{
+    XfceBackdrop *backdrop;
+    GdkColor canvas = CANVAS_COLOR;
+
+    backdrop = xfce_backdrop_new_with_size(gdk_visual_get_system(), width, height);
+    xfce_backdrop_set_color_style(backdrop, XFCE_BACKDROP_COLOR_SOLID);
+    xfce_backdrop_set_first_color(backdrop, &canvas);
+    xfce_backdrop_set_image_style(backdrop, image_style);
+    xfce_backdrop_set_image_filename(backdrop, image_path);
+
+    return backdrop;
+}
+
+static XfceBackdrop *
+create_backdrop(gint width,
+                gint height,
+                XfceBackdropImageStyle image_style,
+                ReadyData *data)
+{
+    XfceBackdrop *backdrop = new_backdrop(width, height, image_style);
+
+    memset(data, 0, sizeof(*data));
+    data->loop = g_main_loop_new(NULL, FALSE);
+    g_signal_connect(backdrop, "ready", G_CALLBACK(ready_cb), data);
+
+    return backdrop;
+}
+
+static void
+destroy_backdrop(XfceBackdrop *backdrop,
+                 ReadyData *data)
+{
+    g_object_unref(backdrop);
+    g_main_loop_unref(data->loop);
+}
+
+static void
+test_backdrop_generate_in_thread(void)
+{
+    XfceBackdrop *backdrop;
+    ReadyData data;
+    GdkPixbuf *pix;
+
+    backdrop = create_backdrop(128, 96, XFCE_BACKDROP_IMAGE_CENTERED, &data);
+
+    /* nothing is composed before the main loop runs */
+    xfce_backdrop_generate_async(backdrop);
+    g_assert(xfce_backdrop_is_generating(backdrop));
+    g_assert(xfce_backdrop_get_pixbuf(backdrop) == NULL);
+
+    wait_for_ready(&data);
+    g_assert_cmpuint(data.n_ready, ==, 1);
+    g_assert(data.ready_thread == g_thread_self());
+    g_assert(!xfce_backdrop_is_generating(backdrop));
+
+    pix = xfce_backdrop_get_pixbuf(backdrop);
+    g_assert(pix != NULL);
+    g_assert_cmpint(gdk_pixbuf_get_width(pix), ==, 128);
+    g_assert_cmpint(gdk_pixbuf_get_height(pix), ==, 96);
+
+    /* the image in the middle, the canvas around it */
+    assert_pixel(pix, 64, 48, 0xcc, 0x00, 0x00);
+    assert_pixel(pix, 0, 0, 0x00, 0x66, 0x00);
+    assert_pixel(pix, 127, 95, 0x00, 0x66, 0x00);
+
+    g_object_unref(pix);
+    destroy_backdrop(backdrop, &data);
+}
+
+static void
+test_backdrop_generate_replaces_running(void)
+{
+    XfceBackdrop *backdrop;
+    ReadyData data;
+    GdkColor other = OTHER_COLOR;
+    GdkPixbuf *pix;
+
+    backdrop = create_backdrop(96, 64, XFCE_BACKDROP_IMAGE_CENTERED, &data);
+
+    xfce_backdrop_generate_async(backdrop);
+    xfce_backdrop_set_first_color(backdrop, &other);
+    xfce_backdrop_generate_async(backdrop);
+
+    wait_for_ready(&data);
+    run_main_loop_for(200);
+
+    /* only the second generation is shown */
+    g_assert_cmpuint(data.n_ready, ==, 1);
+
+    pix = xfce_backdrop_get_pixbuf(backdrop);
+    g_assert(pix != NULL);
+    assert_pixel(pix, 0, 0, 0x00, 0x00, 0x99);
+
+    g_object_unref(pix);
+    destroy_backdrop(backdrop, &data);
+}
+
+static void
+test_backdrop_generate_unreadable_image(void)
+{
+    XfceBackdrop *backdrop;
+    ReadyData data;
+    GdkPixbuf *pix;
+    gchar *missing;
+
+    backdrop = create_backdrop(32, 32, XFCE_BACKDROP_IMAGE_CENTERED, &data);
+    missing = g_build_filename(test_dir, "missing.png", NULL);
+    xfce_backdrop_set_image_filename(backdrop, missing);
+    g_free(missing);
+
+    /* falls back to the canvas */
+    xfce_backdrop_generate_async(backdrop);
+    wait_for_ready(&data);
+
+    pix = xfce_backdrop_get_pixbuf(backdrop);
+    g_assert(pix != NULL);
+    assert_pixel(pix, 16, 16, 0x00, 0x66, 0x00);
+
+    g_object_unref(pix);
+    destroy_backdrop(backdrop, &data);
+}
+
+static guint
+count_cache_entries(void)
+{
+    gchar *dir_name = g_build_filename(g_get_user_cache_dir(),
+                                       "xfdesktop", "backdrops", NULL);
+    GDir *dir = g_dir_open(dir_name, 0, NULL);
+    const gchar *name;
+    guint n_entries = 0;
+
+    if(dir) {
+        while((name = g_dir_read_name(dir))) {
+            if(g_str_has_suffix(name, ".raw"))
+                n_entries++;
+        }
+        g_dir_close(dir);
+    }
+    g_free(dir_name);
+
+    return n_entries;
+}
+
+/* composes path the way the first test does and checks the middle pixel */
+static void
+generate_and_check_center(const gchar *path,
+                          guint r,
+                          guint g,
+                          guint b)
+{
+    XfceBackdrop *backdrop;
+    ReadyData data;
+    GdkPixbuf *pix;
+
+    backdrop = create_backdrop(80, 60, XFCE_BACKDROP_IMAGE_CENTERED, &data);
+    xfce_backdrop_set_image_filename(backdrop, path);
+
+    xfce_backdrop_generate_async(backdrop);
+    wait_for_ready(&data);
+
+    pix = xfce_backdrop_get_pixbuf(backdrop);
+    g_assert(pix != NULL);
+    assert_pixel(pix, 40, 30, r, g, b);
+
+    g_object_unref(pix);
+    destroy_backdrop(backdrop, &data);
+}
+
+static void
+test_backdrop_cache_mtime(void)
+{
+    GdkPixbuf *image;
+    gchar *path;
+    guint n_entries;
+    struct utimbuf times;
+
+    image = create_image(16, 16, 0x00aa00ff);
+    path = save_image(image, "changing.png");
+    g_object_unref(image);
+
+    times.actime = times.modtime = time(NULL) - 60;
+    g_assert_cmpint(g_utime(path, &times), ==, 0);
+
+    n_entries = count_cache_entries();
+    generate_and_check_center(path, 0x00, 0xaa, 0x00);
+    g_assert_cmpuint(count_cache_entries(), ==, n_entries + 1);
+
+    /* unchanged, served from the cache */
+    generate_and_check_center(path, 0x00, 0xaa, 0x00);
+    g_assert_cmpuint(count_cache_entries(), ==, n_entries + 1);
+
+    /* same name, new contents and mtime */
+    image = create_image(16, 16, 0x0000bbff);
+    g_assert(gdk_pixbuf_save(image, path, "png", NULL, NULL));
+    g_object_unref(image);
+    times.actime = times.modtime = time(NULL);
+    g_assert_cmpint(g_utime(path, &times), ==, 0);
+
+    generate_and_check_center(path, 0x00, 0x00, 0xbb);
+    g_assert_cmpuint(count_cache_entries(), ==, n_entries + 2);
+
+    g_free(path);
+}
+
+static void
+tick_data_update(TickData *tick)
+{
+    gint64 now = g_get_monotonic_time();
+
+    tick->max_gap = MAX(tick->max_gap, now - tick->last_tick);
+    tick->last_tick = now;
+}
+
+static gboolean
+tick_cb(gpointer user_data)
+{
+    TickData *tick = user_data;
+
+    tick_data_update(tick);
+    tick->n_ticks++;
+
+    return TRUE;
+}
+
+static void
+test_backdrop_generate_latency(void)
+{
+    XfceBackdrop *backdrop;
+    ReadyData data;
+    TickData tick = { 0, };
+    GdkPixbuf *noise, *pix;
+    gchar *path;
+    guint n_entries, waited = 0, tick_id;
+    gint64 start;
+
+    noise = create_noise_image(3000, 2000);
+    path = save_image(noise, "large.png");
+    g_object_unref(noise);
+
+    backdrop = create_backdrop(1920, 1080, XFCE_BACKDROP_IMAGE_SCALED, &data);
+    xfce_backdrop_set_image_filename(backdrop, path);
+
+    /* the composed image is stored in the disk cache by whoever composed
+     * it; with the main loop blocked, that can only be a worker thread */
+    n_entries = count_cache_entries();
+    xfce_backdrop_generate_async(backdrop);
+    while(count_cache_entries() == n_entries) {
+        g_assert_cmpuint(waited, <, TEST_TIMEOUT * 1000);
+        g_usleep(10 * 1000);
+        waited += 10;
+    }
+
+    wait_for_ready(&data);
+    g_assert_cmpuint(data.n_ready, ==, 1);
+    pix = xfce_backdrop_get_pixbuf(backdrop);
+    g_assert(pix != NULL);
+    g_assert_cmpint(gdk_pixbuf_get_width(pix), ==, 1920);
+    g_object_unref(pix);
+
+    /* another size isn't in the cache yet, time the main loop while the
+     * image is decoded and composed again */
+    xfce_backdrop_set_size(backdrop, 1600, 900);
+
+    start = tick.last_tick = g_get_monotonic_time();
+    tick_id = g_timeout_add(LATENCY_TICK, tick_cb, &tick);
+    xfce_backdrop_generate_async(backdrop);
+    wait_for_ready(&data);
+    tick_data_update(&tick);
+    g_source_remove(tick_id);
+
+    g_test_message("generating took %" G_GINT64_FORMAT " ms, %u ticks, "
+                   "the main loop stalled for at most %" G_GINT64_FORMAT " ms",
+                   (tick.last_tick - start) / 1000, tick.n_ticks,
+                   tick.max_gap / 1000);
+    g_assert_cmpuint(data.n_ready, ==, 2);
+    g_assert_cmpint(tick.max_gap, <, LATENCY_BOUND * 1000);
+
+    pix = xfce_backdrop_get_pixbuf(backdrop);
+    g_assert(pix != NULL);
+    g_assert_cmpint(gdk_pixbuf_get_width(pix), ==, 1600);
+    g_assert_cmpint(gdk_pixbuf_get_height(pix), ==, 900);
+    g_object_unref(pix);
+
+    destroy_backdrop(backdrop, &data);
+    g_free(path);
+}
+
+/* the same wallpaper on every workspace of a three monitor setup */
+static void
+test_backdrop_shared_workspaces(void)
+{
+    const guint n_workspaces = 10, n_monitors = 3;
+    const guint n_backdrops = n_workspaces * n_monitors;
+    XfceBackdrop *backdrops[10 * 3];
+    ReadyData data;
+    GdkPixbuf *noise, *pix, *shared_pix;
+    gchar *path;
+    guint n_decodes, i;
+    gsize shared_bytes, pix_size;
+
+    /* not in the disk cache yet */
+    noise = create_noise_image(200, 150);
+    path = save_image(noise, "shared.png");
+    g_object_unref(noise);
+
+    n_decodes = xfce_backdrop_get_n_decodes();
+    shared_bytes = xfce_backdrop_get_shared_bytes();
+
+    memset(&data, 0, sizeof(data));
+    data.loop = g_main_loop_new(NULL, FALSE);
+
+    for(i = 0; i < n_backdrops; i++) {
+        backdrops[i] = new_backdrop(320, 240, XFCE_BACKDROP_IMAGE_ZOOMED);
+        xfce_backdrop_set_image_filename(backdrops[i], path);
+        g_signal_connect(backdrops[i], "ready", G_CALLBACK(ready_cb), &data);
+    }
+
+    /* the monitors of the first workspace join one pending generation... */
+    for(i = 0; i < n_monitors; i++)
+        xfce_backdrop_generate_async(backdrops[i]);
+    while(data.n_ready < n_monitors)
+        wait_for_ready(&data);
+
+    /* ...and the other workspaces pick up the finished pixbuf */
+    for(i = n_monitors; i < n_backdrops; i++)
+        xfce_backdrop_generate_async(backdrops[i]);
+    while(data.n_ready < n_backdrops)
+        wait_for_ready(&data);
+
+    g_assert_cmpuint(xfce_backdrop_get_n_decodes() - n_decodes, ==, 1);
+
+    shared_pix = xfce_backdrop_get_pixbuf(backdrops[0]);
+    g_assert(shared_pix != NULL);
+    for(i = 1; i < n_backdrops; i++) {
+        pix = xfce_backdrop_get_pixbuf(backdrops[i]);
+        g_assert(pix == shared_pix);
+        g_object_unref(pix);
+    }
+
+    pix_size = (gsize)gdk_pixbuf_get_rowstride(shared_pix)
+               * gdk_pixbuf_get_height(shared_pix);
+    g_assert_cmpuint(xfce_backdrop_get_shared_bytes() - shared_bytes,
+                     ==, (n_backdrops - 1) * pix_size);
+    g_object_unref(shared_pix);
+
+    for(i = 0; i < n_backdrops; i++)
+        g_object_unref(backdrops[i]);
+    g_assert_cmpuint(xfce_backdrop_get_shared_bytes(), ==, shared_bytes);
+
+    g_main_loop_unref(data.loop);
+    g_free(path);
+}
+
+/* xfce_backdrop_render_area() scales a spanning image with the banded
+ * compositing; compare it to doing the same in one gdk_pixbuf_composite() */
+static void
+test_backdrop_composite_bands(void)
+{
+    XfceBackdrop *backdrop;
+    ReadyData data;
+    GdkPixbuf *noise, *image, *area_pix, *expected;
+    GdkRectangle area = { 13, 7, 640, 600 };
+    gchar *noise_path;
+    gint width = 1000, height = 700, iw, ih;
+    gdouble scale, xo, yo;
+    GdkInterpType interp;
+    guint n_threads;
+
+    noise = create_noise_image(50, 37);
+    noise_path = save_image(noise, "noise.png");
+    g_object_unref(noise);
+
+    backdrop = create_backdrop(width, height, XFCE_BACKDROP_IMAGE_SPANNING_SCREENS, &data);
+    xfce_backdrop_set_image_filename(backdrop, noise_path);
+    g_free(noise_path);
+
+    xfce_backdrop_generate_async(backdrop);
+    wait_for_ready(&data);
+
+    /* spanning backdrops keep the image, which is smaller than the backdrop
+     * and so not scaled when loading */
+    image = xfce_backdrop_get_pixbuf(backdrop);
+    g_assert(image != NULL);
+    iw = gdk_pixbuf_get_width(image);
+    ih = gdk_pixbuf_get_height(image);
+    g_assert_cmpint(iw, ==, 50);
+    g_assert_cmpint(ih, ==, 37);
+
+    scale = MAX((gdouble)width / iw, (gdouble)height / ih);
+    xo = (width - iw * scale) * 0.5;
+    yo = (height - ih * scale) * 0.5;
+    interp = (gdk_visual_get_depth(gdk_visual_get_system()) < 24
+              ? GDK_INTERP_HYPER : GDK_INTERP_BILINEAR);
+
+    expected = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, area.width, area.height);
+    gdk_pixbuf_fill(expected, 0x00000000);
+    gdk_pixbuf_composite(image, expected, 0, 0, area.width, area.height,
+                         xo - area.x, yo - area.y, scale, scale, interp, 255);
+
+    n_threads = xfce_backdrop_get_render_threads();
+
+    /* one band, several, and more than there are rows for */
+    xfce_backdrop_set_render_threads(1);
+    area_pix = xfce_backdrop_render_area(backdrop, &area);
+    assert_pixbufs_equal(area_pix, expected);
+    g_object_unref(area_pix);
+
+    xfce_backdrop_set_render_threads(3);
+    area_pix = xfce_backdrop_render_area(backdrop, &area);
+    assert_pixbufs_equal(area_pix, expected);
+    g_object_unref(area_pix);
+
+    xfce_backdrop_set_render_threads(16);
+    area_pix = xfce_backdrop_render_area(backdrop, &area);
+    assert_pixbufs_equal(area_pix, expected);
+    g_object_unref(area_pix);
+
+    xfce_backdrop_set_render_threads(n_threads);
+
+    g_object_unref(expected);
+    g_object_unref(image);
+    destroy_backdrop(backdrop, &data);
+}
+
+/* Paints @backdrop at @x, @y of a new surface the way
+ * xfce_desktop_paint_backdrop() does for patterns and tiles */
+static cairo_surface_t *
+paint_backdrop(XfceBackdrop *backdrop,
+               gint width,
+               gint height,
+               gint x,
+               gint y)
+{
+    cairo_surface_t *surface;
+    cairo_pattern_t *pattern;
+    cairo_matrix_t matrix;
+    cairo_t *cr;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, x + width, y + height);
+    cr = cairo_create(surface);
+
+    cairo_rectangle(cr, x, y, width, height);
+    cairo_clip(cr);
+
+    pattern = xfce_backdrop_create_canvas_pattern(backdrop);
+    cairo_matrix_init_translate(&matrix, -x, -y);
+    cairo_pattern_set_matrix(pattern, &matrix);
+    cairo_set_source(cr, pattern);
+    cairo_paint(cr);
+    cairo_pattern_destroy(pattern);
+
+    if(xfce_backdrop_get_image_style(backdrop) == XFCE_BACKDROP_IMAGE_TILED) {
+        GdkPixbuf *tile = xfce_backdrop_get_pixbuf(backdrop);
+
+        gdk_cairo_set_source_pixbuf(cr, tile, x, y);
+        cairo_pattern_set_extend(cairo_get_source(cr), CAIRO_EXTEND_REPEAT);
+        cairo_paint(cr);
+        g_object_unref(tile);
+    }
+
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+
+    return surface;
+}
+
+/* Compares the area of @surface at @x, @y to @pix, allowing each channel
+ * to be off by @tolerance */
+static void
+assert_surface_equals_pixbuf(cairo_surface_t *surface,
+                             GdkPixbuf *pix,
+                             gint x,
+                             gint y,
+                             gint tolerance)
+{
+    const guchar *data = cairo_image_surface_get_data(surface);
+    gint stride = cairo_image_surface_get_stride(surface);
+    gint row, col;
+
+    for(row = 0; row < gdk_pixbuf_get_height(pix); row++) {
+        for(col = 0; col < gdk_pixbuf_get_width(pix); col++) {
+            guint32 pixel = *(const guint32 *)(data + (y + row) * stride + (x + col) * 4);
+            guchar rgb[3];
+
+            get_pixel(pix, col, row, rgb);
+            if(ABS((gint)((pixel >> 16) & 0xff) - rgb[0]) > tolerance
+               || ABS((gint)((pixel >> 8) & 0xff) - rgb[1]) > tolerance
+               || ABS((gint)(pixel & 0xff) - rgb[2]) > tolerance)
+            {
+                g_error("surface has %06x at %d,%d, the pixbuf %02x%02x%02x",
+                        pixel & 0xffffff, col, row, rgb[0], rgb[1], rgb[2]);
+            }
+        }
+    }
+}
+
+/* Backdrops without an image are painted from a pattern instead of a
+ * composed canvas; both have to give the same pixels, first and last
+ * column or row of a gradient included */
+static void
+test_backdrop_pattern_matches_canvas(void)
+{
+    static const XfceBackdropColorStyle styles[] = {
+        XFCE_BACKDROP_COLOR_SOLID,
+        XFCE_BACKDROP_COLOR_HORIZ_GRADIENT,
+        XFCE_BACKDROP_COLOR_VERT_GRADIENT,
+    };
+    /* not multiples of 0x101, where rounding and truncating differ */
+    GdkColor color1 = { 0, 0x1234, 0xfedc, 0x0180 };
+    GdkColor color2 = { 0, 0xff00, 0x0000, 0x80ff };
+    guint i;
+
+    for(i = 0; i < G_N_ELEMENTS(styles); i++) {
+        XfceBackdrop *backdrop;
+        ReadyData data;
+        GdkPixbuf *pix;
+        cairo_pattern_t *pattern;
+        cairo_surface_t *surface;
+
+        backdrop = create_backdrop(97, 61, XFCE_BACKDROP_IMAGE_NONE, &data);
+        xfce_backdrop_set_color_style(backdrop, styles[i]);
+        xfce_backdrop_set_first_color(backdrop, &color1);
+        xfce_backdrop_set_second_color(backdrop, &color2);
+
+        xfce_backdrop_generate_async(backdrop);
+        wait_for_ready(&data);
+
+        pix = xfce_backdrop_get_pixbuf(backdrop);
+        g_assert(pix != NULL);
+        pattern = xfce_backdrop_create_color_pattern(backdrop);
+        g_assert(pattern != NULL);
+
+        cairo_pattern_destroy(pattern);
+
+        /* at the origin and where a second monitor would start */
+        surface = paint_backdrop(backdrop, 97, 61, 0, 0);
+        assert_surface_equals_pixbuf(surface, pix, 0, 0, 0);
+        cairo_surface_destroy(surface);
+
+        surface = paint_backdrop(backdrop, 97, 61, 13, 7);
+        assert_surface_equals_pixbuf(surface, pix, 13, 7, 0);
+        cairo_surface_destroy(surface);
+
+        g_object_unref(pix);
+        destroy_backdrop(backdrop, &data);
+    }
+}
+
+/* Tiles used to be copied into a backdrop-sized pixbuf and composited onto
+ * the canvas; painting the tile as a repeating pattern has to give the same
+ * pixels.  Blending translucent tiles rounds twice in cairo, once when
+ * premultiplying and once when blending, and once in gdk-pixbuf */
+static void
+test_backdrop_pattern_tiled(void)
+{
+    GdkColor color1 = { 0, 0x1234, 0xfedc, 0x0180 };
+    GdkColor color2 = { 0, 0xff00, 0x0000, 0x80ff };
+    GdkPixbuf *canvas;
+    XfceBackdrop *backdrop;
+    ReadyData data;
+    gint width = 97, height = 61;
+    gint opaque;
+
+    /* the canvas the tiles went onto */
+    backdrop = create_backdrop(width, height, XFCE_BACKDROP_IMAGE_NONE, &data);
+    xfce_backdrop_set_color_style(backdrop, XFCE_BACKDROP_COLOR_HORIZ_GRADIENT);
+    xfce_backdrop_set_first_color(backdrop, &color1);
+    xfce_backdrop_set_second_color(backdrop, &color2);
+    xfce_backdrop_generate_async(backdrop);
+    wait_for_ready(&data);
+    canvas = xfce_backdrop_get_pixbuf(backdrop);
+    g_assert(canvas != NULL);
+    destroy_backdrop(backdrop, &data);
+
+    for(opaque = 1; opaque >= 0; opaque--) {
+        GdkPixbuf *noise, *tile, *tmp, *expected;
+        cairo_surface_t *surface;
+        gchar *tile_path;
+        gint i, j, iw, ih;
+
+        noise = create_noise_image(23, 17);
+        if(opaque) {
+            guchar *pixels = gdk_pixbuf_get_pixels(noise);
+
+            for(j = 0; j < gdk_pixbuf_get_height(noise); j++) {
+                for(i = 0; i < gdk_pixbuf_get_width(noise); i++)
+                    pixels[j * gdk_pixbuf_get_rowstride(noise) + i * 4 + 3] = 0xff;
+            }
+        }
+        tile_path = save_image(noise, opaque ? "tile-opaque.png" : "tile-alpha.png");
+        g_object_unref(noise);
+
+        backdrop = create_backdrop(width, height, XFCE_BACKDROP_IMAGE_TILED, &data);
+        xfce_backdrop_set_color_style(backdrop, XFCE_BACKDROP_COLOR_HORIZ_GRADIENT);
+        xfce_backdrop_set_first_color(backdrop, &color1);
+        xfce_backdrop_set_second_color(backdrop, &color2);
+        xfce_backdrop_set_image_filename(backdrop, tile_path);
+        g_free(tile_path);
+
+        xfce_backdrop_generate_async(backdrop);
+        wait_for_ready(&data);
+
+        /* only the tile is kept */
+        tile = xfce_backdrop_get_pixbuf(backdrop);
+        g_assert(tile != NULL);
+        iw = gdk_pixbuf_get_width(tile);
+        ih = gdk_pixbuf_get_height(tile);
+        g_assert_cmpint(iw, ==, 23);
+        g_assert_cmpint(ih, ==, 17);
+
+        /* what xfce_backdrop_loader_closed_cb() did before */
+        tmp = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, width, height);
+        for(i = 0; i * iw < width; i++) {
+            for(j = 0; j * ih < height; j++) {
+                gdk_pixbuf_copy_area(tile, 0, 0,
+                                     MIN(iw, width - i * iw),
+                                     MIN(ih, height - j * ih),
+                                     tmp, i * iw, j * ih);
+            }
+        }
+        expected = gdk_pixbuf_copy(canvas);
+        gdk_pixbuf_composite(tmp, expected, 0, 0, width, height,
+                             0, 0, 1.0, 1.0, GDK_INTERP_BILINEAR, 255);
+        g_object_unref(tmp);
+
+        surface = paint_backdrop(backdrop, width, height, 13, 7);
+        assert_surface_equals_pixbuf(surface, expected, 13, 7, opaque ? 0 : 2);
+        cairo_surface_destroy(surface);
+
+        g_object_unref(expected);
+        g_object_unref(tile);
+        destroy_backdrop(backdrop, &data);
+    }
+
+    g_object_unref(canvas);
+}
+
+static void
+dir_index_loaded_cb(XfceBackdropDirIndex *index,
+                    XfceBackdropDirIndexEvent event,
+                    const gchar *filename,
+                    gpointer user_data)
+{
+    if(event == XFCE_BACKDROP_DIR_INDEX_LOADED)
+        g_main_loop_quit(user_data);
+}
+
+/* more files than the index asks the enumerator for at a time, created in
+ * reverse order so the listing doesn't come sorted by chance */
+static void
+test_backdrop_dir_index_sorted(void)
+{
+    const guint n_files = 150;
+    XfceBackdropDirIndex *index;
+    GMainLoop *loop;
+    GdkPixbuf *pix;
+    gchar *dir_name, *path, *name, *prev_key = NULL;
+    guint i, timeout_id;
+
+    dir_name = g_build_filename(test_dir, "indexed", NULL);
+    g_assert_cmpint(g_mkdir(dir_name, 0700), ==, 0);
+
+    pix = create_image(1, 1, IMAGE_COLOR);
+    for(i = n_files; i > 0; i--) {
+        name = g_strdup_printf("image-%u.png", i);
+        path = g_build_filename(dir_name, name, NULL);
+        g_assert(gdk_pixbuf_save(pix, path, "png", NULL, NULL));
+        g_free(path);
+        g_free(name);
+    }
+    g_object_unref(pix);
+
+    loop = g_main_loop_new(NULL, FALSE);
+    index = xfce_backdrop_dir_index_get(dir_name);
+    xfce_backdrop_dir_index_add_watch(index, dir_index_loaded_cb, loop);
+
+    timeout_id = g_timeout_add_seconds(TEST_TIMEOUT, timeout_cb, NULL);
+    while(!xfce_backdrop_dir_index_is_loaded(index))
+        g_main_loop_run(loop);
+    g_source_remove(timeout_id);
+
+    g_assert_cmpuint(xfce_backdrop_dir_index_get_n_files(index), ==, n_files);
+
+    /* "image-2.png" before "image-10.png", and positions match */
+    for(i = 0; i < n_files; i++) {
+        const gchar *file = xfce_backdrop_dir_index_get_file(index, i);
+        gchar *key = g_utf8_collate_key_for_filename(file, -1);
+
+        if(prev_key)
+            g_assert_cmpint(strcmp(prev_key, key), <, 0);
+        g_free(prev_key);
+        prev_key = key;
+
+        g_assert_cmpint(xfce_backdrop_dir_index_find(index, file), ==, i);
+    }
+    g_free(prev_key);
+
+    name = g_build_filename(dir_name, "image-2.png", NULL);
+    g_assert_cmpint(xfce_backdrop_dir_index_find(index, name), ==, 1);
+    g_free(name);
+
+    xfce_backdrop_dir_index_remove_watch(index, dir_index_loaded_cb, loop);
+    xfce_backdrop_dir_index_unref(index);
+    g_main_loop_unref(loop);
+    g_free(dir_name);
+}
+
+/* runs the main loop until the next image of the cycle has been composed */
+static void
+wait_for_prefetch(XfceBackdrop *backdrop)
+{
+    guint timeout_id = g_timeout_add_seconds(TEST_TIMEOUT, timeout_cb, NULL);
+
+    while(!xfce_backdrop_get_prefetched_filename(backdrop))
+        g_main_context_iteration(NULL, TRUE);
+    g_source_remove(timeout_id);
+}
+
+/* Cycling composes the next image ahead of time.  Changing how the cycle
+ * goes has to drop it, whether it's finished or still being composed */
+static void
+test_backdrop_prefetch_canceled(void)
+{
+    XfceBackdrop *backdrop;
+    ReadyData data;
+    gchar *cycle_dir, *first_path = NULL;
+    const gchar *next;
+    gint i;
+
+    cycle_dir = g_build_filename(test_dir, "cycle", NULL);
+    g_assert_cmpint(g_mkdir(cycle_dir, 0700), ==, 0);
+    for(i = 0; i < 3; i++) {
+        GdkPixbuf *noise = create_noise_image(400 + i, 300);
+        gchar *name = g_strdup_printf("cycle-%d.png", i);
+        gchar *path = g_build_filename(cycle_dir, name, NULL);
+
+        g_assert(gdk_pixbuf_save(noise, path, "png", NULL, NULL));
+        if(i == 0)
+            first_path = path;
+        else
+            g_free(path);
+
+        g_free(name);
+        g_object_unref(noise);
+    }
+
+    /* centered images are never previewed, the first "ready" is final */
+    backdrop = create_backdrop(640, 480, XFCE_BACKDROP_IMAGE_CENTERED, &data);
+    xfce_backdrop_set_image_filename(backdrop, first_path);
+    xfce_backdrop_set_cycle_period(backdrop, XFCE_BACKDROP_PERIOD_SECONDS);
+    xfce_backdrop_set_cycle_timer(backdrop, 3600);
+    xfce_backdrop_set_cycle_backdrop(backdrop, TRUE);
+
+    xfce_backdrop_generate_async(backdrop);
+    wait_for_ready(&data);
+
+    /* once the image is shown and the folder listed */
+    wait_for_prefetch(backdrop);
+    next = xfce_backdrop_get_prefetched_filename(backdrop);
+    g_assert(g_str_has_prefix(next, cycle_dir));
+    g_assert_cmpstr(next, !=, first_path);
+
+    /* a finished prefetch is dropped */
+    xfce_backdrop_set_random_order(backdrop, TRUE);
+    g_assert(xfce_backdrop_get_prefetched_filename(backdrop) == NULL);
+    g_assert(!xfce_backdrop_is_prefetching(backdrop));
+    xfce_backdrop_set_random_order(backdrop, FALSE);
+
+    /* the image is still there, so this is ready at once and starts
+     * composing the next one again */
+    xfce_backdrop_generate_async(backdrop);
+    g_assert_cmpuint(data.n_ready, ==, 2);
+    g_assert(xfce_backdrop_is_prefetching(backdrop));
+
+    /* a running prefetch is dropped, and its result is never taken */
+    xfce_backdrop_set_cycle_timer(backdrop, 1800);
+    g_assert(!xfce_backdrop_is_prefetching(backdrop));
+
+    run_main_loop_for(1000);
+    g_assert(xfce_backdrop_get_prefetched_filename(backdrop) == NULL);
+    g_assert(!xfce_backdrop_is_prefetching(backdrop));
+
+    destroy_backdrop(backdrop, &data);
+    g_free(first_path);
+    g_free(cycle_dir);
+}
+
+/* regenerates on every change, like the desktop does */
+static void
+changed_cb(XfceBackdrop *backdrop,
+           gpointer user_data)
+{
+    xfce_backdrop_generate_async(backdrop);
+}
+
+/* Setting up a backdrop is no burst of changes, but changes arriving one
+ * right after the other are, like the settings dialog sends them while a
+ * color is being dragged.  Each of those supersedes the render of the one
+ * before, only the last one is previewed, and the full render follows once
+ * the changes stop */
+static void
+test_backdrop_preview_then_full(void)
+{
+    XfceBackdrop *backdrop;
+    ReadyData data;
+    GdkPixbuf *noise, *pix;
+    gchar *noise_path;
+    gint i;
+
+    noise = create_noise_image(320, 240);
+    noise_path = save_image(noise, "preview.png");
+    g_object_unref(noise);
+
+    backdrop = create_backdrop(640, 480, XFCE_BACKDROP_IMAGE_STRETCHED, &data);
+    xfce_backdrop_set_image_filename(backdrop, noise_path);
+    g_free(noise_path);
+
+    xfce_backdrop_generate_async(backdrop);
+    wait_for_ready(&data);
+    g_assert(!xfce_backdrop_is_preview(backdrop));
+
+    g_signal_connect(backdrop, "changed", G_CALLBACK(changed_cb), NULL);
+
+    /* the first change is rendered in full, the following ones cancel
+     * that and each other's previews */
+    for(i = 1; i <= 5; i++) {
+        GdkColor color = { 0, i * 0x1111, 0x6666, 0x0000 };
+
+        xfce_backdrop_note_change(backdrop);
+        xfce_backdrop_set_first_color(backdrop, &color);
+    }
+
+    wait_for_ready(&data);
+    g_assert_cmpuint(data.n_ready, ==, 2);
+    g_assert(xfce_backdrop_is_preview(backdrop));
+    pix = xfce_backdrop_get_pixbuf(backdrop);
+    g_assert_cmpint(gdk_pixbuf_get_width(pix), ==, 640);
+    g_assert_cmpint(gdk_pixbuf_get_height(pix), ==, 480);
+    g_object_unref(pix);
+
+    wait_for_ready(&data);
+    g_assert_cmpuint(data.n_ready, ==, 3);
+    g_assert(!xfce_backdrop_is_preview(backdrop));
+
+    /* nothing superseded reports back late */
+    run_main_loop_for(500);
+    g_assert_cmpuint(data.n_ready, ==, 3);
+    g_assert(!xfce_backdrop_is_generating(backdrop));
+
+    destroy_backdrop(backdrop, &data);
+}
+
+/* The image decoded for a preview is reused by the next one, but only for
+ * the same style and size: stretched, it was decoded to the backdrop's
+ * aspect ratio, which scaled would then show distorted */
+static void
+test_backdrop_preview_style_change(void)
+{
+    XfceBackdrop *backdrop;
+    ReadyData data;
+    GdkPixbuf *image, *pix;
+    gchar *wide_path;
+    guint n_decodes;
+    gint i;
+
+    image = create_image(400, 100, IMAGE_COLOR);
+    wide_path = save_image(image, "preview-wide.png");
+    g_object_unref(image);
+
+    backdrop = create_backdrop(640, 480, XFCE_BACKDROP_IMAGE_STRETCHED, &data);
+    xfce_backdrop_set_image_filename(backdrop, wide_path);
+    g_free(wide_path);
+
+    xfce_backdrop_generate_async(backdrop);
+    wait_for_ready(&data);
+
+    g_signal_connect(backdrop, "changed", G_CALLBACK(changed_cb), NULL);
+
+    for(i = 1; i <= 2; i++) {
+        GdkColor color = { 0, i * 0x1111, 0x6666, 0x0000 };
+
+        xfce_backdrop_note_change(backdrop);
+        xfce_backdrop_set_first_color(backdrop, &color);
+    }
+
+    wait_for_ready(&data);
+    g_assert(xfce_backdrop_is_preview(backdrop));
+
+    /* still the same burst */
+    n_decodes = xfce_backdrop_get_n_decodes();
+    xfce_backdrop_note_change(backdrop);
+    xfce_backdrop_set_image_style(backdrop, XFCE_BACKDROP_IMAGE_SCALED);
+
+    wait_for_ready(&data);
+    g_assert(xfce_backdrop_is_preview(backdrop));
+    g_assert_cmpuint(xfce_backdrop_get_n_decodes(), ==, n_decodes + 1);
+
+    /* a 640x160 band across the middle, the canvas above and below it */
+    pix = xfce_backdrop_get_pixbuf(backdrop);
+    assert_pixel(pix, 320, 240, 0xcc, 0x00, 0x00);
+    assert_pixel(pix, 320, 20, 0x22, 0x66, 0x00);
+    assert_pixel(pix, 320, 460, 0x22, 0x66, 0x00);
+    g_object_unref(pix);
+
+    wait_for_ready(&data);
+    g_assert(!xfce_backdrop_is_preview(backdrop));
+
+    destroy_backdrop(backdrop, &data);
+}
+
+/* A spanning backdrop is never composed in one piece: one this size would
+ * need more than gdk-pixbuf can even allocate.  Only the image is kept, and
+ * drawing it takes one pixbuf the size of the area drawn */
+static void
+test_backdrop_spanning_bounded(void)
+{
+    XfceBackdrop *backdrop;
+    ReadyData data;
+    GdkPixbuf *noise, *image, *area_pix;
+    GdkRectangle area = { 20000, 7000, 640, 480 };
+    gchar *noise_path;
+    gint width = 40000, height = 15000;
+
+    /* more than G_MAXINT bytes as RGBA */
+    g_assert_cmpfloat((gdouble)width * height * 4, >, G_MAXINT);
+
+    noise = create_noise_image(64, 48);
+    noise_path = save_image(noise, "spanning.png");
+    g_object_unref(noise);
+
+    backdrop = create_backdrop(width, height, XFCE_BACKDROP_IMAGE_SPANNING_SCREENS, &data);
+    xfce_backdrop_set_image_filename(backdrop, noise_path);
+    g_free(noise_path);
+
+    xfce_backdrop_generate_async(backdrop);
+    wait_for_ready(&data);
+
+    image = xfce_backdrop_get_pixbuf(backdrop);
+    g_assert(image != NULL);
+    g_assert_cmpint(gdk_pixbuf_get_width(image), ==, 64);
+    g_assert_cmpint(gdk_pixbuf_get_height(image), ==, 48);
+    g_object_unref(image);
+
+    area_pix = xfce_backdrop_render_area(backdrop, &area);
+    g_assert(area_pix != NULL);
+    g_assert_cmpint(gdk_pixbuf_get_width(area_pix), ==, area.width);
+    g_assert_cmpint(gdk_pixbuf_get_height(area_pix), ==, area.height);
+    g_object_unref(area_pix);
+
+    destroy_backdrop(backdrop, &data);
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+    if(!g_thread_supported())
+        g_thread_init(NULL);
+#endif
+
+    /* before anything looks up the cache directory */
+    setup_test_dir();
+
+    if(!gtk_init_check(&argc, &argv)) {
+        teardown_test_dir();
+        return 77;
+    }
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/backdrop/generate/in-thread",
+                    test_backdrop_generate_in_thread);
+    g_test_add_func("/backdrop/generate/replaces-running",
+                    test_backdrop_generate_replaces_running);
+    g_test_add_func("/backdrop/generate/unreadable-image",
+                    test_backdrop_generate_unreadable_image);
+    g_test_add_func("/backdrop/generate/latency",
+                    test_backdrop_generate_latency);
+    g_test_add_func("/backdrop/cache/mtime",
+                    test_backdrop_cache_mtime);
+    g_test_add_func("/backdrop/shared/workspaces",
+                    test_backdrop_shared_workspaces);
+    g_test_add_func("/backdrop/composite/bands",
+                    test_backdrop_composite_bands);
+    g_test_add_func("/backdrop/composite/spanning-bounded",
+                    test_backdrop_spanning_bounded);
+    g_test_add_func("/backdrop/pattern/matches-canvas",
+                    test_backdrop_pattern_matches_canvas);
+    g_test_add_func("/backdrop/pattern/tiled",
+                    test_backdrop_pattern_tiled);
+    g_test_add_func("/backdrop/dir-index/sorted",
+                    test_backdrop_dir_index_sorted);
+    g_test_add_func("/backdrop/prefetch/canceled",
+                    test_backdrop_prefetch_canceled);
+    g_test_add_func("/backdrop/preview/then-full",
+                    test_backdrop_preview_then_full);
+    g_test_add_func("/backdrop/preview/style-change",
+                    test_backdrop_preview_style_change);
+
+    ret = g_test_run();
+
+    teardown_test_dir();
+
+    return ret;
+}
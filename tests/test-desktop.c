@@ -0,0 +1,776 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* Runs a whole XfceDesktop against a stand-in xfconfd and just enough of a
+ * window manager for libwnck to see workspaces, and watches what it sets on
+ * the root window.  Backdrop settings are read in one go at startup.
+ * Switching to a workspace painted ahead of time swaps in its pixmap, and
+ * the time it takes is reported.  Opaque backdrops drawn without cairo give
+ * the same pixels as with it, and a burst of repaints updates the root
+ * window properties once.
+ *
+ * Needs an X display with a 24 bit visual and a private session bus:
+ *   dbus-run-session -- xvfb-run -a -s '-screen 0 1024x768x24' ./test-desktop
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <X11/Xlib.h>
+
+#include <gtk/gtk.h>
+#include <gdk/gdkx.h>
+#include <glib/gstdio.h>
+#include <xfconf/xfconf.h>
+
+#include "xfdesktop-common.h"
+#include "xfce-desktop.h"
+#include "xfconf-stand-in.h"
+
+#define TEST_TIMEOUT      10    /* seconds */
+/* long enough for backdrops to be composed and painted ahead of time */
+#define TEST_SETTLE_TIME  1500  /* ms */
+
+#define CHANNEL           "xfce4-desktop"
+#define PROPERTY_PREFIX   "/backdrop/screen0/"
+#define PROPERTY_BASE     "/backdrop/screen0"
+
+#define N_WORKSPACES      4
+#define CHANGED_COLOR     0x00cccc
+
+static const guint32 workspace_colors[N_WORKSPACES] = {
+    0xcc0000, 0x00cc00, 0x0000cc, 0xcccc00
+};
+
+static gchar *test_dir = NULL;
+
+static Atom root_pixmap_atom = None;
+static guint n_root_pixmap_updates = 0;
+static gint64 last_root_pixmap_update = 0;
+
+static GdkWindow *wm_check_window = NULL;
+
+static void
+remove_dir(const gchar *path)
+{
+    GDir *dir = g_dir_open(path, 0, NULL);
+    const gchar *name;
+
+    if(dir) {
+        while((name = g_dir_read_name(dir))) {
+            gchar *child = g_build_filename(path, name, NULL);
+
+            if(g_file_test(child, G_FILE_TEST_IS_DIR))
+                remove_dir(child);
+            else
+                g_unlink(child);
+            g_free(child);
+        }
+        g_dir_close(dir);
+    }
+
+    g_rmdir(path);
+}
+
+static gchar *
+create_image(const gchar *name,
+             guint32 rgb)
+{
+    GdkPixbuf *pix = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, 64, 48);
+    gchar *filename = g_build_filename(test_dir, name, NULL);
+
+    gdk_pixbuf_fill(pix, rgb << 8 | 0xff);
+    g_assert(gdk_pixbuf_save(pix, filename, "png", NULL, NULL));
+    g_object_unref(pix);
+
+    return filename;
+}
+
+/* opaque, with a fixed seed so failures can be reproduced */
+static gchar *
+create_noise_image(const gchar *name,
+                   gint width,
+                   gint height)
+{
+    GdkPixbuf *pix = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, width, height);
+    gchar *filename = g_build_filename(test_dir, name, NULL);
+    GRand *rand = g_rand_new_with_seed(4242);
+    guchar *pixels = gdk_pixbuf_get_pixels(pix);
+    gint rowstride = gdk_pixbuf_get_rowstride(pix);
+    gint x, y;
+
+    for(y = 0; y < height; y++) {
+        for(x = 0; x < width * 3; x++)
+            pixels[y * rowstride + x] = g_rand_int_range(rand, 0, 256);
+    }
+
+    g_assert(gdk_pixbuf_save(pix, filename, "png", NULL, NULL));
+
+    g_rand_free(rand);
+    g_object_unref(pix);
+
+    return filename;
+}
+
+static gboolean
+wake_up(gpointer data)
+{
+    return TRUE;
+}
+
+static void
+run_main_loop_for(guint ms)
+{
+    gint64 end = g_get_monotonic_time() + ms * 1000;
+    guint waker = g_timeout_add(20, wake_up, NULL);
+
+    while(g_get_monotonic_time() < end)
+        g_main_context_iteration(NULL, TRUE);
+
+    g_source_remove(waker);
+}
+
+/* Runs the main loop until _XROOTPMAP_ID gets set again after the
+ * @n_before updates seen so far */
+static gboolean
+wait_for_root_pixmap(guint n_before)
+{
+    gint64 end = g_get_monotonic_time() + TEST_TIMEOUT * G_USEC_PER_SEC;
+    guint waker = g_timeout_add(20, wake_up, NULL);
+
+    while(n_root_pixmap_updates == n_before && g_get_monotonic_time() < end)
+        g_main_context_iteration(NULL, TRUE);
+
+    g_source_remove(waker);
+
+    return n_root_pixmap_updates != n_before;
+}
+
+static GdkFilterReturn
+root_filter(GdkXEvent *gdk_xevent,
+            GdkEvent *event,
+            gpointer data)
+{
+    XEvent *xevent = gdk_xevent;
+
+    if(xevent->type == PropertyNotify
+       && xevent->xproperty.atom == root_pixmap_atom
+       && xevent->xproperty.state == PropertyNewValue)
+    {
+        n_root_pixmap_updates++;
+        last_root_pixmap_update = g_get_monotonic_time();
+    }
+
+    return GDK_FILTER_CONTINUE;
+}
+
+static void
+watch_root_window(void)
+{
+    GdkWindow *root = gdk_get_default_root_window();
+
+    root_pixmap_atom = gdk_x11_get_xatom_by_name("_XROOTPMAP_ID");
+
+    gdk_window_set_events(root, gdk_window_get_events(root) | GDK_PROPERTY_CHANGE_MASK);
+    gdk_window_add_filter(root, root_filter, NULL);
+}
+
+static Pixmap
+get_root_pixmap(void)
+{
+    GdkAtom type;
+    gint format, length;
+    guchar *data = NULL;
+    Pixmap xid = None;
+
+    if(gdk_property_get(gdk_get_default_root_window(),
+                        gdk_atom_intern("_XROOTPMAP_ID", FALSE),
+                        gdk_atom_intern("PIXMAP", FALSE),
+                        0, 1, FALSE, &type, &format, &length, &data)
+       && data)
+    {
+        /* 32 bit properties come as longs */
+        xid = *(gulong *)data;
+        g_free(data);
+    }
+
+    return xid;
+}
+
+/* Reads back @area of the root pixmap, as apps using it see it */
+static GdkPixbuf *
+get_root_pixmap_area(const GdkRectangle *area)
+{
+    GdkScreen *gscreen = gdk_screen_get_default();
+    Pixmap xid = get_root_pixmap();
+    GdkPixmap *pmap;
+    GdkPixbuf *pix;
+
+    g_assert(xid != None);
+
+    pmap = gdk_pixmap_lookup(xid);
+    if(pmap)
+        g_object_ref(pmap);
+    else
+        pmap = gdk_pixmap_foreign_new(xid);
+    g_assert(pmap != NULL);
+
+    pix = gdk_pixbuf_get_from_drawable(NULL, GDK_DRAWABLE(pmap),
+                                       gdk_screen_get_system_colormap(gscreen),
+                                       area->x, area->y, 0, 0,
+                                       area->width, area->height);
+    g_assert(pix != NULL);
+
+    g_object_unref(pmap);
+
+    return pix;
+}
+
+/* color in the middle of the screen */
+static guint32
+get_root_pixmap_color(void)
+{
+    GdkScreen *gscreen = gdk_screen_get_default();
+    GdkRectangle area = { 0, 0, 1, 1 };
+    GdkPixbuf *pix;
+    guchar *p;
+    guint32 rgb;
+
+    area.x = gdk_screen_get_width(gscreen) / 2;
+    area.y = gdk_screen_get_height(gscreen) / 2;
+    pix = get_root_pixmap_area(&area);
+
+    p = gdk_pixbuf_get_pixels(pix);
+    rgb = p[0] << 16 | p[1] << 8 | p[2];
+
+    g_object_unref(pix);
+
+    return rgb;
+}
+
+static void
+set_root_cardinal(const gchar *name,
+                  gulong value)
+{
+    gdk_property_change(gdk_get_default_root_window(),
+                        gdk_atom_intern(name, FALSE),
+                        gdk_atom_intern("CARDINAL", FALSE), 32,
+                        GDK_PROP_MODE_REPLACE, (guchar *)&value, 1);
+}
+
+/* Just enough of an EWMH window manager for libwnck to see workspaces */
+static void
+fake_wm_start(gint n_workspaces)
+{
+    GdkWindow *root = gdk_get_default_root_window();
+    GdkWindowAttr attributes = { 0, };
+    GdkAtom supported[4];
+    gulong xid;
+
+    attributes.x = attributes.y = -100;
+    attributes.width = attributes.height = 1;
+    attributes.wclass = GDK_INPUT_ONLY;
+    attributes.window_type = GDK_WINDOW_TOPLEVEL;
+    attributes.override_redirect = TRUE;
+    wm_check_window = gdk_window_new(root, &attributes,
+                                     GDK_WA_X | GDK_WA_Y | GDK_WA_NOREDIR);
+    xid = GDK_WINDOW_XID(wm_check_window);
+
+    gdk_property_change(wm_check_window,
+                        gdk_atom_intern("_NET_WM_NAME", FALSE),
+                        gdk_atom_intern("UTF8_STRING", FALSE), 8,
+                        GDK_PROP_MODE_REPLACE,
+                        (guchar *)"xfdesktop-test-wm", strlen("xfdesktop-test-wm"));
+    gdk_property_change(wm_check_window,
+                        gdk_atom_intern("_NET_SUPPORTING_WM_CHECK", FALSE),
+                        gdk_atom_intern("WINDOW", FALSE), 32,
+                        GDK_PROP_MODE_REPLACE, (guchar *)&xid, 1);
+    gdk_property_change(root,
+                        gdk_atom_intern("_NET_SUPPORTING_WM_CHECK", FALSE),
+                        gdk_atom_intern("WINDOW", FALSE), 32,
+                        GDK_PROP_MODE_REPLACE, (guchar *)&xid, 1);
+
+    supported[0] = gdk_atom_intern("_NET_SUPPORTING_WM_CHECK", FALSE);
+    supported[1] = gdk_atom_intern("_NET_WM_NAME", FALSE);
+    supported[2] = gdk_atom_intern("_NET_NUMBER_OF_DESKTOPS", FALSE);
+    supported[3] = gdk_atom_intern("_NET_CURRENT_DESKTOP", FALSE);
+    gdk_property_change(root,
+                        gdk_atom_intern("_NET_SUPPORTED", FALSE),
+                        gdk_atom_intern("ATOM", FALSE), 32,
+                        GDK_PROP_MODE_REPLACE, (guchar *)supported,
+                        G_N_ELEMENTS(supported));
+
+    set_root_cardinal("_NET_NUMBER_OF_DESKTOPS", n_workspaces);
+    set_root_cardinal("_NET_CURRENT_DESKTOP", 0);
+
+    gdk_flush();
+}
+
+static void
+fake_wm_switch(gint workspace)
+{
+    set_root_cardinal("_NET_CURRENT_DESKTOP", workspace);
+    gdk_flush();
+}
+
+static void
+fake_wm_stop(void)
+{
+    GdkWindow *root = gdk_get_default_root_window();
+
+    gdk_property_delete(root, gdk_atom_intern("_NET_SUPPORTING_WM_CHECK", FALSE));
+    gdk_property_delete(root, gdk_atom_intern("_NET_SUPPORTED", FALSE));
+    gdk_property_delete(root, gdk_atom_intern("_NET_NUMBER_OF_DESKTOPS", FALSE));
+    gdk_property_delete(root, gdk_atom_intern("_NET_CURRENT_DESKTOP", FALSE));
+
+    gdk_window_destroy(wm_check_window);
+    wm_check_window = NULL;
+
+    gdk_flush();
+}
+
+/* an array of four uint16, the way xfconf_g_property_bind_gdkcolor() stores
+ * colors */
+static GVariant *
+color_variant(guint32 rgb)
+{
+    GVariantBuilder builder;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("av"));
+    g_variant_builder_add(&builder, "v", g_variant_new_uint16(((rgb >> 16) & 0xff) * 0x101));
+    g_variant_builder_add(&builder, "v", g_variant_new_uint16(((rgb >> 8) & 0xff) * 0x101));
+    g_variant_builder_add(&builder, "v", g_variant_new_uint16((rgb & 0xff) * 0x101));
+    g_variant_builder_add(&builder, "v", g_variant_new_uint16(0xffff));
+
+    return g_variant_builder_end(&builder);
+}
+
+/* Sets @setting of the backdrop of @workspace on all monitors.  A floating
+ * @value is consumed */
+static void
+set_workspace_setting(gint workspace,
+                      const gchar *setting,
+                      GVariant *value)
+{
+    GdkScreen *gscreen = gdk_screen_get_default();
+    gint i;
+
+    g_variant_ref_sink(value);
+
+    for(i = 0; i < gdk_screen_get_n_monitors(gscreen); i++) {
+        gchar *monitor_name = gdk_screen_get_monitor_plug_name(gscreen, i);
+        gchar *property;
+
+        if(monitor_name) {
+            property = g_strdup_printf(PROPERTY_PREFIX "monitor%s/workspace%d/%s",
+                                       monitor_name, workspace, setting);
+        } else {
+            property = g_strdup_printf(PROPERTY_PREFIX "monitor%d/workspace%d/%s",
+                                       i, workspace, setting);
+        }
+
+        xfconf_stand_in_set(CHANNEL, property, value);
+
+        g_free(property);
+        g_free(monitor_name);
+    }
+
+    g_variant_unref(value);
+}
+
+/* Sets the backdrop of @workspace on all monitors, the way the settings
+ * dialog stores it.  Everything is set, so nothing needs migrating */
+static void
+set_workspace_image(gint workspace,
+                    const gchar *filename)
+{
+    set_workspace_setting(workspace, "color-style",
+                          g_variant_new_int32(XFCE_BACKDROP_COLOR_SOLID));
+    set_workspace_setting(workspace, "color1", color_variant(0x000000));
+    set_workspace_setting(workspace, "color2", color_variant(0xffffff));
+    set_workspace_setting(workspace, "image-style",
+                          g_variant_new_int32(XFCE_BACKDROP_IMAGE_STRETCHED));
+    set_workspace_setting(workspace, "last-image", g_variant_new_string(filename));
+}
+
+static GtkWidget *
+create_desktop(XfconfChannel **channel)
+{
+    GtkWidget *desktop;
+
+    /* a channel of its own, so nothing is answered from an earlier one */
+    *channel = xfconf_channel_new(CHANNEL);
+
+    desktop = xfce_desktop_new(gdk_screen_get_default(), *channel, PROPERTY_PREFIX);
+    gtk_widget_realize(desktop);
+
+    return desktop;
+}
+
+static void
+destroy_desktop(GtkWidget *desktop,
+                XfconfChannel *channel)
+{
+    gtk_widget_destroy(desktop);
+    g_object_unref(channel);
+
+    /* let the root window properties settle */
+    run_main_loop_for(100);
+}
+
+/* Returns how long it took until the root pixmap was set, in ms */
+static gdouble
+switch_workspace(gint workspace)
+{
+    guint n_before = n_root_pixmap_updates;
+    gint64 start = g_get_monotonic_time();
+
+    fake_wm_switch(workspace);
+    g_assert(wait_for_root_pixmap(n_before));
+
+    return (last_root_pixmap_update - start) / 1000.0;
+}
+
+/* Backdrops are set up from a single GetAllProperties snapshot, not with a
+ * round-trip to xfconfd for each of their settings */
+static void
+test_desktop_startup_settings(void)
+{
+    XfconfChannel *channel;
+    GtkWidget *desktop;
+    guint n_before;
+
+    fake_wm_switch(0);
+    xfconf_stand_in_reset_calls();
+
+    n_before = n_root_pixmap_updates;
+    desktop = create_desktop(&channel);
+    g_assert(wait_for_root_pixmap(n_before));
+
+    /* the neighbours' backdrops come from the snapshot as well */
+    run_main_loop_for(TEST_SETTLE_TIME);
+    g_assert_cmphex(get_root_pixmap_color(), ==, workspace_colors[0]);
+
+    g_test_message("%u GetAllProperties, %u GetProperty calls",
+                   xfconf_stand_in_get_n_calls("GetAllProperties"),
+                   xfconf_stand_in_get_n_calls("GetProperty"));
+    g_assert_cmpuint(xfconf_stand_in_get_n_calls("GetAllProperties"), >=, 1);
+    g_assert_cmpuint(xfconf_stand_in_get_n_reads(CHANNEL, PROPERTY_BASE), ==, 0);
+
+    destroy_desktop(desktop, channel);
+}
+
+static void
+test_desktop_workspace_switch(void)
+{
+    XfconfChannel *channel;
+    GtkWidget *desktop;
+    gchar *filename;
+    Pixmap before;
+    gdouble painted_ms, unpainted_ms;
+    guint n_before;
+
+    n_before = n_root_pixmap_updates;
+    desktop = create_desktop(&channel);
+
+    /* the first workspace shows up, its neighbours get painted in the
+     * background */
+    g_assert(wait_for_root_pixmap(n_before));
+    run_main_loop_for(TEST_SETTLE_TIME);
+    g_assert_cmphex(get_root_pixmap_color(), ==, workspace_colors[0]);
+
+    /* a neighbour: its pixmap simply replaces the one shown */
+    before = get_root_pixmap();
+    painted_ms = switch_workspace(1);
+    g_assert_cmphex(get_root_pixmap_color(), ==, workspace_colors[1]);
+    g_assert(get_root_pixmap() != before);
+    run_main_loop_for(TEST_SETTLE_TIME);
+
+    /* neither next to the one shown nor visited before: it gets painted on
+     * the spot, once composed */
+    before = get_root_pixmap();
+    unpainted_ms = switch_workspace(3);
+    g_assert_cmphex(get_root_pixmap_color(), ==, workspace_colors[3]);
+    g_assert(get_root_pixmap() == before);
+    run_main_loop_for(TEST_SETTLE_TIME);
+
+    /* the workspace left before is kept as it was */
+    before = get_root_pixmap();
+    switch_workspace(1);
+    g_assert_cmphex(get_root_pixmap_color(), ==, workspace_colors[1]);
+    g_assert(get_root_pixmap() != before);
+
+    g_test_message("switching to a painted workspace took %.1f ms, "
+                   "to an unpainted one %.1f ms", painted_ms, unpainted_ms);
+    g_test_minimized_result(painted_ms,
+                            "switch to a painted workspace: %.1f ms", painted_ms);
+
+    /* what was painted for a workspace goes when its backdrop changes */
+    filename = create_image("changed.png", CHANGED_COLOR);
+    set_workspace_image(2, filename);
+    run_main_loop_for(TEST_SETTLE_TIME);
+    switch_workspace(2);
+    g_assert_cmphex(get_root_pixmap_color(), ==, CHANGED_COLOR);
+    g_free(filename);
+
+    destroy_desktop(desktop, channel);
+}
+
+static void
+assert_pixbufs_equal(GdkPixbuf *a,
+                     GdkPixbuf *b)
+{
+    gint y, row_bytes;
+
+    g_assert_cmpint(gdk_pixbuf_get_width(a), ==, gdk_pixbuf_get_width(b));
+    g_assert_cmpint(gdk_pixbuf_get_height(a), ==, gdk_pixbuf_get_height(b));
+    g_assert_cmpint(gdk_pixbuf_get_n_channels(a), ==, gdk_pixbuf_get_n_channels(b));
+
+    /* the padding at the end of the rows is undefined */
+    row_bytes = gdk_pixbuf_get_width(a) * gdk_pixbuf_get_n_channels(a);
+    for(y = 0; y < gdk_pixbuf_get_height(a); y++) {
+        const guchar *row_a = gdk_pixbuf_get_pixels(a) + y * gdk_pixbuf_get_rowstride(a);
+        const guchar *row_b = gdk_pixbuf_get_pixels(b) + y * gdk_pixbuf_get_rowstride(b);
+
+        if(memcmp(row_a, row_b, row_bytes) != 0)
+            g_error("pixbufs differ in row %d", y);
+    }
+}
+
+/* Opaque backdrops are drawn with gdk_draw_pixbuf() instead of through a
+ * cairo image surface; the root pixmap has to end up with the same pixels
+ * as painting the pixbuf with cairo gave */
+static void
+test_desktop_upload_opaque(void)
+{
+    GdkScreen *gscreen = gdk_screen_get_default();
+    XfconfChannel *channel;
+    GtkWidget *desktop;
+    GdkRectangle geom;
+    GdkPixbuf *image, *expected, *actual;
+    GdkPixmap *pmap;
+    cairo_t *cr;
+    gchar *filename, *old_filename;
+    guint n_before;
+
+    /* an image the size of the monitor is neither scaled nor blended */
+    gdk_screen_get_monitor_geometry(gscreen, 0, &geom);
+    filename = create_noise_image("noise.png", geom.width, geom.height);
+    set_workspace_image(0, filename);
+    fake_wm_switch(0);
+
+    n_before = n_root_pixmap_updates;
+    desktop = create_desktop(&channel);
+    g_assert(wait_for_root_pixmap(n_before));
+    run_main_loop_for(TEST_SETTLE_TIME);
+
+    actual = get_root_pixmap_area(&geom);
+
+    /* what backdrop_changed_cb() used to do */
+    image = gdk_pixbuf_new_from_file(filename, NULL);
+    g_assert(image != NULL);
+    pmap = gdk_pixmap_new(gdk_screen_get_root_window(gscreen),
+                          geom.width, geom.height, -1);
+    cr = gdk_cairo_create(GDK_DRAWABLE(pmap));
+    gdk_cairo_set_source_pixbuf(cr, image, 0, 0);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+    expected = gdk_pixbuf_get_from_drawable(NULL, GDK_DRAWABLE(pmap),
+                                            gdk_screen_get_system_colormap(gscreen),
+                                            0, 0, 0, 0, geom.width, geom.height);
+    g_assert(expected != NULL);
+
+    assert_pixbufs_equal(actual, expected);
+
+    g_object_unref(expected);
+    g_object_unref(pmap);
+    g_object_unref(image);
+    g_object_unref(actual);
+
+    destroy_desktop(desktop, channel);
+
+    old_filename = g_build_filename(test_dir, "workspace0.png", NULL);
+    set_workspace_image(0, old_filename);
+    g_free(old_filename);
+    g_free(filename);
+}
+
+/* Every change of a root window property wakes up each client watching
+ * it.  Backdrops repainted in one go have to share a single update, seen
+ * here by a client of its own, like a terminal with a see-through
+ * background */
+static void
+test_desktop_root_properties_batched(void)
+{
+    static const XfceBackdropColorStyle styles[] = {
+        XFCE_BACKDROP_COLOR_HORIZ_GRADIENT,
+        XFCE_BACKDROP_COLOR_VERT_GRADIENT,
+        XFCE_BACKDROP_COLOR_SOLID,
+        XFCE_BACKDROP_COLOR_HORIZ_GRADIENT,
+        XFCE_BACKDROP_COLOR_VERT_GRADIENT,
+    };
+    XfconfChannel *channel;
+    GtkWidget *desktop;
+    Display *dpy;
+    Atom root_pixmap, image_file;
+    gchar image_file_name[128];
+    guint i, n_before, n_root_pixmap = 0, n_image_file = 0;
+
+    /* plain colors are painted as soon as they change */
+    set_workspace_setting(0, "image-style",
+                          g_variant_new_int32(XFCE_BACKDROP_IMAGE_NONE));
+    fake_wm_switch(0);
+
+    n_before = n_root_pixmap_updates;
+    desktop = create_desktop(&channel);
+    g_assert(wait_for_root_pixmap(n_before));
+    run_main_loop_for(TEST_SETTLE_TIME);
+
+    dpy = XOpenDisplay(gdk_display_get_name(gdk_display_get_default()));
+    g_assert(dpy != NULL);
+    root_pixmap = XInternAtom(dpy, "_XROOTPMAP_ID", False);
+    g_snprintf(image_file_name, sizeof(image_file_name), XFDESKTOP_IMAGE_FILE_FMT, 0);
+    image_file = XInternAtom(dpy, image_file_name, False);
+    XSelectInput(dpy, DefaultRootWindow(dpy), PropertyChangeMask);
+    XSync(dpy, False);
+
+    for(i = 0; i < G_N_ELEMENTS(styles); i++)
+        set_workspace_setting(0, "color-style", g_variant_new_int32(styles[i]));
+
+    /* all the changes are there before the desktop gets to any of them */
+    g_usleep(200 * 1000);
+    run_main_loop_for(TEST_SETTLE_TIME);
+    gdk_flush();
+    XSync(dpy, False);
+
+    while(XPending(dpy)) {
+        XEvent xevent;
+
+        XNextEvent(dpy, &xevent);
+        if(xevent.type != PropertyNotify
+           || xevent.xproperty.state != PropertyNewValue)
+        {
+            continue;
+        }
+
+        if(xevent.xproperty.atom == root_pixmap)
+            n_root_pixmap++;
+        else if(xevent.xproperty.atom == image_file)
+            n_image_file++;
+    }
+
+    XCloseDisplay(dpy);
+
+    g_test_message("%u color changes, %u _XROOTPMAP_ID and %u %s updates",
+                   (guint)G_N_ELEMENTS(styles), n_root_pixmap, n_image_file,
+                   image_file_name);
+    g_assert_cmpuint(n_root_pixmap, ==, 1);
+    /* deleting a property that isn't there doesn't notify anyone */
+    g_assert_cmpuint(n_image_file, <=, 1);
+
+    destroy_desktop(desktop, channel);
+
+    set_workspace_setting(0, "color-style",
+                          g_variant_new_int32(XFCE_BACKDROP_COLOR_SOLID));
+    set_workspace_setting(0, "image-style",
+                          g_variant_new_int32(XFCE_BACKDROP_IMAGE_STRETCHED));
+}
+
+static void
+setup_settings(void)
+{
+    gint i;
+
+    /* no icons, they'd want a file manager */
+    xfconf_stand_in_set(CHANNEL, "/desktop-icons/style",
+                        g_variant_new_int32(XFCE_DESKTOP_ICON_STYLE_NONE));
+    xfconf_stand_in_set(CHANNEL, BACKDROP_CROSSFADE, g_variant_new_boolean(FALSE));
+
+    for(i = 0; i < N_WORKSPACES; i++) {
+        gchar *name = g_strdup_printf("workspace%d.png", i);
+        gchar *filename = create_image(name, workspace_colors[i]);
+
+        set_workspace_image(i, filename);
+
+        g_free(filename);
+        g_free(name);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    gchar *cache_home;
+    int ret;
+
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+    if(!g_thread_supported())
+        g_thread_init(NULL);
+#endif
+
+    test_dir = g_dir_make_tmp("xfdesktop-test-XXXXXX", NULL);
+    g_assert(test_dir != NULL);
+
+    /* before anything looks up the cache directory */
+    cache_home = g_build_filename(test_dir, "cache", NULL);
+    g_setenv("XDG_CACHE_HOME", cache_home, TRUE);
+    g_free(cache_home);
+
+    if(!gtk_init_check(&argc, &argv) || !xfconf_stand_in_start()) {
+        remove_dir(test_dir);
+        return 77;
+    }
+
+    if(!xfconf_init(NULL)) {
+        xfconf_stand_in_stop();
+        remove_dir(test_dir);
+        return 77;
+    }
+
+    g_test_init(&argc, &argv, NULL);
+
+    /* libwnck and xfconf have warnings of their own about the unusual
+     * setup, only criticals count */
+    g_log_set_always_fatal(G_LOG_FATAL_MASK | G_LOG_LEVEL_CRITICAL);
+
+    setup_settings();
+    watch_root_window();
+    fake_wm_start(N_WORKSPACES);
+
+    g_test_add_func("/desktop/startup-settings",
+                    test_desktop_startup_settings);
+    g_test_add_func("/desktop/workspace-switch",
+                    test_desktop_workspace_switch);
+    g_test_add_func("/desktop/upload/opaque",
+                    test_desktop_upload_opaque);
+    g_test_add_func("/desktop/root-properties/batched",
+                    test_desktop_root_properties_batched);
+
+    ret = g_test_run();
+
+    fake_wm_stop();
+    xfconf_shutdown();
+    xfconf_stand_in_stop();
+    remove_dir(test_dir);
+    g_free(test_dir);
+
+    return ret;
+}
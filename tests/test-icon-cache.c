@@ -0,0 +1,244 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* Checks that xfdesktop_file_utils_get_icon() composes each themed icon
+ * once per size and hands out the same pixbuf afterwards, also when the
+ * lookups come from lots of file icons of the same type. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+
+#include "xfdesktop-common.h"
+#include "xfdesktop-file-utils.h"
+#include "xfdesktop-regular-file-icon.h"
+
+#define TEST_ICON_NAME  "xfdesktop-test-icon"
+#define N_TEXT_FILES    1000
+
+/* the mime type icon of text files, provided here so that the test doesn't
+ * depend on the installed icon theme */
+static const gchar *icon_names[] = {
+    TEST_ICON_NAME,
+    "text-plain",
+};
+
+static gchar *icon_dir = NULL;
+
+static void
+setup_icon_dir(void)
+{
+    GdkPixbuf *pix;
+    gchar *filename, *basename;
+    guint i;
+
+    icon_dir = g_dir_make_tmp("xfdesktop-test-XXXXXX", NULL);
+    g_assert(icon_dir != NULL);
+
+    /* unthemed icons are looked up directly in the search path */
+    pix = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, 48, 48);
+    gdk_pixbuf_fill(pix, 0x3465a4ff);
+    for(i = 0; i < G_N_ELEMENTS(icon_names); i++) {
+        basename = g_strconcat(icon_names[i], ".png", NULL);
+        filename = g_build_filename(icon_dir, basename, NULL);
+        g_assert(gdk_pixbuf_save(pix, filename, "png", NULL, NULL));
+        g_free(filename);
+        g_free(basename);
+    }
+    g_object_unref(pix);
+
+    gtk_icon_theme_append_search_path(gtk_icon_theme_get_default(), icon_dir);
+}
+
+static void
+teardown_icon_dir(void)
+{
+    gchar *filename, *basename;
+    guint i;
+
+    for(i = 0; i < G_N_ELEMENTS(icon_names); i++) {
+        basename = g_strconcat(icon_names[i], ".png", NULL);
+        filename = g_build_filename(icon_dir, basename, NULL);
+        g_unlink(filename);
+        g_free(filename);
+        g_free(basename);
+    }
+
+    g_rmdir(icon_dir);
+    g_free(icon_dir);
+}
+
+static void
+test_icon_cache_hits(void)
+{
+    GIcon *gicon;
+    GdkPixbuf *pix1, *pix2, *pix3;
+    guint hits, misses, hits0, misses0;
+
+    xfdesktop_file_utils_clear_icon_cache();
+    xfdesktop_file_utils_get_icon_cache_stats(&hits0, &misses0);
+
+    gicon = g_themed_icon_new(TEST_ICON_NAME);
+
+    pix1 = xfdesktop_file_utils_get_icon(gicon, 32, 32, 100);
+    g_assert(pix1 != NULL);
+    xfdesktop_file_utils_get_icon_cache_stats(&hits, &misses);
+    g_assert_cmpuint(hits - hits0, ==, 0);
+    g_assert_cmpuint(misses - misses0, ==, 1);
+
+    /* same key: the very same pixbuf */
+    pix2 = xfdesktop_file_utils_get_icon(gicon, 32, 32, 100);
+    g_assert(pix2 == pix1);
+    g_assert_cmpuint(xfdesktop_file_utils_get_icon_cache_stats(&hits, &misses), ==, 1);
+    g_assert_cmpuint(hits - hits0, ==, 1);
+    g_assert_cmpuint(misses - misses0, ==, 1);
+
+    /* another opacity is another entry */
+    pix3 = xfdesktop_file_utils_get_icon(gicon, 32, 32, 50);
+    g_assert(pix3 != pix1);
+    g_assert_cmpuint(xfdesktop_file_utils_get_icon_cache_stats(&hits, &misses), ==, 2);
+    g_assert_cmpuint(misses - misses0, ==, 2);
+
+    /* entries go away with their last user */
+    g_object_unref(pix1);
+    g_object_unref(pix2);
+    g_object_unref(pix3);
+    g_assert_cmpuint(xfdesktop_file_utils_get_icon_cache_stats(NULL, NULL), ==, 0);
+
+    g_object_unref(gicon);
+}
+
+static void
+test_icon_cache_clear(void)
+{
+    GIcon *gicon;
+    GdkPixbuf *pix1, *pix2;
+    guint misses, misses0;
+
+    gicon = g_themed_icon_new(TEST_ICON_NAME);
+
+    pix1 = xfdesktop_file_utils_get_icon(gicon, 24, 24, 100);
+    xfdesktop_file_utils_get_icon_cache_stats(NULL, &misses0);
+
+    /* as done on icon theme changes: the old pixbuf stays usable, but the
+     * next lookup loads the icon again */
+    xfdesktop_file_utils_clear_icon_cache();
+    g_assert_cmpuint(xfdesktop_file_utils_get_icon_cache_stats(NULL, NULL), ==, 0);
+
+    pix2 = xfdesktop_file_utils_get_icon(gicon, 24, 24, 100);
+    xfdesktop_file_utils_get_icon_cache_stats(NULL, &misses);
+    g_assert(pix2 != pix1);
+    g_assert_cmpuint(misses - misses0, ==, 1);
+    g_assert_cmpint(gdk_pixbuf_get_width(pix1), ==, 24);
+
+    g_object_unref(pix1);
+    g_object_unref(pix2);
+    g_object_unref(gicon);
+}
+
+static void
+test_icon_cache_text_files(void)
+{
+    XfdesktopIcon *icons[N_TEXT_FILES];
+    GdkPixbuf *pix, *first_pix = NULL;
+    gchar *text_dir, *filename, *basename;
+    guint hits, misses, hits0, misses0, i;
+
+    text_dir = g_dir_make_tmp("xfdesktop-test-XXXXXX", NULL);
+    g_assert(text_dir != NULL);
+
+    xfdesktop_file_utils_clear_icon_cache();
+    xfdesktop_file_utils_get_icon_cache_stats(&hits0, &misses0);
+
+    /* the same way the file icon manager creates them for a folder full of
+     * text files */
+    for(i = 0; i < N_TEXT_FILES; i++) {
+        GFile *file;
+        GFileInfo *info;
+
+        basename = g_strdup_printf("file-%04u.txt", i);
+        filename = g_build_filename(text_dir, basename, NULL);
+        g_assert(g_file_set_contents(filename, "some text\n", -1, NULL));
+
+        file = g_file_new_for_path(filename);
+        info = g_file_query_info(file, XFDESKTOP_FILE_INFO_NAMESPACE,
+                                 G_FILE_QUERY_INFO_NONE, NULL, NULL);
+        g_assert(info != NULL);
+
+        icons[i] = XFDESKTOP_ICON(xfdesktop_regular_file_icon_new(file, info,
+                                                                  gdk_screen_get_default(),
+                                                                  NULL));
+        g_assert(icons[i] != NULL);
+
+        pix = xfdesktop_icon_peek_pixbuf(icons[i], 32, 32);
+        g_assert(pix != NULL);
+        if(!first_pix)
+            first_pix = pix;
+        g_assert(pix == first_pix);
+
+        g_object_unref(info);
+        g_object_unref(file);
+        g_free(filename);
+        g_free(basename);
+    }
+
+    /* one theme load, everything else is served from the cache */
+    g_assert_cmpuint(xfdesktop_file_utils_get_icon_cache_stats(&hits, &misses), ==, 1);
+    g_assert_cmpuint(misses - misses0, ==, 1);
+    g_assert_cmpuint(hits - hits0, ==, N_TEXT_FILES - 1);
+
+    for(i = 0; i < N_TEXT_FILES; i++) {
+        basename = g_strdup_printf("file-%04u.txt", i);
+        filename = g_build_filename(text_dir, basename, NULL);
+        g_unlink(filename);
+        g_free(filename);
+        g_free(basename);
+
+        g_object_unref(icons[i]);
+    }
+    g_assert_cmpuint(xfdesktop_file_utils_get_icon_cache_stats(NULL, NULL), ==, 0);
+
+    g_rmdir(text_dir);
+    g_free(text_dir);
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+    if(!gtk_init_check(&argc, &argv))
+        return 77;
+
+    g_test_init(&argc, &argv, NULL);
+
+    setup_icon_dir();
+
+    g_test_add_func("/icon-cache/hits", test_icon_cache_hits);
+    g_test_add_func("/icon-cache/clear", test_icon_cache_clear);
+    g_test_add_func("/icon-cache/text-files", test_icon_cache_text_files);
+
+    ret = g_test_run();
+
+    teardown_icon_dir();
+
+    return ret;
+}
@@ -0,0 +1,547 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* Lays out a grid of plain icons in an XfdesktopIconView on a window
+ * covering the screen and exposes small parts of it.  An expose repaints
+ * just the icons it overlaps, also when that is the label of an icon
+ * reaching down into the cells below its own.  Icons kept in a retained
+ * layer look the same as icons painted straight to the window, and the
+ * layer is painted again after the monitors change.
+ *
+ * Needs an X display and a private session bus for the stand-in xfconfd:
+ *   dbus-run-session -- xvfb-run -a -s '-screen 0 1024x768x24' ./test-icon-view
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+#include <xfconf/xfconf.h>
+
+#include "xfdesktop-icon.h"
+#include "xfdesktop-icon-view.h"
+#include "xfdesktop-icon-view-manager.h"
+#include "xfconf-stand-in.h"
+
+#define N_ROWS           3
+#define N_COLS           4
+/* the column below the long label is kept free */
+#define LONG_LABEL_COL   1
+
+#define ICON_COLOR       0x3465a4ff
+/* the retained layer is premultiplied, so translucent label boxes and
+ * shadows can be off by some rounding */
+#define PIXEL_TOLERANCE  2
+#define WINDOW_COLOR     { 0, 0x2e2e, 0x3434, 0x3636 }
+
+/* selected icons show their label in full, this one reaches several
+ * cells down */
+#define LONG_LABEL \
+    "a label long enough to wrap over many more lines than fit into the " \
+    "cell of its icon, at least once it is selected and shown in full, " \
+    "so that it reaches down into the cells below; a label long enough " \
+    "to wrap over many more lines than fit into the cell of its icon, " \
+    "at least once it is selected and shown in full"
+
+
+/* a solid square and a label */
+
+#define TEST_TYPE_ICON  (test_icon_get_type())
+#define TEST_ICON(obj)  (G_TYPE_CHECK_INSTANCE_CAST((obj), TEST_TYPE_ICON, TestIcon))
+
+typedef struct
+{
+    XfdesktopIcon parent;
+
+    gchar *label;
+} TestIcon;
+
+typedef struct
+{
+    XfdesktopIconClass parent;
+} TestIconClass;
+
+GType test_icon_get_type(void) G_GNUC_CONST;
+
+G_DEFINE_TYPE(TestIcon, test_icon, XFDESKTOP_TYPE_ICON)
+
+static GdkPixbuf *
+test_icon_peek_pixbuf(XfdesktopIcon *icon,
+                      gint width,
+                      gint height)
+{
+    GdkPixbuf *pix = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, height, height);
+
+    gdk_pixbuf_fill(pix, ICON_COLOR);
+
+    return pix;
+}
+
+static const gchar *
+test_icon_peek_label(XfdesktopIcon *icon)
+{
+    return TEST_ICON(icon)->label;
+}
+
+static gchar *
+test_icon_get_identifier(XfdesktopIcon *icon)
+{
+    return g_strdup(TEST_ICON(icon)->label);
+}
+
+static void
+test_icon_finalize(GObject *obj)
+{
+    g_free(TEST_ICON(obj)->label);
+
+    G_OBJECT_CLASS(test_icon_parent_class)->finalize(obj);
+}
+
+static void
+test_icon_class_init(TestIconClass *klass)
+{
+    GObjectClass *gobject_class = (GObjectClass *)klass;
+    XfdesktopIconClass *icon_class = (XfdesktopIconClass *)klass;
+
+    gobject_class->finalize = test_icon_finalize;
+
+    icon_class->peek_pixbuf = test_icon_peek_pixbuf;
+    icon_class->peek_label = test_icon_peek_label;
+    icon_class->get_identifier = test_icon_get_identifier;
+}
+
+static void
+test_icon_init(TestIcon *icon)
+{
+}
+
+
+/* icons are added by the tests themselves */
+
+#define TEST_TYPE_MANAGER  (test_manager_get_type())
+
+typedef GObject       TestManager;
+typedef GObjectClass  TestManagerClass;
+
+GType test_manager_get_type(void) G_GNUC_CONST;
+static void test_manager_iface_init(XfdesktopIconViewManagerIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(TestManager, test_manager, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(XFDESKTOP_TYPE_ICON_VIEW_MANAGER,
+                                              test_manager_iface_init))
+
+static gboolean
+test_manager_real_init(XfdesktopIconViewManager *manager,
+                       XfdesktopIconView *icon_view)
+{
+    return TRUE;
+}
+
+static void
+test_manager_real_fini(XfdesktopIconViewManager *manager)
+{
+}
+
+static void
+test_manager_iface_init(XfdesktopIconViewManagerIface *iface)
+{
+    iface->manager_init = test_manager_real_init;
+    iface->manager_fini = test_manager_real_fini;
+}
+
+static void
+test_manager_class_init(TestManagerClass *klass)
+{
+}
+
+static void
+test_manager_init(TestManager *manager)
+{
+}
+
+
+typedef struct
+{
+    GtkWidget *window;
+    XfdesktopIconView *icon_view;
+    /* NULL where a cell is left free */
+    XfdesktopIcon *icons[N_ROWS][N_COLS];
+    guint n_icons;
+} IconGrid;
+
+static gboolean
+wake_up(gpointer data)
+{
+    return TRUE;
+}
+
+static void
+run_main_loop_for(guint ms)
+{
+    gint64 end = g_get_monotonic_time() + ms * 1000;
+    guint waker = g_timeout_add(20, wake_up, NULL);
+
+    while(g_get_monotonic_time() < end)
+        g_main_context_iteration(NULL, TRUE);
+
+    g_source_remove(waker);
+}
+
+static XfdesktopIcon *
+add_icon(IconGrid *grid,
+         gint16 row,
+         gint16 col,
+         const gchar *label)
+{
+    TestIcon *icon = g_object_new(TEST_TYPE_ICON, NULL);
+
+    icon->label = g_strdup(label);
+    xfdesktop_icon_set_position(XFDESKTOP_ICON(icon), row, col);
+    xfdesktop_icon_view_add_item(grid->icon_view, XFDESKTOP_ICON(icon));
+
+    /* the icon view holds on to it */
+    g_object_unref(icon);
+
+    grid->icons[row][col] = XFDESKTOP_ICON(icon);
+    grid->n_icons++;
+
+    return XFDESKTOP_ICON(icon);
+}
+
+/* A window covering the screen, like the desktop's, with a grid of icons
+ * that have short labels, except for the selected one at the top of
+ * LONG_LABEL_COL */
+static void
+create_icon_grid(IconGrid *grid)
+{
+    GdkScreen *gscreen = gdk_screen_get_default();
+    GdkColor color = WINDOW_COLOR;
+    gint16 row, col;
+
+    memset(grid, 0, sizeof(*grid));
+
+    grid->window = gtk_window_new(GTK_WINDOW_POPUP);
+    gtk_window_move(GTK_WINDOW(grid->window), 0, 0);
+    gtk_widget_set_size_request(grid->window,
+                                gdk_screen_get_width(gscreen),
+                                gdk_screen_get_height(gscreen));
+    gtk_widget_modify_bg(grid->window, GTK_STATE_NORMAL, &color);
+
+    grid->icon_view = XFDESKTOP_ICON_VIEW(xfdesktop_icon_view_new(g_object_new(TEST_TYPE_MANAGER,
+                                                                               NULL)));
+    gtk_container_add(GTK_CONTAINER(grid->window), GTK_WIDGET(grid->icon_view));
+    gtk_widget_show_all(grid->window);
+
+    for(row = 0; row < N_ROWS; row++) {
+        for(col = 0; col < N_COLS; col++) {
+            gchar *label;
+
+            if(col == LONG_LABEL_COL && row > 0)
+                continue;
+
+            if(col == LONG_LABEL_COL) {
+                xfdesktop_icon_view_select_item(grid->icon_view,
+                                                add_icon(grid, row, col, LONG_LABEL));
+                continue;
+            }
+
+            label = g_strdup_printf("%d,%d", row, col);
+            add_icon(grid, row, col, label);
+            g_free(label);
+        }
+    }
+
+    /* mapped, painted and the extents of every icon known */
+    gdk_flush();
+    run_main_loop_for(300);
+}
+
+static void
+destroy_icon_grid(IconGrid *grid)
+{
+    gtk_widget_destroy(grid->window);
+    run_main_loop_for(50);
+}
+
+static void
+get_total_extents(IconGrid *grid,
+                  gint16 row,
+                  gint16 col,
+                  GdkRectangle *extents)
+{
+    g_assert(grid->icons[row][col] != NULL);
+    g_assert(xfdesktop_icon_get_extents(grid->icons[row][col],
+                                        NULL, NULL, extents));
+}
+
+static void
+get_pixbuf_extents(IconGrid *grid,
+                   gint16 row,
+                   gint16 col,
+                   GdkRectangle *extents)
+{
+    g_assert(grid->icons[row][col] != NULL);
+    g_assert(xfdesktop_icon_get_extents(grid->icons[row][col],
+                                        extents, NULL, NULL));
+}
+
+/* Exposes @area of the window, which is where the screen is, right away,
+ * and returns how many icons that repainted */
+static guint
+expose_area(IconGrid *grid,
+            gint x,
+            gint y,
+            gint width,
+            gint height)
+{
+    GdkWindow *window = gtk_widget_get_window(grid->window);
+    GdkRectangle area = { x, y, width, height };
+
+    gdk_window_invalidate_rect(window, &area, TRUE);
+    gdk_window_process_updates(window, TRUE);
+
+    return xfdesktop_icon_view_get_n_repainted_icons(grid->icon_view);
+}
+
+static void
+expose_screen(IconGrid *grid)
+{
+    GdkScreen *gscreen = gdk_screen_get_default();
+
+    expose_area(grid, 0, 0, gdk_screen_get_width(gscreen),
+                gdk_screen_get_height(gscreen));
+}
+
+/* what is on the screen, the window covers all of it */
+static GdkPixbuf *
+get_screen_pixels(IconGrid *grid)
+{
+    GdkScreen *gscreen = gdk_screen_get_default();
+    GdkPixbuf *pix;
+
+    gdk_flush();
+    pix = gdk_pixbuf_get_from_drawable(NULL,
+                                       GDK_DRAWABLE(gtk_widget_get_window(grid->window)),
+                                       NULL, 0, 0, 0, 0,
+                                       gdk_screen_get_width(gscreen),
+                                       gdk_screen_get_height(gscreen));
+    g_assert(pix != NULL);
+
+    return pix;
+}
+
+/* Fails if any channel of any pixel is off by more than PIXEL_TOLERANCE,
+ * returns the largest difference */
+static gint
+assert_pixels_close(GdkPixbuf *a,
+                    GdkPixbuf *b)
+{
+    gint n_channels = gdk_pixbuf_get_n_channels(a);
+    gint x, y, c, max_diff = 0;
+
+    g_assert_cmpint(gdk_pixbuf_get_width(a), ==, gdk_pixbuf_get_width(b));
+    g_assert_cmpint(gdk_pixbuf_get_height(a), ==, gdk_pixbuf_get_height(b));
+    g_assert_cmpint(n_channels, ==, gdk_pixbuf_get_n_channels(b));
+
+    for(y = 0; y < gdk_pixbuf_get_height(a); y++) {
+        const guchar *row_a = gdk_pixbuf_get_pixels(a) + y * gdk_pixbuf_get_rowstride(a);
+        const guchar *row_b = gdk_pixbuf_get_pixels(b) + y * gdk_pixbuf_get_rowstride(b);
+
+        for(x = 0; x < gdk_pixbuf_get_width(a); x++) {
+            for(c = 0; c < n_channels; c++) {
+                gint diff = ABS(row_a[x * n_channels + c] - row_b[x * n_channels + c]);
+
+                if(diff > PIXEL_TOLERANCE)
+                    g_error("pixel %d,%d differs by %d", x, y, diff);
+                max_diff = MAX(max_diff, diff);
+            }
+        }
+    }
+
+    return max_diff;
+}
+
+/* A few pixels in the middle of an icon, then across two neighbouring
+ * ones, repaint just those out of the grid */
+static void
+test_icon_view_repaint_overlapping(void)
+{
+    IconGrid grid;
+    GdkRectangle a, b;
+
+    create_icon_grid(&grid);
+
+    get_pixbuf_extents(&grid, 1, 2, &a);
+    g_assert_cmpuint(expose_area(&grid, a.x + a.width / 2, a.y + a.height / 2, 4, 4),
+                     ==, 1);
+
+    get_pixbuf_extents(&grid, 1, 3, &b);
+    g_assert_cmpuint(expose_area(&grid,
+                                 a.x + a.width / 2, a.y + a.height / 2,
+                                 b.x - a.x, 4),
+                     ==, 2);
+
+    /* between the rows, where no icon reaches */
+    get_total_extents(&grid, 1, 2, &a);
+    get_total_extents(&grid, 2, 2, &b);
+    g_assert_cmpint(a.y + a.height, <, b.y);
+    g_assert_cmpuint(expose_area(&grid, a.x + a.width / 2, a.y + a.height,
+                                 2, b.y - (a.y + a.height)),
+                     ==, 0);
+
+    /* the whole screen */
+    g_assert_cmpuint(expose_area(&grid, 0, 0,
+                                 gdk_screen_get_width(gdk_screen_get_default()),
+                                 gdk_screen_get_height(gdk_screen_get_default())),
+                     ==, grid.n_icons);
+
+    destroy_icon_grid(&grid);
+}
+
+/* The bottom of the long label is in a cell further down its column,
+ * where no icon sits.  Exposing it repaints that one icon, found by
+ * walking the cells its label can reach */
+static void
+test_icon_view_repaint_label_overflow(void)
+{
+    IconGrid grid;
+    GdkRectangle label, below;
+    gint x, y;
+
+    create_icon_grid(&grid);
+
+    get_total_extents(&grid, 0, LONG_LABEL_COL, &label);
+    x = label.x + label.width / 2;
+    y = label.y + label.height - 3;
+
+    /* well into the row below, next to the pixbuf of the icon there */
+    get_pixbuf_extents(&grid, 1, LONG_LABEL_COL - 1, &below);
+    g_assert_cmpint(y, >, below.y + below.height);
+
+    g_assert_cmpuint(expose_area(&grid, x, y, 2, 2), ==, 1);
+
+    destroy_icon_grid(&grid);
+}
+
+/* The same icons, painted straight to the window and then composited
+ * from the retained layer, end up as the same pixels */
+static void
+test_icon_view_retained_layer_pixels(void)
+{
+    IconGrid grid;
+    GdkPixbuf *direct, *retained;
+
+    create_icon_grid(&grid);
+
+    expose_screen(&grid);
+    direct = get_screen_pixels(&grid);
+
+    g_object_set(grid.icon_view, "retained-layer", TRUE, NULL);
+    expose_screen(&grid);
+    retained = get_screen_pixels(&grid);
+
+    if(!gdk_screen_get_rgba_colormap(gdk_screen_get_default()))
+        g_test_message("no ARGB visual, icons were painted directly both times");
+
+    g_test_message("largest difference %d", assert_pixels_close(direct, retained));
+
+    g_object_unref(direct);
+    g_object_unref(retained);
+
+    destroy_icon_grid(&grid);
+}
+
+/* An expose only composites the retained layer, without painting icons,
+ * until the monitors change: the layers are per monitor and get painted
+ * again, the same way */
+static void
+test_icon_view_retained_layer_monitors_changed(void)
+{
+    IconGrid grid;
+    GdkPixbuf *before, *after;
+
+    if(!gdk_screen_get_rgba_colormap(gdk_screen_get_default())) {
+        g_test_message("no ARGB visual, nothing is retained");
+        return;
+    }
+
+    create_icon_grid(&grid);
+
+    g_object_set(grid.icon_view, "retained-layer", TRUE, NULL);
+    g_assert_cmpuint(expose_area(&grid, 0, 0, 1, 1), ==, grid.n_icons);
+    expose_screen(&grid);
+    g_assert_cmpuint(xfdesktop_icon_view_get_n_repainted_icons(grid.icon_view),
+                     ==, 0);
+    before = get_screen_pixels(&grid);
+
+    g_signal_emit_by_name(gdk_screen_get_default(), "monitors-changed");
+
+    expose_screen(&grid);
+    g_assert_cmpuint(xfdesktop_icon_view_get_n_repainted_icons(grid.icon_view),
+                     ==, grid.n_icons);
+    after = get_screen_pixels(&grid);
+
+    g_test_message("largest difference %d", assert_pixels_close(before, after));
+
+    g_object_unref(before);
+    g_object_unref(after);
+
+    destroy_icon_grid(&grid);
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+    if(!g_thread_supported())
+        g_thread_init(NULL);
+#endif
+
+    if(!gtk_init_check(&argc, &argv) || !xfconf_stand_in_start())
+        return 77;
+
+    if(!xfconf_init(NULL)) {
+        xfconf_stand_in_stop();
+        return 77;
+    }
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_log_set_always_fatal(G_LOG_FATAL_MASK | G_LOG_LEVEL_CRITICAL);
+
+    g_test_add_func("/icon-view/repaint/overlapping",
+                    test_icon_view_repaint_overlapping);
+    g_test_add_func("/icon-view/repaint/label-overflow",
+                    test_icon_view_repaint_label_overflow);
+    g_test_add_func("/icon-view/retained-layer/pixels",
+                    test_icon_view_retained_layer_pixels);
+    g_test_add_func("/icon-view/retained-layer/monitors-changed",
+                    test_icon_view_retained_layer_monitors_changed);
+
+    ret = g_test_run();
+
+    xfconf_shutdown();
+    xfconf_stand_in_stop();
+
+    return ret;
+}
@@ -0,0 +1,465 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* Feeds XfceWorkspace made up monitor layouts, the way hot-plugging and
+ * rearranging monitors changes them, and checks which backdrops are kept.
+ * Monitors are matched by plug name wherever they moved to, even with a
+ * new resolution; unnamed ones only by index and geometry.  Kept backdrops
+ * hold on to their image instead of loading it again.
+ *
+ * Needs an X display and a private session bus:
+ *   dbus-run-session -- xvfb-run -a ./test-workspace
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+#include <xfconf/xfconf.h>
+
+#include "xfce-workspace.h"
+#include "xfconf-stand-in.h"
+
+#define TEST_TIMEOUT      10  /* seconds */
+
+#define CHANNEL           "xfce4-desktop"
+#define PROPERTY_PREFIX   "/backdrop/screen0/"
+#define PROPERTY_BASE     "/backdrop/screen0"
+
+/* the monitors the tests plug in; unnamed ones are bound by their index */
+static const gchar *monitor_names[] = {
+    "DP-1", "DP-2", "HDMI-1", "0", "1",
+};
+
+static gchar *test_dir = NULL;
+
+static void
+remove_dir(const gchar *path)
+{
+    GDir *dir = g_dir_open(path, 0, NULL);
+    const gchar *name;
+
+    if(dir) {
+        while((name = g_dir_read_name(dir))) {
+            gchar *child = g_build_filename(path, name, NULL);
+
+            if(g_file_test(child, G_FILE_TEST_IS_DIR))
+                remove_dir(child);
+            else
+                g_unlink(child);
+            g_free(child);
+        }
+        g_dir_close(dir);
+    }
+
+    g_rmdir(path);
+}
+
+static gchar *
+get_image_path(const gchar *monitor_name)
+{
+    gchar *name = g_strdup_printf("%s.png", monitor_name);
+    gchar *filename = g_build_filename(test_dir, name, NULL);
+
+    g_free(name);
+
+    return filename;
+}
+
+static GVariant *
+color_variant(guint16 gray)
+{
+    GVariantBuilder builder;
+    gint i;
+
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("av"));
+    for(i = 0; i < 3; i++)
+        g_variant_builder_add(&builder, "v", g_variant_new_uint16(gray));
+    g_variant_builder_add(&builder, "v", g_variant_new_uint16(0xffff));
+
+    return g_variant_builder_end(&builder);
+}
+
+static void
+set_monitor_setting(const gchar *monitor_name,
+                    const gchar *setting,
+                    GVariant *value)
+{
+    gchar *property = g_strdup_printf(PROPERTY_PREFIX "monitor%s/workspace0/%s",
+                                      monitor_name, setting);
+
+    xfconf_stand_in_set(CHANNEL, property, value);
+    g_free(property);
+}
+
+/* a distinct image for every monitor, and everything else set as well so
+ * nothing needs migrating */
+static void
+setup_settings(void)
+{
+    guint i;
+
+    for(i = 0; i < G_N_ELEMENTS(monitor_names); i++) {
+        GdkPixbuf *pix = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, 32, 24);
+        gchar *filename = get_image_path(monitor_names[i]);
+
+        gdk_pixbuf_fill(pix, (guint32)(0x20 + i * 0x30) << 24 | 0xff);
+        g_assert(gdk_pixbuf_save(pix, filename, "png", NULL, NULL));
+        g_object_unref(pix);
+
+        set_monitor_setting(monitor_names[i], "color-style",
+                            g_variant_new_int32(XFCE_BACKDROP_COLOR_SOLID));
+        set_monitor_setting(monitor_names[i], "color1", color_variant(0x0000));
+        set_monitor_setting(monitor_names[i], "color2", color_variant(0xffff));
+        set_monitor_setting(monitor_names[i], "image-style",
+                            g_variant_new_int32(XFCE_BACKDROP_IMAGE_STRETCHED));
+        set_monitor_setting(monitor_names[i], "last-image",
+                            g_variant_new_string(filename));
+
+        g_free(filename);
+    }
+}
+
+static XfceWorkspace *
+create_workspace(XfconfChannel **channel)
+{
+    XfceWorkspace *workspace;
+    GHashTable *settings;
+
+    *channel = xfconf_channel_new(CHANNEL);
+    settings = xfconf_channel_get_properties(*channel, PROPERTY_BASE);
+    g_assert(settings != NULL);
+
+    workspace = xfce_workspace_new(gdk_screen_get_default(), *channel,
+                                   settings, PROPERTY_PREFIX, 0);
+    g_hash_table_unref(settings);
+
+    return workspace;
+}
+
+static void
+destroy_workspace(XfceWorkspace *workspace,
+                  XfconfChannel *channel)
+{
+    g_object_unref(workspace);
+    g_object_unref(channel);
+}
+
+static void
+set_monitor(XfceWorkspaceMonitor *monitor,
+            const gchar *name,
+            gint x,
+            gint y,
+            gint width,
+            gint height)
+{
+    monitor->name = (gchar *)name;
+    monitor->geometry.x = x;
+    monitor->geometry.y = y;
+    monitor->geometry.width = width;
+    monitor->geometry.height = height;
+}
+
+static gboolean
+timeout_cb(gpointer user_data)
+{
+    g_assert_not_reached();
+    return FALSE;
+}
+
+/* composes the backdrop the way the desktop does once it knows the size of
+ * its monitor */
+static void
+load_backdrop(XfceBackdrop *backdrop,
+              gint width,
+              gint height)
+{
+    guint timeout_id = g_timeout_add_seconds(TEST_TIMEOUT, timeout_cb, NULL);
+    GdkPixbuf *pix;
+
+    xfce_backdrop_set_size(backdrop, width, height);
+    xfce_backdrop_generate_async(backdrop);
+    while(xfce_backdrop_is_generating(backdrop))
+        g_main_context_iteration(NULL, TRUE);
+    g_source_remove(timeout_id);
+
+    pix = xfce_backdrop_get_pixbuf(backdrop);
+    g_assert(pix != NULL);
+    g_object_unref(pix);
+}
+
+/* the backdrop shows @monitor_name's image, so it's bound to its settings */
+static void
+assert_backdrop_for(XfceBackdrop *backdrop,
+                    const gchar *monitor_name)
+{
+    gchar *filename = get_image_path(monitor_name);
+
+    g_assert(backdrop != NULL);
+    g_assert_cmpstr(xfce_backdrop_get_image_filename(backdrop), ==, filename);
+
+    g_free(filename);
+}
+
+/* still has the pixbuf it had, and isn't loading anything */
+static void
+assert_backdrop_unchanged(XfceBackdrop *backdrop,
+                          GdkPixbuf *old_pix,
+                          guint n_decodes)
+{
+    GdkPixbuf *pix = xfce_backdrop_get_pixbuf(backdrop);
+
+    g_assert(pix == old_pix);
+    g_assert(!xfce_backdrop_is_generating(backdrop));
+    g_assert_cmpuint(xfce_backdrop_get_n_decodes(), ==, n_decodes);
+
+    g_object_unref(pix);
+}
+
+/* a monitor is replaced and the other one moves to the left */
+static void
+test_workspace_monitors_plug_names(void)
+{
+    XfconfChannel *channel;
+    XfceWorkspace *workspace;
+    XfceWorkspaceMonitor monitors[2];
+    XfceBackdrop *dp1, *dp2;
+    GdkPixbuf *dp2_pix;
+    guint n_decodes;
+
+    workspace = create_workspace(&channel);
+
+    set_monitor(&monitors[0], "DP-1", 0, 0, 640, 480);
+    set_monitor(&monitors[1], "DP-2", 640, 0, 640, 480);
+    xfce_workspace_set_monitors(workspace, monitors, 2);
+
+    dp1 = xfce_workspace_get_backdrop(workspace, 0);
+    dp2 = xfce_workspace_get_backdrop(workspace, 1);
+    assert_backdrop_for(dp1, "DP-1");
+    assert_backdrop_for(dp2, "DP-2");
+    g_object_add_weak_pointer(G_OBJECT(dp1), (gpointer *)&dp1);
+
+    load_backdrop(dp1, 640, 480);
+    load_backdrop(dp2, 640, 480);
+    dp2_pix = xfce_backdrop_get_pixbuf(dp2);
+    n_decodes = xfce_backdrop_get_n_decodes();
+
+    set_monitor(&monitors[0], "DP-2", 0, 0, 640, 480);
+    set_monitor(&monitors[1], "HDMI-1", 640, 0, 640, 480);
+    xfce_workspace_set_monitors(workspace, monitors, 2);
+
+    g_assert(xfce_workspace_get_backdrop(workspace, 0) == dp2);
+    assert_backdrop_unchanged(dp2, dp2_pix, n_decodes);
+
+    /* DP-1 is gone, HDMI-1 gets a backdrop of its own */
+    g_assert(dp1 == NULL);
+    assert_backdrop_for(xfce_workspace_get_backdrop(workspace, 1), "HDMI-1");
+    g_assert(xfce_workspace_get_backdrop(workspace, 1) != dp2);
+    g_assert(xfce_workspace_get_backdrop(workspace, 2) == NULL);
+
+    g_object_unref(dp2_pix);
+    destroy_workspace(workspace, channel);
+}
+
+/* a named monitor keeps its backdrop when its resolution changes; the
+ * desktop then resizes it */
+static void
+test_workspace_monitors_resolution(void)
+{
+    XfconfChannel *channel;
+    XfceWorkspace *workspace;
+    XfceWorkspaceMonitor monitors[2];
+    XfceBackdrop *dp1, *dp2;
+    GdkPixbuf *dp2_pix;
+    guint n_decodes;
+
+    workspace = create_workspace(&channel);
+
+    set_monitor(&monitors[0], "DP-1", 0, 0, 640, 480);
+    set_monitor(&monitors[1], "DP-2", 640, 0, 640, 480);
+    xfce_workspace_set_monitors(workspace, monitors, 2);
+
+    dp1 = xfce_workspace_get_backdrop(workspace, 0);
+    dp2 = xfce_workspace_get_backdrop(workspace, 1);
+    load_backdrop(dp1, 640, 480);
+    load_backdrop(dp2, 640, 480);
+    dp2_pix = xfce_backdrop_get_pixbuf(dp2);
+    n_decodes = xfce_backdrop_get_n_decodes();
+
+    /* DP-1 grows, which moves DP-2 along */
+    set_monitor(&monitors[0], "DP-1", 0, 0, 800, 600);
+    set_monitor(&monitors[1], "DP-2", 800, 0, 640, 480);
+    xfce_workspace_set_monitors(workspace, monitors, 2);
+
+    g_assert(xfce_workspace_get_backdrop(workspace, 0) == dp1);
+    g_assert(xfce_workspace_get_backdrop(workspace, 1) == dp2);
+    assert_backdrop_for(dp1, "DP-1");
+    assert_backdrop_unchanged(dp2, dp2_pix, n_decodes);
+
+    g_object_unref(dp2_pix);
+    destroy_workspace(workspace, channel);
+}
+
+/* without plug names, only a monitor at the same index with the same
+ * geometry can be the same monitor */
+static void
+test_workspace_monitors_unnamed(void)
+{
+    XfconfChannel *channel;
+    XfceWorkspace *workspace;
+    XfceWorkspaceMonitor monitors[2];
+    XfceBackdrop *first, *second;
+    GdkPixbuf *first_pix;
+    guint n_decodes;
+
+    workspace = create_workspace(&channel);
+
+    set_monitor(&monitors[0], NULL, 0, 0, 640, 480);
+    set_monitor(&monitors[1], NULL, 640, 0, 640, 480);
+    xfce_workspace_set_monitors(workspace, monitors, 2);
+
+    first = xfce_workspace_get_backdrop(workspace, 0);
+    second = xfce_workspace_get_backdrop(workspace, 1);
+    assert_backdrop_for(first, "0");
+    assert_backdrop_for(second, "1");
+    g_object_add_weak_pointer(G_OBJECT(second), (gpointer *)&second);
+
+    load_backdrop(first, 640, 480);
+    load_backdrop(second, 640, 480);
+    first_pix = xfce_backdrop_get_pixbuf(first);
+    n_decodes = xfce_backdrop_get_n_decodes();
+
+    /* nothing changed */
+    xfce_workspace_set_monitors(workspace, monitors, 2);
+    g_assert(xfce_workspace_get_backdrop(workspace, 0) == first);
+    g_assert(xfce_workspace_get_backdrop(workspace, 1) == second);
+    assert_backdrop_unchanged(first, first_pix, n_decodes);
+
+    /* the second one got another resolution, it may be another monitor */
+    set_monitor(&monitors[1], NULL, 640, 0, 1024, 768);
+    xfce_workspace_set_monitors(workspace, monitors, 2);
+
+    g_assert(xfce_workspace_get_backdrop(workspace, 0) == first);
+    assert_backdrop_unchanged(first, first_pix, n_decodes);
+    g_assert(second == NULL);
+    assert_backdrop_for(xfce_workspace_get_backdrop(workspace, 1), "1");
+
+    /* swapped sides: the indexes stay, the geometries don't */
+    second = xfce_workspace_get_backdrop(workspace, 1);
+    g_object_add_weak_pointer(G_OBJECT(first), (gpointer *)&first);
+    g_object_add_weak_pointer(G_OBJECT(second), (gpointer *)&second);
+    set_monitor(&monitors[0], NULL, 1024, 0, 640, 480);
+    set_monitor(&monitors[1], NULL, 0, 0, 1024, 768);
+    xfce_workspace_set_monitors(workspace, monitors, 2);
+
+    g_assert(first == NULL);
+    g_assert(second == NULL);
+    assert_backdrop_for(xfce_workspace_get_backdrop(workspace, 0), "0");
+    assert_backdrop_for(xfce_workspace_get_backdrop(workspace, 1), "1");
+
+    g_object_unref(first_pix);
+    destroy_workspace(workspace, channel);
+}
+
+/* e.g. the only monitor switched off for a moment */
+static void
+test_workspace_monitors_remove_last(void)
+{
+    XfconfChannel *channel;
+    XfceWorkspace *workspace;
+    XfceWorkspaceMonitor monitor;
+    XfceBackdrop *dp1;
+
+    workspace = create_workspace(&channel);
+
+    set_monitor(&monitor, "DP-1", 0, 0, 640, 480);
+    xfce_workspace_set_monitors(workspace, &monitor, 1);
+
+    dp1 = xfce_workspace_get_backdrop(workspace, 0);
+    assert_backdrop_for(dp1, "DP-1");
+    load_backdrop(dp1, 640, 480);
+    g_object_add_weak_pointer(G_OBJECT(dp1), (gpointer *)&dp1);
+
+    xfce_workspace_set_monitors(workspace, NULL, 0);
+    g_assert(dp1 == NULL);
+    g_assert(xfce_workspace_get_backdrop(workspace, 0) == NULL);
+    g_assert(!xfce_workspace_get_xinerama_stretch(workspace));
+
+    /* and back on: a new backdrop, bound to the same settings */
+    xfce_workspace_set_monitors(workspace, &monitor, 1);
+    assert_backdrop_for(xfce_workspace_get_backdrop(workspace, 0), "DP-1");
+
+    destroy_workspace(workspace, channel);
+}
+
+int
+main(int argc, char **argv)
+{
+    gchar *cache_home;
+    int ret;
+
+#if !GLIB_CHECK_VERSION (2, 32, 0)
+    if(!g_thread_supported())
+        g_thread_init(NULL);
+#endif
+
+    test_dir = g_dir_make_tmp("xfdesktop-test-XXXXXX", NULL);
+    g_assert(test_dir != NULL);
+
+    /* before anything looks up the cache directory */
+    cache_home = g_build_filename(test_dir, "cache", NULL);
+    g_setenv("XDG_CACHE_HOME", cache_home, TRUE);
+    g_free(cache_home);
+
+    if(!gtk_init_check(&argc, &argv) || !xfconf_stand_in_start()) {
+        remove_dir(test_dir);
+        return 77;
+    }
+
+    if(!xfconf_init(NULL)) {
+        xfconf_stand_in_stop();
+        remove_dir(test_dir);
+        return 77;
+    }
+
+    g_test_init(&argc, &argv, NULL);
+
+    setup_settings();
+
+    g_test_add_func("/workspace/monitors/plug-names",
+                    test_workspace_monitors_plug_names);
+    g_test_add_func("/workspace/monitors/resolution",
+                    test_workspace_monitors_resolution);
+    g_test_add_func("/workspace/monitors/unnamed",
+                    test_workspace_monitors_unnamed);
+    g_test_add_func("/workspace/monitors/remove-last",
+                    test_workspace_monitors_remove_last);
+
+    ret = g_test_run();
+
+    xfconf_shutdown();
+    xfconf_stand_in_stop();
+    remove_dir(test_dir);
+    g_free(test_dir);
+
+    return ret;
+}
@@ -0,0 +1,555 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/* A stand-in for xfconfd, for tests: it owns org.xfce.Xfconf on the session
+ * bus, keeps the properties in memory and counts the calls it gets, and
+ * which properties were read one at a time.  It
+ * answers from a thread of its own, since the xfconf client blocks the
+ * main thread while it waits for a reply.  Run the tests in a private
+ * session, e.g. with dbus-run-session, never next to a real xfconfd. */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include "xfconf-stand-in.h"
+
+#define XFCONF_BUS_NAME       "org.xfce.Xfconf"
+#define XFCONF_OBJECT_PATH    "/org/xfce/Xfconf"
+#define XFCONF_INTERFACE      "org.xfce.Xfconf"
+
+#define DBUS_NAME_FLAG_DO_NOT_QUEUE       4
+#define DBUS_REQUEST_NAME_REPLY_PRIMARY   1
+
+static const gchar xfconf_stand_in_xml[] =
+    "<node>"
+    "  <interface name='" XFCONF_INTERFACE "'>"
+    "    <method name='SetProperty'>"
+    "      <arg direction='in' type='s' name='channel'/>"
+    "      <arg direction='in' type='s' name='property'/>"
+    "      <arg direction='in' type='v' name='value'/>"
+    "    </method>"
+    "    <method name='GetProperty'>"
+    "      <arg direction='in' type='s' name='channel'/>"
+    "      <arg direction='in' type='s' name='property'/>"
+    "      <arg direction='out' type='v' name='value'/>"
+    "    </method>"
+    "    <method name='GetAllProperties'>"
+    "      <arg direction='in' type='s' name='channel'/>"
+    "      <arg direction='in' type='s' name='property_base'/>"
+    "      <arg direction='out' type='a{sv}' name='properties'/>"
+    "    </method>"
+    "    <method name='PropertyExists'>"
+    "      <arg direction='in' type='s' name='channel'/>"
+    "      <arg direction='in' type='s' name='property'/>"
+    "      <arg direction='out' type='b' name='exists'/>"
+    "    </method>"
+    "    <method name='ResetProperty'>"
+    "      <arg direction='in' type='s' name='channel'/>"
+    "      <arg direction='in' type='s' name='property'/>"
+    "      <arg direction='in' type='b' name='recursive'/>"
+    "    </method>"
+    "    <method name='ListChannels'>"
+    "      <arg direction='out' type='as' name='channels'/>"
+    "    </method>"
+    "    <method name='IsPropertyLocked'>"
+    "      <arg direction='in' type='s' name='channel'/>"
+    "      <arg direction='in' type='s' name='property'/>"
+    "      <arg direction='out' type='b' name='locked'/>"
+    "    </method>"
+    "    <signal name='PropertyChanged'>"
+    "      <arg type='s' name='channel'/>"
+    "      <arg type='s' name='property'/>"
+    "      <arg type='v' name='value'/>"
+    "    </signal>"
+    "    <signal name='PropertyRemoved'>"
+    "      <arg type='s' name='channel'/>"
+    "      <arg type='s' name='property'/>"
+    "    </signal>"
+    "  </interface>"
+    "</node>";
+
+static GMainContext *stand_in_context = NULL;
+static GMainLoop *stand_in_loop = NULL;
+static GThread *stand_in_thread = NULL;
+static GAsyncQueue *stand_in_started = NULL;
+static GDBusConnection *stand_in_connection = NULL;
+
+/* both are used from the stand-in thread and the test */
+G_LOCK_DEFINE_STATIC(stand_in);
+/* "channel:property" -> GVariant */
+static GHashTable *stand_in_properties = NULL;
+/* method name -> number of calls */
+static GHashTable *stand_in_calls = NULL;
+/* "channel:property" -> number of single property reads */
+static GHashTable *stand_in_reads = NULL;
+
+/* Whether @key is a property of @channel below @base, which is all of them
+ * for "/" */
+static gboolean
+xfconf_stand_in_key_matches(const gchar *key,
+                            const gchar *channel,
+                            const gchar *base,
+                            const gchar **property)
+{
+    gsize len = strlen(channel);
+
+    if(strncmp(key, channel, len) != 0 || key[len] != ':')
+        return FALSE;
+
+    *property = key + len + 1;
+
+    if(base == NULL || *base == '\0' || strcmp(base, "/") == 0)
+        return TRUE;
+
+    len = strlen(base);
+
+    return strncmp(*property, base, len) == 0
+           && ((*property)[len] == '\0' || (*property)[len] == '/');
+}
+
+static void
+xfconf_stand_in_emit(const gchar *signal_name,
+                     GVariant *parameters)
+{
+    g_dbus_connection_emit_signal(stand_in_connection, NULL,
+                                  XFCONF_OBJECT_PATH, XFCONF_INTERFACE,
+                                  signal_name, parameters, NULL);
+}
+
+static void
+xfconf_stand_in_reset(const gchar *channel,
+                      const gchar *property,
+                      gboolean recursive)
+{
+    GHashTableIter iter;
+    gpointer key;
+    GList *removed = NULL, *l;
+
+    G_LOCK(stand_in);
+    g_hash_table_iter_init(&iter, stand_in_properties);
+    while(g_hash_table_iter_next(&iter, &key, NULL)) {
+        const gchar *name;
+
+        if(!xfconf_stand_in_key_matches(key, channel, property, &name))
+            continue;
+
+        if(!recursive && strcmp(name, property) != 0)
+            continue;
+
+        removed = g_list_prepend(removed, g_strdup(name));
+        g_hash_table_iter_remove(&iter);
+    }
+    G_UNLOCK(stand_in);
+
+    for(l = removed; l; l = l->next) {
+        xfconf_stand_in_emit("PropertyRemoved",
+                             g_variant_new("(ss)", channel, (gchar *)l->data));
+        g_free(l->data);
+    }
+    g_list_free(removed);
+}
+
+static void
+xfconf_stand_in_method_call(GDBusConnection *connection,
+                            const gchar *sender,
+                            const gchar *object_path,
+                            const gchar *interface_name,
+                            const gchar *method_name,
+                            GVariant *parameters,
+                            GDBusMethodInvocation *invocation,
+                            gpointer user_data)
+{
+    const gchar *channel = NULL, *property = NULL;
+    GVariant *value;
+    guint n_calls, n_reads;
+    gchar *key = NULL;
+
+    G_LOCK(stand_in);
+    n_calls = GPOINTER_TO_UINT(g_hash_table_lookup(stand_in_calls, method_name));
+    g_hash_table_replace(stand_in_calls, g_strdup(method_name),
+                         GUINT_TO_POINTER(n_calls + 1));
+    G_UNLOCK(stand_in);
+
+    if(strcmp(method_name, "ListChannels") != 0) {
+        g_variant_get_child(parameters, 0, "&s", &channel);
+        g_variant_get_child(parameters, 1, "&s", &property);
+        key = g_strconcat(channel, ":", property, NULL);
+    }
+
+    if(strcmp(method_name, "GetProperty") == 0
+       || strcmp(method_name, "PropertyExists") == 0)
+    {
+        G_LOCK(stand_in);
+        n_reads = GPOINTER_TO_UINT(g_hash_table_lookup(stand_in_reads, key));
+        g_hash_table_replace(stand_in_reads, g_strdup(key),
+                             GUINT_TO_POINTER(n_reads + 1));
+        G_UNLOCK(stand_in);
+    }
+
+    if(strcmp(method_name, "GetProperty") == 0) {
+        G_LOCK(stand_in);
+        value = g_hash_table_lookup(stand_in_properties, key);
+        if(value)
+            g_variant_ref(value);
+        G_UNLOCK(stand_in);
+
+        if(value) {
+            g_dbus_method_invocation_return_value(invocation,
+                                                  g_variant_new("(v)", value));
+            g_variant_unref(value);
+        } else {
+            g_dbus_method_invocation_return_dbus_error(invocation,
+                                                       XFCONF_INTERFACE ".Error.PropertyNotFound",
+                                                       "Property does not exist");
+        }
+    } else if(strcmp(method_name, "GetAllProperties") == 0) {
+        GVariantBuilder builder;
+        GHashTableIter iter;
+        gpointer k, v;
+
+        g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+
+        G_LOCK(stand_in);
+        g_hash_table_iter_init(&iter, stand_in_properties);
+        while(g_hash_table_iter_next(&iter, &k, &v)) {
+            const gchar *name;
+
+            if(xfconf_stand_in_key_matches(k, channel, property, &name))
+                g_variant_builder_add(&builder, "{sv}", name, v);
+        }
+        G_UNLOCK(stand_in);
+
+        g_dbus_method_invocation_return_value(invocation,
+                                              g_variant_new("(a{sv})", &builder));
+    } else if(strcmp(method_name, "PropertyExists") == 0) {
+        gboolean exists;
+
+        G_LOCK(stand_in);
+        exists = g_hash_table_lookup(stand_in_properties, key) != NULL;
+        G_UNLOCK(stand_in);
+
+        g_dbus_method_invocation_return_value(invocation,
+                                              g_variant_new("(b)", exists));
+    } else if(strcmp(method_name, "SetProperty") == 0) {
+        g_variant_get_child(parameters, 2, "v", &value);
+        xfconf_stand_in_set(channel, property, value);
+        g_variant_unref(value);
+
+        g_dbus_method_invocation_return_value(invocation, NULL);
+    } else if(strcmp(method_name, "ResetProperty") == 0) {
+        gboolean recursive = FALSE;
+
+        g_variant_get_child(parameters, 2, "b", &recursive);
+        xfconf_stand_in_reset(channel, property, recursive);
+
+        g_dbus_method_invocation_return_value(invocation, NULL);
+    } else if(strcmp(method_name, "ListChannels") == 0) {
+        GVariantBuilder builder;
+        GHashTable *channels;
+        GHashTableIter iter;
+        gpointer k;
+
+        channels = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+        G_LOCK(stand_in);
+        g_hash_table_iter_init(&iter, stand_in_properties);
+        while(g_hash_table_iter_next(&iter, &k, NULL)) {
+            const gchar *colon = strchr(k, ':');
+
+            g_hash_table_replace(channels, g_strndup(k, colon - (const gchar *)k),
+                                 GINT_TO_POINTER(1));
+        }
+        G_UNLOCK(stand_in);
+
+        g_variant_builder_init(&builder, G_VARIANT_TYPE("as"));
+        g_hash_table_iter_init(&iter, channels);
+        while(g_hash_table_iter_next(&iter, &k, NULL))
+            g_variant_builder_add(&builder, "s", k);
+        g_hash_table_destroy(channels);
+
+        g_dbus_method_invocation_return_value(invocation,
+                                              g_variant_new("(as)", &builder));
+    } else if(strcmp(method_name, "IsPropertyLocked") == 0) {
+        g_dbus_method_invocation_return_value(invocation,
+                                              g_variant_new("(b)", FALSE));
+    } else {
+        g_dbus_method_invocation_return_dbus_error(invocation,
+                                                   "org.freedesktop.DBus.Error.UnknownMethod",
+                                                   method_name);
+    }
+
+    g_free(key);
+}
+
+static gpointer
+xfconf_stand_in_thread_func(gpointer data)
+{
+    static const GDBusInterfaceVTable vtable = { xfconf_stand_in_method_call, NULL, NULL };
+    GDBusNodeInfo *info;
+    GVariant *reply;
+    gchar *address;
+    guint32 result = 0;
+    GError *error = NULL;
+
+    g_main_context_push_thread_default(stand_in_context);
+
+    /* a connection of our own, so its method calls are dispatched to this
+     * thread */
+    address = g_dbus_address_get_for_bus_sync(G_BUS_TYPE_SESSION, NULL, &error);
+    if(address) {
+        stand_in_connection = g_dbus_connection_new_for_address_sync(address,
+                                                                     G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT
+                                                                     | G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                                                     NULL, NULL, &error);
+        g_free(address);
+    }
+
+    if(stand_in_connection) {
+        g_dbus_connection_set_exit_on_close(stand_in_connection, FALSE);
+
+        info = g_dbus_node_info_new_for_xml(xfconf_stand_in_xml, NULL);
+        g_dbus_connection_register_object(stand_in_connection, XFCONF_OBJECT_PATH,
+                                          info->interfaces[0], &vtable,
+                                          NULL, NULL, NULL);
+        g_dbus_node_info_unref(info);
+
+        /* owned before anyone asks, or the bus would start the real
+         * xfconfd; give up if that's running already */
+        reply = g_dbus_connection_call_sync(stand_in_connection,
+                                            "org.freedesktop.DBus",
+                                            "/org/freedesktop/DBus",
+                                            "org.freedesktop.DBus",
+                                            "RequestName",
+                                            g_variant_new("(su)", XFCONF_BUS_NAME,
+                                                          DBUS_NAME_FLAG_DO_NOT_QUEUE),
+                                            G_VARIANT_TYPE("(u)"),
+                                            G_DBUS_CALL_FLAGS_NONE, -1,
+                                            NULL, &error);
+        if(reply) {
+            g_variant_get(reply, "(u)", &result);
+            g_variant_unref(reply);
+        }
+    }
+
+    if(error) {
+        g_message("xfconf stand-in: %s", error->message);
+        g_error_free(error);
+    }
+
+    /* the queue doesn't take NULL */
+    g_async_queue_push(stand_in_started,
+                       GUINT_TO_POINTER(result == DBUS_REQUEST_NAME_REPLY_PRIMARY ? 1 : 2));
+
+    if(result == DBUS_REQUEST_NAME_REPLY_PRIMARY)
+        g_main_loop_run(stand_in_loop);
+
+    g_main_context_pop_thread_default(stand_in_context);
+
+    return NULL;
+}
+
+static gboolean
+xfconf_stand_in_quit(gpointer data)
+{
+    g_main_loop_quit(stand_in_loop);
+
+    return FALSE;
+}
+
+/**
+ * xfconf_stand_in_start:
+ *
+ * Takes over org.xfce.Xfconf on the session bus.  Call it before
+ * xfconf_init().  Returns FALSE if there is no session bus or the name is
+ * owned already.
+ **/
+gboolean
+xfconf_stand_in_start(void)
+{
+    gpointer started;
+
+    /* never talk to a bus g_dbus would autolaunch for us */
+    if(!g_getenv("DBUS_SESSION_BUS_ADDRESS"))
+        return FALSE;
+
+    stand_in_properties = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                                g_free,
+                                                (GDestroyNotify)g_variant_unref);
+    stand_in_calls = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                           g_free, NULL);
+    stand_in_reads = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                           g_free, NULL);
+
+    stand_in_context = g_main_context_new();
+    stand_in_loop = g_main_loop_new(stand_in_context, FALSE);
+    stand_in_started = g_async_queue_new();
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+    stand_in_thread = g_thread_new("xfconf-stand-in",
+                                   xfconf_stand_in_thread_func, NULL);
+#else
+    stand_in_thread = g_thread_create(xfconf_stand_in_thread_func, NULL,
+                                      TRUE, NULL);
+#endif
+
+    started = g_async_queue_pop(stand_in_started);
+    if(GPOINTER_TO_UINT(started) != 1) {
+        xfconf_stand_in_stop();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void
+xfconf_stand_in_stop(void)
+{
+    if(stand_in_thread) {
+        /* through the loop's own context, so it can't get lost before
+         * g_main_loop_run() */
+        g_main_context_invoke(stand_in_context, xfconf_stand_in_quit, NULL);
+        g_thread_join(stand_in_thread);
+        stand_in_thread = NULL;
+    }
+
+    if(stand_in_connection) {
+        g_dbus_connection_close_sync(stand_in_connection, NULL, NULL);
+        g_object_unref(stand_in_connection);
+        stand_in_connection = NULL;
+    }
+
+    if(stand_in_loop) {
+        g_main_loop_unref(stand_in_loop);
+        stand_in_loop = NULL;
+    }
+    if(stand_in_context) {
+        g_main_context_unref(stand_in_context);
+        stand_in_context = NULL;
+    }
+    if(stand_in_started) {
+        g_async_queue_unref(stand_in_started);
+        stand_in_started = NULL;
+    }
+
+    if(stand_in_properties) {
+        g_hash_table_destroy(stand_in_properties);
+        stand_in_properties = NULL;
+    }
+    if(stand_in_calls) {
+        g_hash_table_destroy(stand_in_calls);
+        stand_in_calls = NULL;
+    }
+    if(stand_in_reads) {
+        g_hash_table_destroy(stand_in_reads);
+        stand_in_reads = NULL;
+    }
+}
+
+/**
+ * xfconf_stand_in_set:
+ * @channel: An xfconf channel name.
+ * @property: A property of @channel.
+ * @value: The new value, or %NULL to remove @property.
+ *
+ * Changes @property and tells the xfconf clients, just like xfconfd does
+ * when someone else sets it.  A floating @value is consumed.
+ **/
+void
+xfconf_stand_in_set(const gchar *channel,
+                    const gchar *property,
+                    GVariant *value)
+{
+    if(value == NULL) {
+        xfconf_stand_in_reset(channel, property, FALSE);
+        return;
+    }
+
+    g_variant_ref_sink(value);
+
+    G_LOCK(stand_in);
+    g_hash_table_replace(stand_in_properties,
+                         g_strconcat(channel, ":", property, NULL),
+                         g_variant_ref(value));
+    G_UNLOCK(stand_in);
+
+    xfconf_stand_in_emit("PropertyChanged",
+                         g_variant_new("(ssv)", channel, property, value));
+
+    g_variant_unref(value);
+}
+
+/**
+ * xfconf_stand_in_get_n_calls:
+ * @method: A method of the org.xfce.Xfconf interface.
+ *
+ * Returns how often @method was called since the start or the last
+ * xfconf_stand_in_reset_calls().
+ **/
+guint
+xfconf_stand_in_get_n_calls(const gchar *method)
+{
+    guint n_calls;
+
+    G_LOCK(stand_in);
+    n_calls = GPOINTER_TO_UINT(g_hash_table_lookup(stand_in_calls, method));
+    G_UNLOCK(stand_in);
+
+    return n_calls;
+}
+
+/**
+ * xfconf_stand_in_get_n_reads:
+ * @channel: An xfconf channel name.
+ * @base: A property base without the trailing slash, or "/".
+ *
+ * Returns how often properties of @channel below @base were fetched one at
+ * a time, with GetProperty or PropertyExists, since the start or the last
+ * xfconf_stand_in_reset_calls().
+ **/
+guint
+xfconf_stand_in_get_n_reads(const gchar *channel,
+                            const gchar *base)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+    guint n_reads = 0;
+
+    G_LOCK(stand_in);
+    g_hash_table_iter_init(&iter, stand_in_reads);
+    while(g_hash_table_iter_next(&iter, &key, &value)) {
+        const gchar *property;
+
+        if(xfconf_stand_in_key_matches(key, channel, base, &property))
+            n_reads += GPOINTER_TO_UINT(value);
+    }
+    G_UNLOCK(stand_in);
+
+    return n_reads;
+}
+
+void
+xfconf_stand_in_reset_calls(void)
+{
+    G_LOCK(stand_in);
+    g_hash_table_remove_all(stand_in_calls);
+    g_hash_table_remove_all(stand_in_reads);
+    G_UNLOCK(stand_in);
+}
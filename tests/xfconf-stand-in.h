@@ -0,0 +1,40 @@
+/*
+ *  xfdesktop - xfce4's desktop manager
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __XFCONF_STAND_IN_H__
+#define __XFCONF_STAND_IN_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+gboolean xfconf_stand_in_start        (void);
+void     xfconf_stand_in_stop         (void);
+
+void     xfconf_stand_in_set          (const gchar *channel,
+                                       const gchar *property,
+                                       GVariant *value);
+
+guint    xfconf_stand_in_get_n_calls  (const gchar *method);
+guint    xfconf_stand_in_get_n_reads  (const gchar *channel,
+                                       const gchar *base);
+void     xfconf_stand_in_reset_calls  (void);
+
+G_END_DECLS
+
+#endif  /* __XFCONF_STAND_IN_H__ */